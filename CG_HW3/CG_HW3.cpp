@@ -1,622 +1,1680 @@
-﻿#include "headers.h"
-#include "trianglemesh.h"
-#include "camera.h"
-#include "shaderprog.h"
-#include "light.h"
-#include "imagetexture.h"
-#include "skybox.h"
-
-
-// Global variables.
-int screenWidth = 600;
-int screenHeight = 600;
-// Triangle mesh.
-TriangleMesh* mesh = nullptr;
-// Lights.
-DirectionalLight* dirLight = nullptr;
-PointLight* pointLight = nullptr;
-SpotLight* spotLight = nullptr;
-glm::vec3 dirLightDirection = glm::vec3(0.0f, 0.0f, -1.0f);
-glm::vec3 dirLightRadiance = glm::vec3(0.6f, 0.6f, 0.6f);
-glm::vec3 pointLightPosition = glm::vec3(0.8f, 0.0f, 0.8f);
-glm::vec3 pointLightIntensity = glm::vec3(0.5f, 0.1f, 0.1f);
-glm::vec3 spotLightPosition = glm::vec3(0.0f, 1.0f, 0.0f);
-glm::vec3 spotLightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
-glm::vec3 spotLightIntensity = glm::vec3(0.25f, 0.25f, 0.1f);
-float spotLightCutoffStartInDegree = 30.0f;
-float spotLightTotalWidthInDegree = 45.0f;
-glm::vec3 ambientLight = glm::vec3(0.2f, 0.2f, 0.2f);
-// Camera.
-Camera* camera = nullptr;
-glm::vec3 cameraPos = glm::vec3(0.0f, 1.0f, 5.0f);
-glm::vec3 cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
-glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
-float fovy = 30.0f;
-float zNear = 0.1f;
-float zFar = 1000.0f;
-// Shader.
-FillColorShaderProg* fillColorShader = nullptr;
-PhongShadingDemoShaderProg* phongShadingShader = nullptr;
-SkyboxShaderProg* skyboxShader = nullptr;
-// UI.
-const float lightMoveSpeed = 0.2f;
-// Shading Mode
-int lightingMode = 0;
-// Skybox.
-Skybox* skybox = nullptr;
-float rotationSpeed = 1.0f;
-
-
-std::string modelFilePath = "../TestModels_HW3/TexCube";
-std::string skyFilePath = "../TestTextures_HW3/photostudio_02_2k.png";
-
-// SceneObject.
-struct SceneObject
-{
-    SceneObject() {
-        mesh = nullptr;
-        worldMatrix = glm::mat4x4(1.0f);
-    }
-    TriangleMesh* mesh;
-    glm::mat4x4 worldMatrix;
-};
-SceneObject sceneObj;
-
-// ScenePointLight (for visualization of a point light).
-struct ScenePointLight
-{
-    ScenePointLight() {
-        light = nullptr;
-        worldMatrix = glm::mat4x4(1.0f);
-        visColor = glm::vec3(1.0f, 1.0f, 1.0f);
-    }
-    PointLight* light;
-    glm::mat4x4 worldMatrix;
-    glm::vec3 visColor;
-};
-ScenePointLight pointLightObj;
-ScenePointLight spotLightObj;
-
-// Function prototypes.
-void ReleaseResources();
-// Callback functions.
-void RenderSceneCB();
-void ReshapeCB(int, int);
-void ProcessSpecialKeysCB(int, int, int);
-void ProcessKeysCB(unsigned char, int, int);
-void SetupRenderState();
-void SetupScene(const std::string& modelFilePath);
-void LoadObjects(const std::string&);
-void CreateCamera();
-void CreateSkybox(const std::string);
-void CreateShaderLib();
-
-
-
-void ReleaseResources()
-{
-    std::cout << "Resource Releasing..." << std::endl;
-    // Delete scene objects and lights.
-    if (mesh != nullptr) {
-        delete mesh;
-        mesh = nullptr;
-    }
-    if (pointLight != nullptr) {
-        delete pointLight;
-        pointLight = nullptr;
-    }
-    if (dirLight != nullptr) {
-        delete dirLight;
-        dirLight = nullptr;
-    }
-    if (spotLight != nullptr) {
-        delete spotLight;
-        spotLight = nullptr;
-    }
-    // Delete camera.
-    if (camera != nullptr) {
-        delete camera;
-        camera = nullptr;
-    }
-    // Delete shaders.
-    if (fillColorShader != nullptr) {
-        delete fillColorShader;
-        fillColorShader = nullptr;
-    }
-    if (phongShadingShader != nullptr) {
-        delete phongShadingShader;
-        phongShadingShader = nullptr;
-    }
-    if (skyboxShader != nullptr) {
-        delete skyboxShader;
-        skyboxShader = nullptr;
-    }
-    std::cout << "Resource Releasing Finished" << std::endl;
-}
-
-static float curObjRotationY = 30.0f;
-const float rotStep = 0.02f;
-void RenderSceneCB()
-{
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    
-    TriangleMesh* pMesh = sceneObj.mesh;
-    if (pMesh != nullptr) {
-        // Update transform.
-        //curObjRotationY += rotStep;
-        glm::mat4x4 S = glm::scale(glm::mat4x4(1.0f), glm::vec3(1.5f, 1.5f, 1.5f));
-        glm::mat4x4 R = glm::rotate(glm::mat4x4(1.0f), glm::radians(curObjRotationY), glm::vec3(0, 1, 0));
-        sceneObj.worldMatrix = S * R;
-        // -------------------------------------------------------
-		// Note: if you want to compute lighting in the View Space, 
-        //       you might need to change the code below.
-		// -------------------------------------------------------
-        glm::mat4x4 normalMatrix = glm::transpose(glm::inverse(camera->GetViewMatrix() * sceneObj.worldMatrix));
-        glm::mat4x4 MVP = camera->GetProjMatrix() * camera->GetViewMatrix() * sceneObj.worldMatrix;
-        
-        phongShadingShader->Bind();
-
-        // Transformation Matrix
-        glUniformMatrix4fv(phongShadingShader->GetLocM(), 1, GL_FALSE, glm::value_ptr(sceneObj.worldMatrix));
-        glUniformMatrix4fv(phongShadingShader->GetLocNM(), 1, GL_FALSE, glm::value_ptr(normalMatrix));
-        glUniformMatrix4fv(phongShadingShader->GetLocMVP(), 1, GL_FALSE, glm::value_ptr(MVP));
-
-        // Set Camera Position
-        glUniform3fv(phongShadingShader->GetLocCameraPos(), 1, glm::value_ptr(camera->GetCameraPos()));
-
-        // Set Light data.
-        // Directional Light
-        if (dirLight != nullptr) {
-            glUniform3fv(phongShadingShader->GetLocDirLightDir(), 1, glm::value_ptr(dirLight->GetDirection()));
-            glUniform3fv(phongShadingShader->GetLocDirLightRadiance(), 1, glm::value_ptr(dirLight->GetRadiance()));
-        }
-        // Point Light
-        if (pointLight != nullptr) {
-            glUniform3fv(phongShadingShader->GetLocPointLightPos(), 1, glm::value_ptr(pointLight->GetPosition()));
-            glUniform3fv(phongShadingShader->GetLocPointLightIntensity(), 1, glm::value_ptr(pointLight->GetIntensity()));
-        }
-        // Spot Light
-        if (spotLight != nullptr) {
-            glUniform3fv(phongShadingShader->GetLocSpotLightPos(), 1, glm::value_ptr(spotLight->GetPosition()));
-            glUniform3fv(phongShadingShader->GetLocSpotLightIntensity(), 1, glm::value_ptr(spotLight->GetIntensity()));
-            glUniform3fv(phongShadingShader->GetLocSpotLightDir(), 1, glm::value_ptr(spotLight->GetDirection()));
-            glUniform1f(phongShadingShader->GetLocSpotLightTotalWidth(), spotLight->GetTotalWidthDegree());
-            glUniform1f(phongShadingShader->GetLocSpotLightFoS(), spotLight->GetFallofStartDegree());
-            glUniform1f(phongShadingShader->GetLocCosSpotLightTotalWidth(), spotLight->GetCosTotalWidthDegree());
-            glUniform1f(phongShadingShader->GetLocCosSpotLightFoS(), spotLight->GetCosFallofStartDegree());
-        }
-
-        // Ambient Light
-        glUniform3fv(phongShadingShader->GetLocAmbientLight(), 1, glm::value_ptr(ambientLight));
-
-        // Lighting Mode
-        glUniform1i(phongShadingShader->GetLocLightingMode(), lightingMode);
-
-        for (auto& subMesh : mesh->GetSubMeshes()) {
-            
-            ImageTexture* imageData = subMesh.material->GetMapKd();
-            // Bind Texture Data
-            if (imageData != nullptr) {
-                imageData->Bind(GL_TEXTURE0);
-                glUniform1i(phongShadingShader->GetLocMapKd(), 0);
-                glUniform1i(phongShadingShader->GetLocUseMapKd(), 1);
-            }
-            else glUniform1i(phongShadingShader->GetLocUseMapKd(), 0);
-
-
-            // Set SubMesh Material Data
-            // Material properties.
-            glUniform3fv(phongShadingShader->GetLocKa(), 1, glm::value_ptr(subMesh.material->GetKa()));
-            glUniform3fv(phongShadingShader->GetLocKd(), 1, glm::value_ptr(subMesh.material->GetKd()));
-            glUniform3fv(phongShadingShader->GetLocKs(), 1, glm::value_ptr(subMesh.material->GetKs()));
-            glUniform1f(phongShadingShader->GetLocNs(), subMesh.material->GetNs());
-
-
-            mesh->Render(subMesh);
-        }
-
-        phongShadingShader->UnBind();
-    }
-    // -------------------------------------------------------------------------------------------
-
-    // Visualize the light with fill color. ------------------------------------------------------
-    PointLight* pointLight = pointLightObj.light;
-    if (pointLight != nullptr) {
-        glm::mat4x4 T = glm::translate(glm::mat4x4(1.0f), pointLight->GetPosition());
-        pointLightObj.worldMatrix = T;
-        glm::mat4x4 MVP = camera->GetProjMatrix() * camera->GetViewMatrix() * pointLightObj.worldMatrix;
-        fillColorShader->Bind();
-        glUniformMatrix4fv(fillColorShader->GetLocMVP(), 1, GL_FALSE, glm::value_ptr(MVP));
-        glUniform3fv(fillColorShader->GetLocFillColor(), 1, glm::value_ptr(pointLightObj.visColor));
-        // Render the point light.
-        pointLight->Draw();
-        fillColorShader->UnBind();
-    }
-    SpotLight* spotLight = (SpotLight*)(spotLightObj.light);
-    if (spotLight != nullptr) {
-        glm::mat4x4 T = glm::translate(glm::mat4x4(1.0f), spotLight->GetPosition());
-        spotLightObj.worldMatrix = T;
-        glm::mat4x4 MVP = camera->GetProjMatrix() * camera->GetViewMatrix() * spotLightObj.worldMatrix;
-        fillColorShader->Bind();
-        glUniformMatrix4fv(fillColorShader->GetLocMVP(), 1, GL_FALSE, glm::value_ptr(MVP));
-        glUniform3fv(fillColorShader->GetLocFillColor(), 1, glm::value_ptr(spotLightObj.visColor));
-        // Render the spot light.
-        spotLight->Draw();
-        fillColorShader->UnBind();
-    }
-    // -------------------------------------------------------------------------------------------
-
-    // Render skybox. ----------------------------------------------------------------------------
-    if (skybox != nullptr) {
-        skybox->Render(camera, skyboxShader);
-    }
-    // -------------------------------------------------------------------------------------------
-
-    glutSwapBuffers();
-}
-
-void ReshapeCB(int w, int h)
-{
-    // Update viewport.
-    screenWidth = w;
-    screenHeight = h;
-    glViewport(0, 0, screenWidth, screenHeight);
-    // Adjust camera and projection.
-    float aspectRatio = (float)screenWidth / (float)screenHeight;
-    camera->UpdateProjection(fovy, aspectRatio, zNear, zFar);
-}
-
-void ProcessSpecialKeysCB(int key, int x, int y)
-{
-    // Handle special (functional) keyboard inputs such as F1, spacebar, page up, etc. 
-    switch (key) {
-    // Rendering mode.
-    case GLUT_KEY_F1:
-        // Render with point mode.
-        glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
-        break;
-    case GLUT_KEY_F2:
-        // Render with line mode.
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        break;
-    case GLUT_KEY_F3:
-        // Render with fill mode.
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        break;
-    case GLUT_KEY_F4:
-        // Chang Shading Mode
-        lightingMode++;
-        lightingMode = lightingMode % 4;
-        break;
-    
-    // Light control.
-    case GLUT_KEY_LEFT:
-        if (pointLight != nullptr)
-            pointLight->MoveLeft(lightMoveSpeed);
-        break;
-    case GLUT_KEY_RIGHT:
-        if (pointLight != nullptr)
-            pointLight->MoveRight(lightMoveSpeed);
-        break;
-    case GLUT_KEY_UP:
-        if (pointLight != nullptr)
-            pointLight->MoveUp(lightMoveSpeed);
-        break;
-    case GLUT_KEY_DOWN:
-        if (pointLight != nullptr)
-            pointLight->MoveDown(lightMoveSpeed);
-        break;
-    default:
-        break;
-    }
-}
-
-void ProcessKeysCB(unsigned char key, int x, int y)
-{
-    // Handle other keyboard inputs those are not defined as special keys.
-    if (key == 27) {
-        // Release memory allocation if needed.
-        ReleaseResources();
-        exit(0);
-    }
-    // Spot light control.
-    if (spotLight != nullptr) {
-        if (key == 'a')
-            spotLight->MoveLeft(lightMoveSpeed);
-        if (key == 'd')
-            spotLight->MoveRight(lightMoveSpeed);
-        if (key == 'w')
-            spotLight->MoveUp(lightMoveSpeed);
-        if (key == 's')
-            spotLight->MoveDown(lightMoveSpeed);
-    }
-
-    // Skybox rotate control
-    if (skybox != nullptr) {
-        if (key == 'z') {
-            skybox->RotateLeft(rotationSpeed);
-        }
-        if (key == 'c') {
-            skybox->RotateRight(rotationSpeed);
-
-        }
-    }
-}
-
-void SetupRenderState()
-{
-    glEnable(GL_DEPTH_TEST);
-
-    glm::vec4 clearColor = glm::vec4(0.44f, 0.57f, 0.75f, 1.00f);
-    glClearColor(
-        (GLclampf)(clearColor.r), 
-        (GLclampf)(clearColor.g), 
-        (GLclampf)(clearColor.b), 
-        (GLclampf)(clearColor.a)
-    );
-}
-
-void LoadObjects(const std::string& modelPath)
-{
-    mesh = new TriangleMesh();
-    mesh->LoadFromFile(modelPath, true);
-    mesh->ShowInfo();
-    sceneObj.mesh = mesh;    
-    mesh->CreateBuffer();
-}
-
-void CreateLights()
-{
-    // Create a directional light.
-    dirLight = new DirectionalLight(dirLightDirection, dirLightRadiance);
-    // Create a point light.
-    pointLight = new PointLight(pointLightPosition, pointLightIntensity);
-    pointLightObj.light = pointLight;
-    pointLightObj.visColor = glm::normalize((pointLightObj.light)->GetIntensity());
-    // Create a spot light.
-    spotLight = new SpotLight(spotLightPosition, spotLightIntensity, spotLightDirection, 
-            spotLightCutoffStartInDegree, spotLightTotalWidthInDegree);
-    spotLightObj.light = spotLight;
-    spotLightObj.visColor = glm::normalize((spotLightObj.light)->GetIntensity());
-}
-
-void CreateCamera()
-{
-    // Create a camera and update view and proj matrices.
-    camera = new Camera((float)screenWidth / (float)screenHeight);
-    camera->UpdateView(cameraPos, cameraTarget, cameraUp);
-    float aspectRatio = (float)screenWidth / (float)screenHeight;
-    camera->UpdateProjection(fovy, aspectRatio, zNear, zFar);
-}
-
-void CreateSkybox(const std::string texFilePath)
-{
-    const int numSlices = 36;
-    const int numStacks = 18;
-    const float radius = 50.0f;
-    skybox = new Skybox(texFilePath, numSlices, numStacks, radius);
-}
-
-void CreateShaderLib()
-{
-    fillColorShader = new FillColorShaderProg();
-    if (!fillColorShader->LoadFromFiles("shaders/fixed_color.vs", "shaders/fixed_color.fs"))
-        exit(1);
-
-    phongShadingShader = new PhongShadingDemoShaderProg();
-    if (!phongShadingShader->LoadFromFiles("shaders/phong_shading_demo.vs", "shaders/phong_shading_demo.fs"))
-        exit(1);
-
-    skyboxShader = new SkyboxShaderProg();
-    if (!skyboxShader->LoadFromFiles("shaders/skybox.vs", "shaders/skybox.fs"))
-        exit(1);
-}
-
-//Obcjet Path Menu Dealing Function
-void PathMenu(int index) {
-    //ReleasResource First
-    ReleaseResources();
-
-    //Change File Path
-    switch (index) {
-    case 1:
-        modelFilePath = "../TestModels_HW3/Ferrari";
-        std::cout << "Select: Bunny Object" << std::endl;
-        break;
-    case 2:
-        modelFilePath = "../TestModels_HW3/Forklift";
-        std::cout << "Select: ColorCube Object" << std::endl;
-        break;
-    case 3:
-        modelFilePath = "../TestModels_HW3/Gengar";
-        std::cout << "Select: Forklift Object" << std::endl;
-        break;
-    case 4:
-        modelFilePath = "../TestModels_HW3/Ivysaur";
-        std::cout << "Select: Gengar Object" << std::endl;
-        break;
-    case 5:
-        modelFilePath = "../TestModels_HW3/Koffing";
-        std::cout << "Select: Koffing Object" << std::endl;
-        break;
-    case 6:
-        modelFilePath = "../TestModels_HW3/MagikarpF";
-        std::cout << "Select: Ivysaur Object" << std::endl;
-        break;
-    case 7:
-        modelFilePath = "../TestModels_HW3/Rose";
-        std::cout << "Select: Pillows Object" << std::endl;
-        break;
-    case 8:
-        modelFilePath = "../TestModels_HW3/Slowbro";
-        std::cout << "Select: Rose Object" << std::endl;
-        break;
-    case 9:
-        modelFilePath = "../TestModels_HW3/TexCube";
-        std::cout << "Select: Soccer Object" << std::endl;
-    default:
-        break;
-    }
-
-    //Buile Up Selected Object Scene
-    SetupRenderState();
-    SetupScene(modelFilePath);
-}
-
-// Direction Menu Dealing Function
-void DirectionMenu(int index) {
-    // Chnage Direction
-    switch (index) {
-    case 1:
-        dirLight->SetDirection(glm::vec3(0, 0, -1));
-        break;
-    case 2:
-        dirLight->SetDirection(glm::vec3(-1, 0, -1));
-        break;
-    case 3:
-        dirLight->SetDirection(glm::vec3(-1, 0, 0));
-        break;
-    case 4:
-        dirLight->SetDirection(glm::vec3(-1, 0, 1));
-        break;
-    case 5:
-        dirLight->SetDirection(glm::vec3(0, 0, 1));
-        break;
-    case 6:
-        dirLight->SetDirection(glm::vec3(1, 0, 1));
-        break;
-    case 7:
-        dirLight->SetDirection(glm::vec3(1, 0, 0));
-        break;
-    case 8:
-        dirLight->SetDirection(glm::vec3(1, 0, -1));
-        break;
-    case 9:
-        dirLight->SetDirection(glm::vec3(0, 1, 0));
-        break;
-    case 10:
-        dirLight->SetDirection(glm::vec3(0, -1, 0));
-        break;
-    }
-}
-
-// Skybox Path Menu Dealing Function
-void SkyboxPathMenu(int index) {
-    if (skybox != nullptr) {
-        delete skybox;
-        skybox = nullptr;
-    }
-
-    switch (index) {
-    case 1:
-        skyFilePath = "../TestTextures_HW3/photostudio_02_2k.png";
-        break;
-    case 2:
-        skyFilePath = "../TestTextures_HW3/sunflowers_2k.png";
-        break;
-    case 3:
-        skyFilePath = "../TestTextures_HW3/veranda_2k.png";
-        break;
-    }
-    CreateSkybox(skyFilePath);
-}
-
-
-//Create Path Menu Function
-void createPathMenu() {
-    int mainMenu = glutCreateMenu(PathMenu);
-
-    glutAddMenuEntry("Ferrari Object", 1);
-    glutAddMenuEntry("Forklift Object", 2);
-    glutAddMenuEntry("Gengar Object", 3);
-    glutAddMenuEntry("Ivysaur Object", 4);
-    glutAddMenuEntry("Koffing Object", 5);
-    glutAddMenuEntry("MagikarpF Object", 6);
-    glutAddMenuEntry("Rose Object", 7);
-    glutAddMenuEntry("Slowbro Object", 8);
-    glutAddMenuEntry("TexCube Object", 9);
-
-    glutAttachMenu(GLUT_RIGHT_BUTTON);
-}
-
-// Create Dirtional Light Direction Menu Funciton
-void createDirectionMenu() {
-    int mainMenu = glutCreateMenu(DirectionMenu);
-
-    glutAddMenuEntry("From Front", 1);
-    glutAddMenuEntry("From Front Right", 2);
-    glutAddMenuEntry("From Right", 3);
-    glutAddMenuEntry("From Back Right", 4);
-    glutAddMenuEntry("From Back", 5);
-    glutAddMenuEntry("From Back Left", 6);
-    glutAddMenuEntry("From Left", 7);
-    glutAddMenuEntry("From Front Left", 8);
-    glutAddMenuEntry("From Bottom", 9);
-    glutAddMenuEntry("From Top", 10);
-
-
-    glutAttachMenu(GLUT_MIDDLE_BUTTON);
-}
-
-void createSkyBoxPathMenu() {
-    int mainMenu = glutCreateMenu(SkyboxPathMenu);
-
-    glutAddMenuEntry("Photos Studio", 1);
-    glutAddMenuEntry("Sunflowers", 2);
-    glutAddMenuEntry("Veranda", 3);
-
-    glutAttachMenu(GLUT_LEFT_BUTTON);
-}
-
-void SetupScene(const std::string& modelFilePath) {
-    LoadObjects(modelFilePath);
-    CreateLights();
-    CreateCamera();
-    CreateShaderLib();
-}
-
-int main(int argc, char** argv)
-{
-    // Setting window properties.
-    glutInit(&argc, argv);
-    glutSetOption(GLUT_MULTISAMPLE, 4);
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH | GLUT_MULTISAMPLE);
-    glutInitWindowSize(screenWidth, screenHeight);
-    glutInitWindowPosition(100, 100);
-    glutCreateWindow("Texture Mapping");
-
-    // Initialize GLEW.
-    // Must be done after glut is initialized!
-    GLenum res = glewInit();
-    if (res != GLEW_OK) {
-        std::cerr << "GLEW initialization error: " 
-                  << glewGetErrorString(res) << std::endl;
-        return 1;
-    }
-
-    // Initialization.
-    SetupRenderState();
-    SetupScene(modelFilePath);
-    CreateSkybox(skyFilePath);
-
-    // Initialize Path Menu
-    createPathMenu();
-
-    // Initialize Direction Menu
-    createDirectionMenu();
-
-    // Initialize Skybox Path Menu
-    createSkyBoxPathMenu();
-
-    // Register callback functions.
-    glutDisplayFunc(RenderSceneCB);
-    glutIdleFunc(RenderSceneCB);
-    glutReshapeFunc(ReshapeCB);
-    glutSpecialFunc(ProcessSpecialKeysCB);
-    glutKeyboardFunc(ProcessKeysCB);
-
-    // Start rendering loop.
-    glutMainLoop();
-
-    return 0;
-}
+﻿#include "headers.h"
+#include "trianglemesh.h"
+#include "camera.h"
+#include "shaderprog.h"
+#include "light.h"
+#include "imagetexture.h"
+#include "skybox.h"
+#include "threadpool.h"
+#include "occlusionculler.h"
+#include "alloccounter.h"
+#include "renderqueue.h"
+#include "uniformbuffer.h"
+#include "ringbuffer.h"
+#include "texturecache.h"
+
+#include <filesystem>
+
+
+// Global variables.
+int screenWidth = 600;
+int screenHeight = 600;
+// Triangle mesh.
+TriangleMesh* mesh = nullptr;
+// Lights.
+DirectionalLight* dirLight = nullptr;
+PointLight* pointLight = nullptr;
+SpotLight* spotLight = nullptr;
+glm::vec3 dirLightDirection = glm::vec3(0.0f, 0.0f, -1.0f);
+glm::vec3 dirLightRadiance = glm::vec3(0.6f, 0.6f, 0.6f);
+glm::vec3 pointLightPosition = glm::vec3(0.8f, 0.0f, 0.8f);
+glm::vec3 pointLightIntensity = glm::vec3(0.5f, 0.1f, 0.1f);
+glm::vec3 spotLightPosition = glm::vec3(0.0f, 1.0f, 0.0f);
+glm::vec3 spotLightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+glm::vec3 spotLightIntensity = glm::vec3(0.25f, 0.25f, 0.1f);
+float spotLightCutoffStartInDegree = 30.0f;
+float spotLightTotalWidthInDegree = 45.0f;
+glm::vec3 ambientLight = glm::vec3(0.2f, 0.2f, 0.2f);
+// Camera.
+Camera* camera = nullptr;
+glm::vec3 cameraPos = glm::vec3(0.0f, 1.0f, 5.0f);
+glm::vec3 cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
+glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+float fovy = 30.0f;
+float zNear = 0.1f;
+float zFar = 1000.0f;
+// Shader.
+FillColorShaderProg* fillColorShader = nullptr;
+PhongShadingDemoShaderProg* phongShadingShader = nullptr;
+PhongShadingDemoShaderProg* phongMultiDrawShader = nullptr;
+PhongShadingDemoShaderProg* phongInstancedShader = nullptr;
+SkyboxShaderProg* skyboxShader = nullptr;
+// UI.
+const float lightMoveSpeed = 0.2f;
+// Shading Mode
+int lightingMode = 0;
+// Skybox.
+Skybox* skybox = nullptr;
+float rotationSpeed = 1.0f;
+// Model loading: 1 = serial OBJ parsing, 0 = parse line-aligned chunks on every core.
+int loadThreads = 0;
+// Model switching: load the new model on the thread pool while the current one keeps rendering,
+// then upload it to GL over several frames, spending at most uploadBudgetMs per frame.
+bool asyncModelSwitch = true;
+const double uploadBudgetMs = 4.0;
+// Vertex layout: 16-byte quantized vertices and 16-bit indices instead of 32-byte floats ('v' toggles).
+bool compactVertices = true;
+// CPU copies of uploaded vertices, indices and decoded images: released unless --keep-cpu-copies.
+CpuResidency cpuResidency = CPU_RESIDENCY_RELEASE;
+// Texture storage: BC1/BC3 blocks saved as <image>.ktx, unless --textures none or bc7.
+TextureCompression textureCompression = TEXTURE_COMPRESSION_BC;
+// Mipmaps: gamma-correct CPU box filter at decode time, unless --mipmaps gpu or kaiser.
+MipGeneration mipGeneration = MIP_GENERATION_BOX;
+// Meshlet culling: only submit the clusters inside the frustum and facing the camera ('m' toggles).
+bool clusterCulling = true;
+int shownSubmittedTriangles = -1;
+int shownVisibleSubMeshes = -1;
+// Occlusion culling: the largest sub-meshes are rasterized into a CPU depth buffer and the
+// sub-meshes hidden behind them are not drawn ('o' toggles and prints the last frame's stats).
+bool occlusionCulling = true;
+OcclusionCuller occlusionCuller;
+const int occluderTriangleBudget = 2048;
+int shownOccludedSubMeshes = -1;
+// Heap allocations (operator new calls) made during the last RenderSceneCB. The steady-state
+// frame makes none. 'h' prints the GL thread's count, which leaves out loads running on the pool
+// meanwhile (and frame work on the workers). --alloc-test N checks the count of every thread
+// over N frames; nothing loads in the background there.
+uint64_t lastFrameAllocations = 0;
+uint64_t lastFrameProcessAllocations = 0;
+// Render queue: every draw of the frame is a packet sorted by pass, program, texture, material and
+// depth, and drawn through a state cache that skips redundant binds and uploads ('r' prints its counters).
+enum DrawableType
+{
+    DRAW_SUB_MESH,      // item: index of the sub-mesh in mesh.
+    DRAW_MESH,          // item: number of multi-draw commands at multiDrawCommandOffset.
+    DRAW_INSTANCES,     // item: band * sub-mesh count + sub-mesh index, over stressScene's instances.
+    DRAW_POINT_LIGHT,
+    DRAW_SPOT_LIGHT,
+    DRAW_SKYBOX
+};
+RenderQueue renderQueue;
+RenderStateCache renderState;
+// Camera and lights for every program, written once per frame; materials live in a buffer per mesh,
+// so a draw only sets the material's index.
+FrameUniforms frameUniforms;
+// Per-frame GPU data (frame uniforms, instance data) is bump-allocated from a fenced ring of
+// RING_BUFFER_FRAMES regions instead of being respecified every frame.
+RingBuffer streamBuffer;
+const size_t streamBufferFrameSize = 64 * 1024;
+// Multi-draw indirect: the visible sub-meshes go out as one glMultiDrawElementsIndirect over the
+// mesh's merged index buffer and texture array, where supported ('i' toggles).
+bool multiDrawIndirect = true;
+size_t multiDrawCommandOffset = 0;
+// Level of detail: the coarsest LOD whose error stays under lodPixelError on screen ('l' toggles).
+bool lodSelection = true;
+const float lodPixelError = 1.0f;
+
+
+std::string modelFilePath = "../TestModels_HW3/TexCube";
+std::string skyFilePath = "../TestTextures_HW3/photostudio_02_2k.png";
+
+// SceneObject.
+struct SceneObject
+{
+    SceneObject() {
+        mesh = nullptr;
+        worldMatrix = glm::mat4x4(1.0f);
+    }
+    TriangleMesh* mesh;
+    glm::mat4x4 worldMatrix;
+};
+SceneObject sceneObj;
+
+// ScenePointLight (for visualization of a point light).
+struct ScenePointLight
+{
+    ScenePointLight() {
+        light = nullptr;
+        worldMatrix = glm::mat4x4(1.0f);
+        visColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    }
+    PointLight* light;
+    glm::mat4x4 worldMatrix;
+    glm::vec3 visColor;
+};
+ScenePointLight pointLightObj;
+ScenePointLight spotLightObj;
+
+// PendingModel (a model being switched to in the background).
+struct PendingModel
+{
+    PendingModel() {
+        mesh = nullptr;
+        loaded = false;
+        uploadsQueued = false;
+        nextUpload = 0;
+        numUploadFrames = 0;
+        worstFrameMs = 0.0;
+    }
+    TriangleMesh* mesh;
+    std::string modelPath;
+    // Set by the loading thread once the mesh is parsed and its textures decoded.
+    std::atomic<bool> loaded;
+    bool uploadsQueued;
+    std::vector<std::function<void()>> uploads;
+    size_t nextUpload;
+    int numUploadFrames;
+    double worstFrameMs;
+    std::chrono::high_resolution_clock::time_point startTime;
+};
+PendingModel* pendingModel = nullptr;
+// Latest model picked from the menu; a load that finishes for an older pick is dropped.
+std::string requestedModelPath;
+
+// StressScene (copies of the model on a grid, drawn instanced, to see how the renderer scales).
+// Visible instances are grouped in distance bands; each band draws every sub-mesh once, at the
+// LOD of the band's nearest distance ('n' toggles, '+' / '-' scale the count by 10, --stress N).
+#define NUM_INSTANCE_BANDS 8
+struct StressScene
+{
+    StressScene() {
+        enabled = false;
+        numInstances = 1000;
+        builtInstances = 0;
+        builtMesh = nullptr;
+        instanceDataOffset = 0;
+        numVisible = 0;
+        numTriangles = 0;
+        for (int i = 0; i <= NUM_INSTANCE_BANDS; ++i)
+            bandStart[i] = 0;
+        for (int i = 0; i < NUM_INSTANCE_BANDS; ++i)
+            bandPixelsPerUnit[i] = 0.0f;
+        bandDistance = 1.0f;
+        titleMs = 0.0;
+        titleFrames = 0;
+    }
+    bool enabled;
+    int numInstances;
+    // Grid the instance data below was built for.
+    int builtInstances;
+    TriangleMesh* builtMesh;
+    std::vector<glm::vec3> offsets;         // Translation of each instance from the model's place.
+    BoxBatch boxes;                         // World bounds of each instance.
+    std::vector<unsigned char> visible;
+    std::vector<unsigned char> bands;
+    std::vector<int> slots;                 // Position of each visible instance in this frame's data.
+    // Instance data, ordered by band: band b holds instances bandStart[b] to bandStart[b + 1] - 1.
+    RingBuffer instanceBuffer;
+    size_t instanceDataOffset;
+    int bandStart[NUM_INSTANCE_BANDS + 1];
+    float bandPixelsPerUnit[NUM_INSTANCE_BANDS];
+    float bandDistance;                     // Band b > 0 starts at bandDistance * 2^(b - 1).
+    int numVisible;
+    int numTriangles;
+    // Frame time, averaged over the title's update interval.
+    double titleMs;
+    int titleFrames;
+};
+StressScene stressScene;
+const int maxStressInstances = 100000;
+
+// Function prototypes.
+void ReleaseResources();
+// Callback functions.
+void RenderSceneCB();
+void ReshapeCB(int, int);
+void ProcessSpecialKeysCB(int, int, int);
+void ProcessKeysCB(unsigned char, int, int);
+void SetupRenderState();
+void SetupScene(const std::string& modelFilePath);
+void LoadObjects(const std::string&);
+void CreateCamera();
+void CreateSkybox(const std::string);
+void CreateShaderLib();
+void CompareModelSources();
+void StartModelSwitch(const std::string&);
+void UpdateModelSwitch();
+void CancelModelSwitch();
+int RunAllocationTest(const int);
+int RunConeTest();
+void ExecuteRenderQueue();
+void UpdateFrameUniforms();
+void SetPhongObjectUniforms(PhongShadingDemoShaderProg*);
+void BindSubMeshMaterial(PhongShadingDemoShaderProg*, const SubMesh&, const PhongMaterial*&);
+void SetStressScene(const bool);
+void SubmitStressScene(TriangleMesh*);
+void UpdateStressTitle(const double);
+void ShowTextureCacheReport();
+
+
+
+void ReleaseResources()
+{
+    std::cout << "Resource Releasing..." << std::endl;
+    // A background load still uses the texture cache and the pool; let it finish first.
+    CancelModelSwitch();
+    // Delete scene objects and lights.
+    if (mesh != nullptr) {
+        delete mesh;
+        mesh = nullptr;
+    }
+    if (pointLight != nullptr) {
+        delete pointLight;
+        pointLight = nullptr;
+    }
+    if (dirLight != nullptr) {
+        delete dirLight;
+        dirLight = nullptr;
+    }
+    if (spotLight != nullptr) {
+        delete spotLight;
+        spotLight = nullptr;
+    }
+    // Delete camera.
+    if (camera != nullptr) {
+        delete camera;
+        camera = nullptr;
+    }
+    // Delete shaders.
+    if (fillColorShader != nullptr) {
+        delete fillColorShader;
+        fillColorShader = nullptr;
+    }
+    if (phongShadingShader != nullptr) {
+        delete phongShadingShader;
+        phongShadingShader = nullptr;
+    }
+    if (phongMultiDrawShader != nullptr) {
+        delete phongMultiDrawShader;
+        phongMultiDrawShader = nullptr;
+    }
+    if (phongInstancedShader != nullptr) {
+        delete phongInstancedShader;
+        phongInstancedShader = nullptr;
+    }
+    if (skyboxShader != nullptr) {
+        delete skyboxShader;
+        skyboxShader = nullptr;
+    }
+    streamBuffer.Release();
+    stressScene.instanceBuffer.Release();
+    std::cout << "Resource Releasing Finished" << std::endl;
+}
+
+static float curObjRotationY = 30.0f;
+const float rotStep = 0.02f;
+void RenderSceneCB()
+{
+    const uint64_t frameAllocationsStart = AllocCounter::GetThreadAllocations();
+    const uint64_t frameProcessAllocationsStart = AllocCounter::GetNumAllocations();
+    // Track the frame time while a model switch is in flight.
+    static auto lastFrameTime = std::chrono::high_resolution_clock::now();
+    auto frameTime = std::chrono::high_resolution_clock::now();
+    double frameMs = std::chrono::duration<double, std::milli>(frameTime - lastFrameTime).count();
+    if (pendingModel != nullptr)
+        pendingModel->worstFrameMs = std::max(pendingModel->worstFrameMs, frameMs);
+    lastFrameTime = frameTime;
+    UpdateModelSwitch();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    
+    streamBuffer.BeginFrame();
+    stressScene.instanceBuffer.BeginFrame();
+    renderQueue.Clear();
+    int numOccludedSubMeshes = 0;
+    TriangleMesh* pMesh = sceneObj.mesh;
+    if (pMesh != nullptr) {
+        // Update transform.
+        //curObjRotationY += rotStep;
+        glm::mat4x4 S = glm::scale(glm::mat4x4(1.0f), glm::vec3(1.5f, 1.5f, 1.5f));
+        glm::mat4x4 R = glm::rotate(glm::mat4x4(1.0f), glm::radians(curObjRotationY), glm::vec3(0, 1, 0));
+        sceneObj.worldMatrix = S * R;
+        // Stress scene: the instance grid replaces the single object.
+        if (stressScene.enabled && phongInstancedShader != nullptr) {
+            SubmitStressScene(pMesh);
+            UpdateStressTitle(frameMs);
+            pMesh = nullptr;
+        }
+        // Frustum culling: an object or sub-mesh outside the view gets no uniform setup and no draw.
+        else if (pMesh->CullSubMeshes(camera->GetFrustum(), sceneObj.worldMatrix) == 0)
+            pMesh = nullptr;
+    }
+    if (pMesh != nullptr) {
+        // Pick LODs from the object's size on screen, measured at the nearest point of its bounding sphere.
+        float objectScale = glm::length(glm::vec3(sceneObj.worldMatrix[0]));
+        float objectRadius = pMesh->GetBoundingRadius() * objectScale;
+        glm::vec3 objectCenter = glm::vec3(sceneObj.worldMatrix * glm::vec4(pMesh->GetBoundsCenter(), 1.0f));
+        float objectDistance = glm::length(camera->GetCameraPos() - objectCenter) - objectRadius;
+        float pixelsPerUnit = objectScale * camera->GetPixelsPerUnit(objectDistance, screenHeight);
+        pMesh->SelectLod(pixelsPerUnit, lodSelection ? lodPixelError : -1.0f);
+
+        // Occluders are rasterized at the LODs just selected; the occlusion test runs before any draw call.
+        if (occlusionCulling) {
+            occlusionCuller.BeginFrame(camera->GetProjMatrix() * camera->GetViewMatrix());
+            pMesh->AddOccluders(occlusionCuller, sceneObj.worldMatrix, occluderTriangleBudget);
+            occlusionCuller.Rasterize();
+            numOccludedSubMeshes = pMesh->CullOccludedSubMeshes(occlusionCuller);
+        }
+
+        // Meshlet bounds are in model space, so cull against the matrix without dequantization.
+        if (pMesh->GetClusterCulling()) {
+            glm::mat4x4 modelViewProj = camera->GetProjMatrix() * camera->GetViewMatrix() * sceneObj.worldMatrix;
+            glm::vec3 eyeInModel = glm::vec3(glm::inverse(sceneObj.worldMatrix) * glm::vec4(camera->GetCameraPos(), 1.0f));
+            pMesh->CullClusters(modelViewProj, eyeInModel);
+        }
+        
+        // Multi-draw: the whole mesh is one packet, its commands written to the stream buffer.
+        bool multiDrawn = false;
+        if (multiDrawIndirect && phongMultiDrawShader != nullptr && pMesh->CanMultiDraw()) {
+            const int maxCommands = pMesh->GetMaxDrawCommands();
+            void* commands = streamBuffer.Allocate(sizeof(DrawElementsIndirectCommand) * maxCommands, sizeof(GLuint), multiDrawCommandOffset);
+            if (commands != nullptr) {
+                const int numCommands = pMesh->WriteDrawCommands((DrawElementsIndirectCommand*)commands);
+                glm::vec3 center = glm::vec3(sceneObj.worldMatrix * glm::vec4(pMesh->GetBoundsCenter(), 1.0f));
+                if (numCommands > 0)
+                    renderQueue.Submit(RenderQueue::MakeSortKey(RENDER_PASS_OPAQUE, phongMultiDrawShader->GetProgramId(), 0, 0,
+                        glm::length(center - camera->GetCameraPos()) / zFar), DRAW_MESH, numCommands);
+                multiDrawn = true;
+            }
+        }
+
+        // Queue the visible sub-meshes the multi-draw left out (all of them without it); within a
+        // texture / material group they go front to back.
+        const std::vector<SubMesh>& subMeshes = pMesh->GetSubMeshes();
+        for (int i = 0; i < (int)subMeshes.size(); ++i) {
+            const SubMesh& subMesh = subMeshes[i];
+            if (!subMesh.visible || (multiDrawn && subMesh.multiDraw))
+                continue;
+            ImageTexture* texture = subMesh.material->GetMapKd();
+            glm::vec3 center = glm::vec3(sceneObj.worldMatrix * glm::vec4(subMesh.boundsCenter, 1.0f));
+            renderQueue.Submit(RenderQueue::MakeSortKey(RENDER_PASS_OPAQUE, phongShadingShader->GetProgramId(),
+                texture != nullptr ? texture->GetTextureId() : 0, (unsigned int)((uintptr_t)subMesh.material >> 4),
+                glm::length(center - camera->GetCameraPos()) / zFar), DRAW_SUB_MESH, i);
+        }
+    }
+    if (sceneObj.mesh != nullptr && !stressScene.enabled && (sceneObj.mesh->GetNumSubmittedTriangles() != shownSubmittedTriangles
+        || sceneObj.mesh->GetNumVisibleSubMeshes() != shownVisibleSubMeshes || numOccludedSubMeshes != shownOccludedSubMeshes)) {
+        shownSubmittedTriangles = sceneObj.mesh->GetNumSubmittedTriangles();
+        shownVisibleSubMeshes = sceneObj.mesh->GetNumVisibleSubMeshes();
+        shownOccludedSubMeshes = numOccludedSubMeshes;
+        std::string title = "Texture Mapping - " + std::to_string(shownSubmittedTriangles) + " / "
+            + std::to_string(sceneObj.mesh->GetNumTriangles()) + " triangles, "
+            + std::to_string(shownVisibleSubMeshes) + " / " + std::to_string(sceneObj.mesh->GetNumSubMeshes()) + " sub-meshes, "
+            + std::to_string(shownOccludedSubMeshes) + " occluded";
+        glutSetWindowTitle(title.c_str());
+    }
+    // -------------------------------------------------------------------------------------------
+
+    // Visualize the light with fill color. ------------------------------------------------------
+    if (pointLightObj.light != nullptr) {
+        pointLightObj.worldMatrix = glm::translate(glm::mat4x4(1.0f), pointLightObj.light->GetPosition());
+        renderQueue.Submit(RenderQueue::MakeSortKey(RENDER_PASS_GIZMO, fillColorShader->GetProgramId(), 0, 0,
+            glm::length(pointLightObj.light->GetPosition() - camera->GetCameraPos()) / zFar), DRAW_POINT_LIGHT, 0);
+    }
+    if (spotLightObj.light != nullptr) {
+        spotLightObj.worldMatrix = glm::translate(glm::mat4x4(1.0f), spotLightObj.light->GetPosition());
+        renderQueue.Submit(RenderQueue::MakeSortKey(RENDER_PASS_GIZMO, fillColorShader->GetProgramId(), 0, 0,
+            glm::length(spotLightObj.light->GetPosition() - camera->GetCameraPos()) / zFar), DRAW_SPOT_LIGHT, 0);
+    }
+    // -------------------------------------------------------------------------------------------
+
+    // Render skybox. ----------------------------------------------------------------------------
+    if (skybox != nullptr) {
+        renderQueue.Submit(RenderQueue::MakeSortKey(RENDER_PASS_SKY, skyboxShader->GetProgramId(),
+            skybox->GetTexture()->GetTextureId(), 0, 1.0f), DRAW_SKYBOX, 0);
+    }
+    // -------------------------------------------------------------------------------------------
+
+    renderQueue.Sort();
+    ExecuteRenderQueue();
+    streamBuffer.EndFrame();
+    stressScene.instanceBuffer.EndFrame();
+
+    lastFrameAllocations = AllocCounter::GetThreadAllocations() - frameAllocationsStart;
+    lastFrameProcessAllocations = AllocCounter::GetNumAllocations() - frameProcessAllocationsStart;
+    glutSwapBuffers();
+}
+
+// Issue the sorted packets, changing programs, textures and uniforms only where they differ
+// from the previous packet's.
+void ExecuteRenderQueue()
+{
+    renderState.BeginFrame();
+    UpdateFrameUniforms();
+    streamBuffer.FinishWrites();
+    const PhongMaterial* currentMaterial = nullptr;
+    int currentBand = -1;
+    for (const RenderPacket& packet : renderQueue.GetPackets()) {
+        switch (packet.drawable) {
+        case DRAW_SUB_MESH: {
+            const SubMesh& subMesh = sceneObj.mesh->GetSubMeshes()[packet.item];
+            // Program uniforms persist, so the object ones go up once per frame.
+            if (renderState.BindProgram(phongShadingShader)) {
+                SetPhongObjectUniforms(phongShadingShader);
+                currentMaterial = nullptr;
+            }
+            BindSubMeshMaterial(phongShadingShader, subMesh, currentMaterial);
+            sceneObj.mesh->Render(subMesh);
+            break;
+        }
+        case DRAW_INSTANCES: {
+            const int numSubMeshes = sceneObj.mesh->GetNumSubMeshes();
+            const int band = packet.item / numSubMeshes;
+            const SubMesh& subMesh = sceneObj.mesh->GetSubMeshes()[packet.item % numSubMeshes];
+            if (renderState.BindProgram(phongInstancedShader)) {
+                SetPhongObjectUniforms(phongInstancedShader);
+                currentMaterial = nullptr;
+            }
+            BindSubMeshMaterial(phongInstancedShader, subMesh, currentMaterial);
+            // Packets of one sub-mesh come band after band; re-point the instance data when the band changes.
+            if (band != currentBand) {
+                sceneObj.mesh->SetInstanceBuffer(stressScene.instanceBuffer.GetBufferId(),
+                    stressScene.instanceDataOffset + stressScene.bandStart[band] * sizeof(InstanceData));
+                currentBand = band;
+            }
+            const int lod = sceneObj.mesh->GetLodLevel(subMesh, stressScene.bandPixelsPerUnit[band], lodSelection ? lodPixelError : -1.0f);
+            sceneObj.mesh->RenderInstanced(subMesh, lod, stressScene.bandStart[band + 1] - stressScene.bandStart[band]);
+            break;
+        }
+        case DRAW_MESH: {
+            if (renderState.BindProgram(phongMultiDrawShader)) {
+                SetPhongObjectUniforms(phongMultiDrawShader);
+                currentMaterial = nullptr;
+            }
+            renderState.BindUniformBuffer(UNIFORM_BLOCK_MATERIALS, sceneObj.mesh->GetMaterialBuffer().GetBufferId(),
+                0, sizeof(MaterialUniforms) * MATERIALS_PER_BLOCK);
+            sceneObj.mesh->RenderMultiDraw(streamBuffer.GetBufferId(), multiDrawCommandOffset, packet.item);
+            break;
+        }
+        case DRAW_POINT_LIGHT:
+        case DRAW_SPOT_LIGHT: {
+            ScenePointLight& lightObj = (packet.drawable == DRAW_POINT_LIGHT) ? pointLightObj : spotLightObj;
+            renderState.BindProgram(fillColorShader);
+            renderState.SetUniform(fillColorShader->GetLocM(), lightObj.worldMatrix);
+            renderState.SetUniform(fillColorShader->GetLocFillColor(), lightObj.visColor);
+            lightObj.light->Draw();
+            break;
+        }
+        case DRAW_SKYBOX: {
+            renderState.BindProgram(skyboxShader);
+            renderState.SetUniform(skyboxShader->GetLocM(), skybox->GetRotationMatrix());
+            renderState.BindTexture(skybox->GetTexture());
+            renderState.SetUniform(skyboxShader->GetLocMapKd(), 0);
+            skybox->Draw();
+            break;
+        }
+        }
+    }
+    renderState.EndFrame();
+}
+
+// Camera and lighting data of the frame, shared by every program through the FrameUniforms block.
+void UpdateFrameUniforms()
+{
+    frameUniforms.viewProjMatrix = camera->GetProjMatrix() * camera->GetViewMatrix();
+    frameUniforms.cameraPos = glm::vec4(camera->GetCameraPos(), 1.0f);
+
+    // Set Light data; a missing light contributes nothing.
+    // Directional Light
+    frameUniforms.dirLightDir = glm::vec4(dirLight != nullptr ? dirLight->GetDirection() : glm::vec3(0.0f, 0.0f, -1.0f), 0.0f);
+    frameUniforms.dirLightRadiance = glm::vec4(dirLight != nullptr ? dirLight->GetRadiance() : glm::vec3(0.0f), 0.0f);
+    // Point Light
+    frameUniforms.pointLightPos = glm::vec4(pointLight != nullptr ? pointLight->GetPosition() : glm::vec3(0.0f), 1.0f);
+    frameUniforms.pointLightIntensity = glm::vec4(pointLight != nullptr ? pointLight->GetIntensity() : glm::vec3(0.0f), 0.0f);
+    // Spot Light
+    frameUniforms.spotLightPos = glm::vec4(spotLight != nullptr ? spotLight->GetPosition() : glm::vec3(0.0f), 1.0f);
+    frameUniforms.spotLightIntensity = glm::vec4(spotLight != nullptr ? spotLight->GetIntensity() : glm::vec3(0.0f), 0.0f);
+    frameUniforms.spotLightDir = glm::vec4(spotLight != nullptr ? spotLight->GetDirection() : glm::vec3(0.0f, -1.0f, 0.0f), 0.0f);
+    if (spotLight != nullptr)
+        frameUniforms.spotLightCone = glm::vec4(spotLight->GetTotalWidthDegree(), spotLight->GetFallofStartDegree(),
+            spotLight->GetCosTotalWidthDegree(), spotLight->GetCosFallofStartDegree());
+    else frameUniforms.spotLightCone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+    // Ambient Light
+    frameUniforms.ambientLight = glm::vec4(ambientLight, 0.0f);
+
+    // Lighting Mode
+    frameUniforms.lightingMode = lightingMode;
+
+    // Copy in one go: the mapped memory is write-combined.
+    size_t offset = 0;
+    void* data = streamBuffer.Allocate(sizeof(FrameUniforms), streamBuffer.GetUniformAlignment(), offset);
+    if (data != nullptr) {
+        memcpy(data, &frameUniforms, sizeof(FrameUniforms));
+        renderState.BindUniformBuffer(UNIFORM_BLOCK_FRAME, streamBuffer.GetBufferId(), offset, sizeof(FrameUniforms));
+    }
+}
+
+// Transform uniforms of a Phong program, shared by every sub-mesh of the object.
+void SetPhongObjectUniforms(PhongShadingDemoShaderProg* shader)
+{
+    // -------------------------------------------------------
+    // Note: if you want to compute lighting in the View Space, 
+    //       you might need to change the code below.
+    // -------------------------------------------------------
+    glm::mat4x4 normalMatrix = glm::transpose(glm::inverse(camera->GetViewMatrix() * sceneObj.worldMatrix));
+    // Compact positions are quantized to the mesh bounds; normals are encoded separately.
+    glm::mat4x4 positionMatrix = sceneObj.worldMatrix * sceneObj.mesh->GetDequantizeMatrix();
+
+    // Transformation Matrix; instanced programs take them per instance.
+    if (shader->GetLocM() >= 0) {
+        renderState.SetUniform(shader->GetLocM(), positionMatrix);
+        renderState.SetUniform(shader->GetLocNM(), normalMatrix);
+    }
+    renderState.SetUniform(shader->GetLocUseOctNormal(), sceneObj.mesh->UsesCompactVertices() ? 1 : 0);
+
+    // Texture Unit
+    renderState.SetUniform(shader->GetLocMapKd(), 0);
+}
+
+// Texture and material index of a sub-mesh, skipped if the last one drawn had the same material.
+void BindSubMeshMaterial(PhongShadingDemoShaderProg* shader, const SubMesh& subMesh, const PhongMaterial*& currentMaterial)
+{
+    if (subMesh.material == currentMaterial)
+        return;
+    currentMaterial = subMesh.material;
+    // Bind Texture Data
+    renderState.BindTexture(currentMaterial->GetMapKd());
+    // Select the Material in the Mesh's Material Buffer
+    const size_t windowSize = sizeof(MaterialUniforms) * MATERIALS_PER_BLOCK;
+    renderState.BindUniformBuffer(UNIFORM_BLOCK_MATERIALS, sceneObj.mesh->GetMaterialBuffer().GetBufferId(),
+        (subMesh.materialIndex / MATERIALS_PER_BLOCK) * windowSize, windowSize);
+    renderState.SetUniform(shader->GetLocMaterialIndex(), subMesh.materialIndex % MATERIALS_PER_BLOCK);
+}
+
+void SetStressScene(const bool enabled)
+{
+    if (enabled && phongInstancedShader == nullptr) {
+        std::cout << "Stress Scene: not available" << std::endl;
+        return;
+    }
+    stressScene.enabled = enabled;
+    stressScene.titleMs = 0.0;
+    stressScene.titleFrames = 0;
+    if (!enabled) {
+        // Detach the instance data and let the single-object title come back.
+        if (sceneObj.mesh != nullptr && sceneObj.mesh == stressScene.builtMesh)
+            sceneObj.mesh->SetInstanceBuffer(0, 0);
+        stressScene.builtMesh = nullptr;
+        shownSubmittedTriangles = -1;
+    }
+    std::cout << "Stress Scene: " << (enabled ? std::to_string(stressScene.numInstances) + " instances" : "off") << std::endl;
+}
+
+// Cull the instance grid, write the visible instances' data band by band and queue their draws.
+void SubmitStressScene(TriangleMesh* pMesh)
+{
+    StressScene& scene = stressScene;
+    const glm::mat4x4& baseMatrix = sceneObj.worldMatrix;
+    const float objectScale = glm::length(glm::vec3(baseMatrix[0]));
+    const float objectRadius = pMesh->GetBoundingRadius() * objectScale;
+    const glm::vec3 objectCenter = glm::vec3(baseMatrix * glm::vec4(pMesh->GetBoundsCenter(), 1.0f));
+
+    //Rebuild the Grid When the Count or the Model Changes
+    if (scene.builtMesh != pMesh || scene.builtInstances != scene.numInstances) {
+        const int n = scene.numInstances;
+        const int columns = (int)std::ceil(std::sqrt((double)n));
+        const float spacing = 2.2f * objectRadius;
+        glm::vec3 worldExtent = glm::vec3(0.0f);
+        for (int axis = 0; axis < 3; ++axis)
+            worldExtent += glm::abs(glm::vec3(baseMatrix[axis])) * pMesh->GetBoundsExtent()[axis];
+        scene.offsets.resize(n);
+        scene.boxes.Clear();
+        // Rows recede from the model's place, away from the default camera.
+        for (int i = 0; i < n; ++i) {
+            scene.offsets[i] = glm::vec3(((float)(i % columns) - 0.5f * (float)(columns - 1)) * spacing, 0.0f, -(float)(i / columns) * spacing);
+            scene.boxes.Add(objectCenter + scene.offsets[i], worldExtent);
+        }
+        scene.visible.resize(n);
+        scene.bands.resize(n);
+        scene.slots.resize(n);
+        if (scene.instanceBuffer.GetFrameSize() < sizeof(InstanceData) * n)
+            scene.instanceBuffer.Create(sizeof(InstanceData) * n);
+        scene.bandDistance = std::max(8.0f * objectRadius, zNear);
+        scene.builtInstances = n;
+        scene.builtMesh = pMesh;
+    }
+
+    //Frustum Cull, Then Bucket the Visible Instances by Distance
+    camera->GetFrustum().CullBoxes(scene.boxes, scene.visible.data());
+    int bandCounts[NUM_INSTANCE_BANDS] = {};
+    const glm::vec3 cameraPos = camera->GetCameraPos();
+    for (int i = 0; i < scene.builtInstances; ++i) {
+        if (!scene.visible[i])
+            continue;
+        const float distance = glm::length(objectCenter + scene.offsets[i] - cameraPos) - objectRadius;
+        int band = 0;
+        for (float bandEnd = scene.bandDistance; distance >= bandEnd && band < NUM_INSTANCE_BANDS - 1; bandEnd *= 2.0f)
+            band++;
+        scene.bands[i] = (unsigned char)band;
+        bandCounts[band]++;
+    }
+    scene.bandStart[0] = 0;
+    for (int band = 0; band < NUM_INSTANCE_BANDS; ++band) {
+        scene.bandStart[band + 1] = scene.bandStart[band] + bandCounts[band];
+        bandCounts[band] = scene.bandStart[band];
+        const float nearDistance = (band == 0) ? 0.0f : scene.bandDistance * (float)(1 << (band - 1));
+        scene.bandPixelsPerUnit[band] = objectScale * camera->GetPixelsPerUnit(nearDistance, screenHeight);
+    }
+    for (int i = 0; i < scene.builtInstances; ++i) {
+        if (scene.visible[i])
+            scene.slots[i] = bandCounts[scene.bands[i]]++;
+    }
+    scene.numVisible = scene.bandStart[NUM_INSTANCE_BANDS];
+    scene.numTriangles = 0;
+    if (scene.numVisible == 0)
+        return;
+
+    //Write the Instance Data on Every Core
+    InstanceData* instances = (InstanceData*)scene.instanceBuffer.Allocate(sizeof(InstanceData) * scene.numVisible,
+        sizeof(glm::vec4), scene.instanceDataOffset);
+    if (instances == nullptr)
+        return;
+    struct WriteTask
+    {
+        InstanceData* instances;
+        InstanceData base;
+    };
+    WriteTask task;
+    task.instances = instances;
+    task.base.worldMatrix = baseMatrix * pMesh->GetDequantizeMatrix();
+    // A translation leaves the normal transform of the linear part unchanged.
+    task.base.normalMatrix = glm::transpose(glm::inverse(camera->GetViewMatrix() * baseMatrix));
+    const int instancesPerTask = 4096;
+    ThreadPool::Shared().ParallelFor((scene.builtInstances + instancesPerTask - 1) / instancesPerTask, [&task](int taskIndex) {
+        const int first = taskIndex * instancesPerTask;
+        const int last = std::min(first + instancesPerTask, stressScene.builtInstances);
+        for (int i = first; i < last; ++i) {
+            if (!stressScene.visible[i])
+                continue;
+            InstanceData data = task.base;
+            data.worldMatrix[3] += glm::vec4(stressScene.offsets[i], 0.0f);
+            task.instances[stressScene.slots[i]] = data;
+        }
+    });
+    scene.instanceBuffer.FinishWrites();
+
+    //One Packet per Band and Sub-Mesh
+    const std::vector<SubMesh>& subMeshes = pMesh->GetSubMeshes();
+    const int numSubMeshes = (int)subMeshes.size();
+    for (int band = 0; band < NUM_INSTANCE_BANDS; ++band) {
+        const int count = scene.bandStart[band + 1] - scene.bandStart[band];
+        if (count == 0)
+            continue;
+        for (int i = 0; i < numSubMeshes; ++i) {
+            const SubMesh& subMesh = subMeshes[i];
+            const int lod = pMesh->GetLodLevel(subMesh, scene.bandPixelsPerUnit[band], lodSelection ? lodPixelError : -1.0f);
+            const size_t numIndices = (lod > 0) ? subMesh.lods[lod - 1].numIndices : subMesh.numIndices;
+            scene.numTriangles += (int)(numIndices / 3) * count;
+            ImageTexture* texture = subMesh.material->GetMapKd();
+            renderQueue.Submit(RenderQueue::MakeSortKey(RENDER_PASS_OPAQUE, phongInstancedShader->GetProgramId(),
+                texture != nullptr ? texture->GetTextureId() : 0, (unsigned int)((uintptr_t)subMesh.material >> 4),
+                ((float)band + 0.5f) / (float)NUM_INSTANCE_BANDS), DRAW_INSTANCES, band * numSubMeshes + i);
+        }
+    }
+}
+
+// Show the instance counts and the frame time, averaged over half a second.
+void UpdateStressTitle(const double frameMs)
+{
+    stressScene.titleMs += frameMs;
+    stressScene.titleFrames++;
+    if (stressScene.titleMs < 500.0)
+        return;
+    const double averageMs = stressScene.titleMs / stressScene.titleFrames;
+    std::ostringstream title;
+    title << "Stress Scene - " << stressScene.numVisible << " / " << stressScene.builtInstances << " instances, "
+        << stressScene.numTriangles << " triangles, " << std::fixed << std::setprecision(2) << averageMs << " ms / frame ("
+        << std::setprecision(0) << 1000.0 / averageMs << " fps)";
+    glutSetWindowTitle(title.str().c_str());
+    stressScene.titleMs = 0.0;
+    stressScene.titleFrames = 0;
+}
+
+void ReshapeCB(int w, int h)
+{
+    // Update viewport.
+    screenWidth = w;
+    screenHeight = h;
+    glViewport(0, 0, screenWidth, screenHeight);
+    // Adjust camera and projection.
+    float aspectRatio = (float)screenWidth / (float)screenHeight;
+    camera->UpdateProjection(fovy, aspectRatio, zNear, zFar);
+}
+
+void ProcessSpecialKeysCB(int key, int x, int y)
+{
+    // Handle special (functional) keyboard inputs such as F1, spacebar, page up, etc. 
+    switch (key) {
+    // Rendering mode.
+    case GLUT_KEY_F1:
+        // Render with point mode.
+        glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
+        break;
+    case GLUT_KEY_F2:
+        // Render with line mode.
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        break;
+    case GLUT_KEY_F3:
+        // Render with fill mode.
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        break;
+    case GLUT_KEY_F4:
+        // Chang Shading Mode
+        lightingMode++;
+        lightingMode = lightingMode % 4;
+        break;
+    
+    // Light control.
+    case GLUT_KEY_LEFT:
+        if (pointLight != nullptr)
+            pointLight->MoveLeft(lightMoveSpeed);
+        break;
+    case GLUT_KEY_RIGHT:
+        if (pointLight != nullptr)
+            pointLight->MoveRight(lightMoveSpeed);
+        break;
+    case GLUT_KEY_UP:
+        if (pointLight != nullptr)
+            pointLight->MoveUp(lightMoveSpeed);
+        break;
+    case GLUT_KEY_DOWN:
+        if (pointLight != nullptr)
+            pointLight->MoveDown(lightMoveSpeed);
+        break;
+    default:
+        break;
+    }
+}
+
+void ProcessKeysCB(unsigned char key, int x, int y)
+{
+    // Handle other keyboard inputs those are not defined as special keys.
+    if (key == 27) {
+        // Release memory allocation if needed.
+        ReleaseResources();
+        TextureCache::Shared().EvictIdle();
+        exit(0);
+    }
+    // Spot light control.
+    if (spotLight != nullptr) {
+        if (key == 'a')
+            spotLight->MoveLeft(lightMoveSpeed);
+        if (key == 'd')
+            spotLight->MoveRight(lightMoveSpeed);
+        if (key == 'w')
+            spotLight->MoveUp(lightMoveSpeed);
+        if (key == 's')
+            spotLight->MoveDown(lightMoveSpeed);
+    }
+
+    // Skybox rotate control
+    if (skybox != nullptr) {
+        if (key == 'z') {
+            skybox->RotateLeft(rotationSpeed);
+        }
+        if (key == 'c') {
+            skybox->RotateRight(rotationSpeed);
+
+        }
+    }
+
+    // Vertex layout toggle, to compare the compact vertices against full floats.
+    if (key == 'v' && mesh != nullptr) {
+        compactVertices = !compactVertices;
+        if (mesh->HasCpuCopies() || !mesh->UsesCompactVertices()) {
+            mesh->RestoreCpuCopies();
+            mesh->ReleaseBuffers();
+            mesh->SetCompactVertices(compactVertices);
+            mesh->CreateBuffer();
+            std::cout << "Vertex Layout: " << (compactVertices ? "compact" : "float") << std::endl;
+        }
+        else {
+            // Compact buffers only read back as quantized vertices: take the floats from the model again.
+            std::cout << "Vertex Layout: " << (compactVertices ? "compact" : "float") << ", reloading the model" << std::endl;
+            if (asyncModelSwitch)
+                StartModelSwitch(modelFilePath);
+            else {
+                ReleaseResources();
+                SetupRenderState();
+                SetupScene(modelFilePath);
+            }
+        }
+    }
+    // Stress scene toggle and instance count.
+    if (key == 'n')
+        SetStressScene(!stressScene.enabled);
+    if (key == '+' || key == '=' || key == '-') {
+        const int scaled = (key == '-') ? stressScene.numInstances / 10 : stressScene.numInstances * 10;
+        stressScene.numInstances = std::min(std::max(scaled, 1), maxStressInstances);
+        std::cout << "Stress Scene Instances: " << stressScene.numInstances << std::endl;
+    }
+    // Multi-draw indirect toggle.
+    if (key == 'i') {
+        multiDrawIndirect = !multiDrawIndirect;
+        std::cout << "Multi-Draw Indirect: " << (multiDrawIndirect ? "on" : "off")
+            << (phongMultiDrawShader == nullptr ? " (not supported, drawing per sub-mesh)" : "") << std::endl;
+    }
+    // LOD selection toggle.
+    if (key == 'l') {
+        lodSelection = !lodSelection;
+        std::cout << "LOD Selection: " << (lodSelection ? "on" : "off") << std::endl;
+    }
+    // Meshlet culling toggle; the window title shows the submitted triangles.
+    if (key == 'm' && mesh != nullptr) {
+        clusterCulling = !clusterCulling;
+        mesh->SetClusterCulling(clusterCulling);
+        std::cout << "Cluster Culling: " << (clusterCulling ? "on" : "off") << std::endl;
+    }
+    // Occlusion culling toggle, with the statistics of the last culled frame.
+    if (key == 'o') {
+        const OcclusionStats& stats = occlusionCuller.GetStats();
+        std::cout << "Occluder Triangles: " << stats.numOccluderTriangles << ", Culled Draws: " << stats.numCulled
+            << " / " << stats.numTested << ", Raster: " << stats.rasterSeconds * 1000.0 << " ms, Test: "
+            << stats.testSeconds * 1000.0 << " ms" << std::endl;
+        occlusionCulling = !occlusionCulling;
+        std::cout << "Occlusion Culling: " << (occlusionCulling ? "on" : "off") << std::endl;
+    }
+    // State changes of the last frame.
+    if (key == 'r') {
+        const RenderStats& stats = renderState.GetStats();
+        std::cout << "Render Queue: " << renderQueue.GetPackets().size() << " packets, " << stats.numProgramBinds
+            << " program binds, " << stats.numTextureBinds << " texture binds, " << stats.numBufferBinds
+            << " uniform buffer binds, " << stats.numUniformUploads << " uniform uploads" << std::endl;
+        const RingBufferStats& streamStats = streamBuffer.GetStats();
+        std::cout << "Stream Buffer: " << (streamBuffer.IsPersistent() ? "persistent" : "mapped per frame") << ", "
+            << streamStats.bytesAllocated << " / " << streamBuffer.GetFrameSize() << " bytes, "
+            << streamStats.numOverflows << " overflows, " << streamStats.numFenceWaits << " fence waits ("
+            << streamStats.waitSeconds * 1000.0 << " ms)" << std::endl;
+    }
+    // Heap allocations of the last frame.
+    if (key == 'h')
+        std::cout << "Heap Allocations Last Frame (GL thread): " << lastFrameAllocations << std::endl;
+}
+
+void SetupRenderState()
+{
+    glEnable(GL_DEPTH_TEST);
+
+    glm::vec4 clearColor = glm::vec4(0.44f, 0.57f, 0.75f, 1.00f);
+    glClearColor(
+        (GLclampf)(clearColor.r), 
+        (GLclampf)(clearColor.g), 
+        (GLclampf)(clearColor.b), 
+        (GLclampf)(clearColor.a)
+    );
+}
+
+void LoadObjects(const std::string& modelPath)
+{
+    mesh = new TriangleMesh();
+    mesh->SetCompactVertices(compactVertices);
+    mesh->SetCpuResidency(cpuResidency);
+    mesh->SetClusterCulling(clusterCulling);
+    mesh->LoadFromFile(modelPath, true, loadThreads);
+    mesh->ShowInfo();
+    sceneObj.mesh = mesh;    
+    mesh->CreateBuffer();
+    mesh->ShowMemoryReport();
+    ShowTextureCacheReport();
+}
+
+// Texture sharing across materials and reloads; a model seen recently loads with hits only.
+void ShowTextureCacheReport()
+{
+    const TextureCacheStats stats = TextureCache::Shared().GetStats();
+    std::cout << "Texture Cache: " << stats.numTextures << " textures (" << stats.numIdle << " idle), "
+              << stats.numHits << " hits, " << stats.numMisses << " misses, " << stats.numEvictions << " evictions, "
+              << std::fixed << std::setprecision(1) << stats.residentBytes / (1024.0 * 1024.0) << " MB resident ("
+              << stats.idleBytes / (1024.0 * 1024.0) << " MB idle)" << std::defaultfloat << std::setprecision(6) << std::endl;
+}
+
+void CreateLights()
+{
+    // Create a directional light.
+    dirLight = new DirectionalLight(dirLightDirection, dirLightRadiance);
+    // Create a point light.
+    pointLight = new PointLight(pointLightPosition, pointLightIntensity);
+    pointLightObj.light = pointLight;
+    pointLightObj.visColor = glm::normalize((pointLightObj.light)->GetIntensity());
+    // Create a spot light.
+    spotLight = new SpotLight(spotLightPosition, spotLightIntensity, spotLightDirection, 
+            spotLightCutoffStartInDegree, spotLightTotalWidthInDegree);
+    spotLightObj.light = spotLight;
+    spotLightObj.visColor = glm::normalize((spotLightObj.light)->GetIntensity());
+}
+
+void CreateCamera()
+{
+    // Create a camera and update view and proj matrices.
+    camera = new Camera((float)screenWidth / (float)screenHeight);
+    camera->UpdateView(cameraPos, cameraTarget, cameraUp);
+    float aspectRatio = (float)screenWidth / (float)screenHeight;
+    camera->UpdateProjection(fovy, aspectRatio, zNear, zFar);
+}
+
+void CreateSkybox(const std::string texFilePath)
+{
+    const int numSlices = 36;
+    const int numStacks = 18;
+    const float radius = 50.0f;
+    skybox = new Skybox(texFilePath, numSlices, numStacks, radius);
+}
+
+void CreateShaderLib()
+{
+    fillColorShader = new FillColorShaderProg();
+    if (!fillColorShader->LoadFromFiles("shaders/fixed_color.vs", "shaders/fixed_color.fs"))
+        exit(1);
+
+    phongShadingShader = new PhongShadingDemoShaderProg();
+    if (!phongShadingShader->LoadFromFiles("shaders/phong_shading_demo.vs", "shaders/phong_shading_demo.fs"))
+        exit(1);
+
+    skyboxShader = new SkyboxShaderProg();
+    if (!skyboxShader->LoadFromFiles("shaders/skybox.vs", "shaders/skybox.fs"))
+        exit(1);
+
+    // Same shader with per-instance transforms.
+    phongInstancedShader = new PhongShadingDemoShaderProg();
+    if (!phongInstancedShader->LoadFromFiles("shaders/phong_shading_demo.vs", "shaders/phong_shading_demo.fs", "#define INSTANCED\n"))
+        exit(1);
+
+    // Same shader, reading materials and textures per draw; only where multi-draw indirect works.
+    if (TriangleMesh::IsMultiDrawSupported()) {
+        phongMultiDrawShader = new PhongShadingDemoShaderProg();
+        if (!phongMultiDrawShader->LoadFromFiles("shaders/phong_shading_demo.vs", "shaders/phong_shading_demo.fs", "#define MULTI_DRAW\n"))
+            exit(1);
+    }
+
+    streamBuffer.Create(streamBufferFrameSize);
+}
+
+//Obcjet Path Menu Dealing Function
+void PathMenu(int index) {
+    //Change File Path
+    switch (index) {
+    case 1:
+        modelFilePath = "../TestModels_HW3/Ferrari";
+        std::cout << "Select: Bunny Object" << std::endl;
+        break;
+    case 2:
+        modelFilePath = "../TestModels_HW3/Forklift";
+        std::cout << "Select: ColorCube Object" << std::endl;
+        break;
+    case 3:
+        modelFilePath = "../TestModels_HW3/Gengar";
+        std::cout << "Select: Forklift Object" << std::endl;
+        break;
+    case 4:
+        modelFilePath = "../TestModels_HW3/Ivysaur";
+        std::cout << "Select: Gengar Object" << std::endl;
+        break;
+    case 5:
+        modelFilePath = "../TestModels_HW3/Koffing";
+        std::cout << "Select: Koffing Object" << std::endl;
+        break;
+    case 6:
+        modelFilePath = "../TestModels_HW3/MagikarpF";
+        std::cout << "Select: Ivysaur Object" << std::endl;
+        break;
+    case 7:
+        modelFilePath = "../TestModels_HW3/Rose";
+        std::cout << "Select: Pillows Object" << std::endl;
+        break;
+    case 8:
+        modelFilePath = "../TestModels_HW3/Slowbro";
+        std::cout << "Select: Rose Object" << std::endl;
+        break;
+    case 9:
+        modelFilePath = "../TestModels_HW3/TexCube";
+        std::cout << "Select: Soccer Object" << std::endl;
+    default:
+        break;
+    }
+
+    //Keep Rendering the Current Model While the New One Loads
+    if (asyncModelSwitch && mesh != nullptr) {
+        StartModelSwitch(modelFilePath);
+        return;
+    }
+
+    //ReleasResource First
+    ReleaseResources();
+
+    //Buile Up Selected Object Scene
+    SetupRenderState();
+    SetupScene(modelFilePath);
+}
+
+// Parse the model and decode its textures on the thread pool. Shaders, camera and lights stay.
+void StartModelSwitch(const std::string& modelPath)
+{
+    requestedModelPath = modelPath;
+    // A load is already running; UpdateModelSwitch restarts with the latest pick when it ends.
+    if (pendingModel != nullptr)
+        return;
+
+    pendingModel = new PendingModel();
+    pendingModel->modelPath = modelPath;
+    pendingModel->startTime = std::chrono::high_resolution_clock::now();
+    PendingModel* pending = pendingModel;
+    ThreadPool::Shared().Submit([pending]() {
+        pending->mesh = new TriangleMesh();
+        pending->mesh->SetDeferredUploads(true);
+        pending->mesh->SetCompactVertices(compactVertices);
+        pending->mesh->SetCpuResidency(cpuResidency);
+        pending->mesh->SetClusterCulling(clusterCulling);
+        pending->mesh->LoadFromFile(pending->modelPath, true, loadThreads);
+        pending->loaded.store(true, std::memory_order_release);
+    });
+}
+
+// Called at the start of every frame on the GL thread: run the pending GL uploads within the
+// frame budget, then swap the new mesh in between two frames.
+void UpdateModelSwitch()
+{
+    if (pendingModel == nullptr || !pendingModel->loaded.load(std::memory_order_acquire))
+        return;
+
+    //The Menu Moved On While Loading: Drop This Model and Load the Latest Pick
+    if (pendingModel->modelPath != requestedModelPath) {
+        delete pendingModel->mesh;
+        delete pendingModel;
+        pendingModel = nullptr;
+        StartModelSwitch(requestedModelPath);
+        return;
+    }
+
+    if (!pendingModel->uploadsQueued) {
+        pendingModel->mesh->AppendUploadTasks(pendingModel->uploads);
+        pendingModel->uploadsQueued = true;
+    }
+
+    //Upload Until the Budget Is Spent; At Least One Step per Frame so It Always Finishes
+    auto budgetStart = std::chrono::high_resolution_clock::now();
+    std::vector<std::function<void()>>& uploads = pendingModel->uploads;
+    while (pendingModel->nextUpload < uploads.size()) {
+        uploads[pendingModel->nextUpload++]();
+        double spentMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - budgetStart).count();
+        if (spentMs >= uploadBudgetMs)
+            break;
+    }
+    pendingModel->numUploadFrames++;
+    if (pendingModel->nextUpload < uploads.size())
+        return;
+
+    //Everything Is on the GPU: Swap the Meshes
+    TriangleMesh* oldMesh = mesh;
+    mesh = pendingModel->mesh;
+    sceneObj.mesh = mesh;
+    delete oldMesh;
+    mesh->ShowInfo();
+    mesh->ShowMemoryReport();
+    ShowTextureCacheReport();
+
+    double switchMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - pendingModel->startTime).count();
+    std::cout << "Model Switch Finished: " << switchMs << " ms, " << uploads.size() << " uploads over "
+              << pendingModel->numUploadFrames << " frames, worst frame " << pendingModel->worstFrameMs << " ms" << std::endl;
+    delete pendingModel;
+    pendingModel = nullptr;
+}
+
+// Wait for a background load to finish and drop its mesh (GL thread). Before exit this keeps the
+// loading task from outliving the texture cache and thread pool it uses.
+void CancelModelSwitch()
+{
+    if (pendingModel == nullptr)
+        return;
+    while (!pendingModel->loaded.load(std::memory_order_acquire))
+        std::this_thread::yield();
+    delete pendingModel->mesh;
+    delete pendingModel;
+    pendingModel = nullptr;
+}
+
+// Direction Menu Dealing Function
+void DirectionMenu(int index) {
+    // Chnage Direction
+    switch (index) {
+    case 1:
+        dirLight->SetDirection(glm::vec3(0, 0, -1));
+        break;
+    case 2:
+        dirLight->SetDirection(glm::vec3(-1, 0, -1));
+        break;
+    case 3:
+        dirLight->SetDirection(glm::vec3(-1, 0, 0));
+        break;
+    case 4:
+        dirLight->SetDirection(glm::vec3(-1, 0, 1));
+        break;
+    case 5:
+        dirLight->SetDirection(glm::vec3(0, 0, 1));
+        break;
+    case 6:
+        dirLight->SetDirection(glm::vec3(1, 0, 1));
+        break;
+    case 7:
+        dirLight->SetDirection(glm::vec3(1, 0, 0));
+        break;
+    case 8:
+        dirLight->SetDirection(glm::vec3(1, 0, -1));
+        break;
+    case 9:
+        dirLight->SetDirection(glm::vec3(0, 1, 0));
+        break;
+    case 10:
+        dirLight->SetDirection(glm::vec3(0, -1, 0));
+        break;
+    }
+}
+
+// Skybox Path Menu Dealing Function
+void SkyboxPathMenu(int index) {
+    if (skybox != nullptr) {
+        delete skybox;
+        skybox = nullptr;
+    }
+
+    switch (index) {
+    case 1:
+        skyFilePath = "../TestTextures_HW3/photostudio_02_2k.png";
+        break;
+    case 2:
+        skyFilePath = "../TestTextures_HW3/sunflowers_2k.png";
+        break;
+    case 3:
+        skyFilePath = "../TestTextures_HW3/veranda_2k.png";
+        break;
+    }
+    CreateSkybox(skyFilePath);
+}
+
+
+//Create Path Menu Function
+void createPathMenu() {
+    int mainMenu = glutCreateMenu(PathMenu);
+
+    glutAddMenuEntry("Ferrari Object", 1);
+    glutAddMenuEntry("Forklift Object", 2);
+    glutAddMenuEntry("Gengar Object", 3);
+    glutAddMenuEntry("Ivysaur Object", 4);
+    glutAddMenuEntry("Koffing Object", 5);
+    glutAddMenuEntry("MagikarpF Object", 6);
+    glutAddMenuEntry("Rose Object", 7);
+    glutAddMenuEntry("Slowbro Object", 8);
+    glutAddMenuEntry("TexCube Object", 9);
+
+    glutAttachMenu(GLUT_RIGHT_BUTTON);
+}
+
+// Create Dirtional Light Direction Menu Funciton
+void createDirectionMenu() {
+    int mainMenu = glutCreateMenu(DirectionMenu);
+
+    glutAddMenuEntry("From Front", 1);
+    glutAddMenuEntry("From Front Right", 2);
+    glutAddMenuEntry("From Right", 3);
+    glutAddMenuEntry("From Back Right", 4);
+    glutAddMenuEntry("From Back", 5);
+    glutAddMenuEntry("From Back Left", 6);
+    glutAddMenuEntry("From Left", 7);
+    glutAddMenuEntry("From Front Left", 8);
+    glutAddMenuEntry("From Bottom", 9);
+    glutAddMenuEntry("From Top", 10);
+
+
+    glutAttachMenu(GLUT_MIDDLE_BUTTON);
+}
+
+void createSkyBoxPathMenu() {
+    int mainMenu = glutCreateMenu(SkyboxPathMenu);
+
+    glutAddMenuEntry("Photos Studio", 1);
+    glutAddMenuEntry("Sunflowers", 2);
+    glutAddMenuEntry("Veranda", 3);
+
+    glutAttachMenu(GLUT_LEFT_BUTTON);
+}
+
+// Time .obj against .objm ingestion of every test model (run with --compare-sources).
+void CompareModelSources()
+{
+    const char* modelNames[] = { "Forklift", "Gengar", "Ivysaur", "Koffing", "MagikarpF", "Slowbro", "TexCube" };
+    const int numRuns = 5;
+    std::cout << std::left << std::setw(12) << "Model" << std::right
+              << std::setw(12) << ".obj ms" << std::setw(12) << ".objm ms"
+              << std::setw(12) << ".obj verts" << std::setw(12) << ".objm verts" << std::endl;
+    for (const char* modelName : modelNames) {
+        const std::string modelPath = std::string("../TestModels_HW3/") + modelName;
+        double bestSeconds[2] = { DBL_MAX, DBL_MAX };
+        int numVertices[2] = { 0, 0 };
+        const MeshSource sources[2] = { MESH_SOURCE_OBJ, MESH_SOURCE_OBJM };
+        for (int s = 0; s < 2; ++s) {
+            for (int run = 0; run < numRuns; ++run) {
+                // Silence the loader's progress output while timing.
+                std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+                TriangleMesh sourceMesh;
+                sourceMesh.SetMeshCacheEnabled(false);
+                sourceMesh.SetMeshSource(sources[s]);
+                sourceMesh.LoadFromFile(modelPath, true, loadThreads);
+                std::cout.rdbuf(coutBuffer);
+                bestSeconds[s] = std::min(bestSeconds[s], sourceMesh.GetIngestSeconds());
+                numVertices[s] = sourceMesh.GetNumVertices();
+            }
+        }
+        std::cout << std::left << std::setw(12) << modelName << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << bestSeconds[0] * 1000.0 << std::setw(12) << bestSeconds[1] * 1000.0
+                  << std::setw(12) << numVertices[0] << std::setw(12) << numVertices[1] << std::endl;
+    }
+}
+
+// Every .png and .jpg under the test models, sorted.
+static std::vector<std::string> ListTestImages()
+{
+    std::vector<std::string> imagePaths;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator("../TestModels_HW3", error)) {
+        const std::string extension = entry.path().extension().string();
+        if (extension == ".png" || extension == ".jpg")
+            imagePaths.push_back(entry.path().generic_string());
+    }
+    std::sort(imagePaths.begin(), imagePaths.end());
+    return imagePaths;
+}
+
+// PSNR of an RGBA image's color after a round trip through a block format.
+static double MeasureBlockPsnr(const cv::Mat& rgba, const BlockFormat format)
+{
+    std::vector<unsigned char> blocks(TextureCompressor::GetCompressedSize(format, rgba.cols, rgba.rows));
+    std::vector<unsigned char> decoded(rgba.total() * 4);
+    TextureCompressor::Compress(rgba.ptr(), rgba.cols, rgba.rows, rgba.step, format, blocks.data(), 0);
+    TextureCompressor::Decompress(blocks.data(), rgba.cols, rgba.rows, format, decoded.data());
+    double squaredError = 0.0;
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        if (i % 4 == 3)
+            continue;
+        const double difference = (double)decoded[i] - (double)rgba.data[i];
+        squaredError += difference * difference;
+    }
+    const double meanError = squaredError / (double)(rgba.total() * 3);
+    return (meanError > 0.0) ? 10.0 * std::log10(255.0 * 255.0 / meanError) : 99.0;
+}
+
+// Compare uncompressed, BC7 and BC textures on every image of the test models (run with
+// --compare-textures): first load (decode, plus encode and save for the compressed modes), warm
+// load (.ktx), upload, GPU memory with mipmaps and PSNR of level 0.
+void CompareTextureFormats()
+{
+    const std::vector<std::string> imagePaths = ListTestImages();
+    std::error_code error;
+
+    // BC runs last, so the .ktx files left behind are the default mode's.
+    const TextureCompression modes[3] = { TEXTURE_COMPRESSION_NONE, TEXTURE_COMPRESSION_BC7, TEXTURE_COMPRESSION_BC };
+    const char* modeNames[3] = { "none", "bc7", "bc" };
+    double totalLoadSeconds[3] = { 0.0, 0.0, 0.0 };
+    size_t totalGpuBytes[3] = { 0, 0, 0 };
+    std::cout << std::left << std::setw(40) << "Image" << std::setw(6) << "Mode" << std::right
+              << std::setw(12) << "first ms" << std::setw(12) << "warm ms" << std::setw(12) << "upload ms"
+              << std::setw(12) << "GPU KB" << std::setw(10) << "PSNR dB" << std::endl;
+    for (const std::string& imagePath : imagePaths) {
+        cv::Mat rgba = cv::imread(imagePath, cv::IMREAD_COLOR);
+        if (rgba.empty())
+            continue;
+        cv::cvtColor(rgba, rgba, cv::COLOR_BGR2RGBA);
+        for (int m = 0; m < 3; ++m) {
+            if (!ImageTexture::IsCompressionSupported(modes[m]))
+                continue;
+            ImageTexture::SetCompression(modes[m]);
+            std::filesystem::remove(imagePath + ".ktx", error);
+
+            //First Load Encodes, the Second Finds the .ktx
+            auto startTime = std::chrono::high_resolution_clock::now();
+            delete new ImageTexture(imagePath, true);
+            const double firstSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+            startTime = std::chrono::high_resolution_clock::now();
+            ImageTexture* texture = new ImageTexture(imagePath, true);
+            const double warmSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+            glFinish();
+            startTime = std::chrono::high_resolution_clock::now();
+            texture->Upload();
+            glFinish();
+            const double uploadSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+            const size_t gpuBytes = texture->GetGpuBytes();
+            delete texture;
+
+            double psnr = 0.0;
+            if (modes[m] == TEXTURE_COMPRESSION_BC7)
+                psnr = MeasureBlockPsnr(rgba, BLOCK_FORMAT_BC7);
+            else if (modes[m] == TEXTURE_COMPRESSION_BC)
+                psnr = MeasureBlockPsnr(rgba, BLOCK_FORMAT_BC1);
+            totalLoadSeconds[m] += warmSeconds + uploadSeconds;
+            totalGpuBytes[m] += gpuBytes;
+            std::cout << std::left << std::setw(40) << std::filesystem::path(imagePath).filename().string()
+                      << std::setw(6) << modeNames[m] << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(12) << firstSeconds * 1000.0 << std::setw(12) << warmSeconds * 1000.0
+                      << std::setw(12) << uploadSeconds * 1000.0 << std::setw(12) << gpuBytes / 1024.0
+                      << std::setw(10) << std::setprecision(1) << psnr << std::endl;
+        }
+    }
+    std::cout << "Totals (warm load + upload):" << std::endl;
+    for (int m = 0; m < 3; ++m) {
+        std::cout << "  " << std::left << std::setw(6) << modeNames[m] << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << totalLoadSeconds[m] * 1000.0 << " ms" << std::setw(12) << totalGpuBytes[m] / 1024.0
+                  << " KB (" << std::setprecision(1) << (totalGpuBytes[m] > 0 ? (double)totalGpuBytes[0] / totalGpuBytes[m] : 0.0)
+                  << "x smaller)" << std::endl;
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+    ImageTexture::SetCompression(textureCompression);
+}
+
+// Time MipBuilder (box serially and on the pool, Kaiser on the pool) against glGenerateMipmap on
+// every image of the test models (run with --compare-mipmaps). "Shift" is the mean of GL's level 1
+// minus the box filter's: negative where filtering the sRGB values directly darkens the texture.
+void CompareMipGeneration()
+{
+    const std::vector<std::string> imagePaths = ListTestImages();
+    double totalSeconds[4] = { 0.0, 0.0, 0.0, 0.0 };
+    std::cout << std::left << std::setw(40) << "Image" << std::right << std::setw(12) << "Size"
+              << std::setw(12) << "box 1T ms" << std::setw(10) << "box ms" << std::setw(12) << "kaiser ms"
+              << std::setw(10) << "GL ms" << std::setw(8) << "Shift" << std::endl;
+    for (const std::string& imagePath : imagePaths) {
+        cv::Mat image = cv::imread(imagePath, cv::IMREAD_COLOR);
+        if (image.empty())
+            continue;
+        const int width = image.cols;
+        const int height = image.rows;
+
+        //CPU Chains, Best of a Few Runs
+        const int numRuns = 3;
+        double seconds[4] = { DBL_MAX, DBL_MAX, DBL_MAX, DBL_MAX };
+        std::vector<MipLevel> boxLevels, kaiserLevels;
+        for (int run = 0; run < numRuns; ++run) {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            MipBuilder::Build(image.ptr(), width, height, image.step, 3, MIP_FILTER_BOX, boxLevels, 1);
+            seconds[0] = std::min(seconds[0], std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count());
+            startTime = std::chrono::high_resolution_clock::now();
+            MipBuilder::Build(image.ptr(), width, height, image.step, 3, MIP_FILTER_BOX, boxLevels, 0);
+            seconds[1] = std::min(seconds[1], std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count());
+            startTime = std::chrono::high_resolution_clock::now();
+            MipBuilder::Build(image.ptr(), width, height, image.step, 3, MIP_FILTER_KAISER, kaiserLevels, 0);
+            seconds[2] = std::min(seconds[2], std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count());
+        }
+
+        //GL Chain from the Same Level 0, Timed to Completion
+        GLuint textureId;
+        GLint packAlignment = 4, unpackAlignment = 4;
+        glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        for (int run = 0; run < numRuns; ++run) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, image.ptr());
+            glFinish();
+            auto startTime = std::chrono::high_resolution_clock::now();
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glFinish();
+            seconds[3] = std::min(seconds[3], std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count());
+        }
+        double shift = 0.0;
+        if (!boxLevels.empty()) {
+            std::vector<unsigned char> glLevel(boxLevels[0].pixels.size());
+            glGetTexImage(GL_TEXTURE_2D, 1, GL_BGR, GL_UNSIGNED_BYTE, glLevel.data());
+            for (size_t i = 0; i < glLevel.size(); ++i)
+                shift += (double)glLevel[i] - (double)boxLevels[0].pixels[i];
+            shift /= (double)glLevel.size();
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDeleteTextures(1, &textureId);
+        glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+
+        for (int i = 0; i < 4; ++i)
+            totalSeconds[i] += seconds[i];
+        std::cout << std::left << std::setw(40) << std::filesystem::path(imagePath).filename().string() << std::right
+                  << std::setw(12) << (std::to_string(width) + "x" + std::to_string(height)) << std::fixed << std::setprecision(2)
+                  << std::setw(12) << seconds[0] * 1000.0 << std::setw(10) << seconds[1] * 1000.0
+                  << std::setw(12) << seconds[2] * 1000.0 << std::setw(10) << seconds[3] * 1000.0
+                  << std::setw(8) << shift << std::endl;
+    }
+    std::cout << std::left << std::setw(52) << "Total" << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << totalSeconds[0] * 1000.0 << std::setw(10) << totalSeconds[1] * 1000.0
+              << std::setw(12) << totalSeconds[2] * 1000.0 << std::setw(10) << totalSeconds[3] * 1000.0 << std::endl;
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+// Allocation test: render numFrames frames offscreen after a warm-up and report every frame
+// that allocated from the heap. Returns the process exit code (0 when none did).
+int RunAllocationTest(const int numFrames)
+{
+    glutHideWindow();
+    GLuint fboId, colorId, depthId;
+    glGenRenderbuffers(1, &colorId);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, screenWidth, screenHeight);
+    glGenRenderbuffers(1, &depthId);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, screenWidth, screenHeight);
+    glGenFramebuffers(1, &fboId);
+    glBindFramebuffer(GL_FRAMEBUFFER, fboId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthId);
+    glViewport(0, 0, screenWidth, screenHeight);
+
+    // The first frames size the per-frame buffers (culling lists, task queue) and set the title.
+    const int numWarmupFrames = 8;
+    for (int frame = 0; frame < numWarmupFrames; ++frame)
+        RenderSceneCB();
+
+    int numAllocatingFrames = 0;
+    uint64_t totalAllocations = 0;
+    for (int frame = 0; frame < numFrames; ++frame) {
+        RenderSceneCB();
+        if (lastFrameProcessAllocations > 0) {
+            std::cout << "Frame " << frame << ": " << lastFrameProcessAllocations << " heap allocations" << std::endl;
+            numAllocatingFrames++;
+            totalAllocations += lastFrameProcessAllocations;
+        }
+    }
+    glFinish();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fboId);
+    glDeleteRenderbuffers(1, &colorId);
+    glDeleteRenderbuffers(1, &depthId);
+
+    std::cout << "Allocation Test: " << numFrames << " frames after " << numWarmupFrames << " warm-up frames, "
+              << numAllocatingFrames << " allocating, " << totalAllocations << " allocations in total - "
+              << (numAllocatingFrames == 0 ? "PASSED" : "FAILED") << std::endl;
+    return (numAllocatingFrames == 0) ? 0 : 1;
+}
+
+// Cone test: build a meshlet from a concave and from a convex pair of triangles and check
+// Meshlet::IsBackfacing from a grid of viewpoints. A viewpoint may only be culled when it is
+// behind every triangle plane. Returns the process exit code (0 when no visible cluster is culled).
+int RunConeTest()
+{
+    int numFailures = 0;
+    const float slopes[2] = { 1.0f, -1.0f };
+    for (const float slope : slopes) {
+        // Two faces z = slope * |x| meeting at x = 0: a valley for slope 1, a ridge for -1.
+        const std::vector<glm::vec3> positions = {
+            glm::vec3(-1.0f, -1.0f, slope), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+            glm::vec3(-1.0f, 1.0f, slope), glm::vec3(1.0f, -1.0f, slope), glm::vec3(1.0f, 1.0f, slope) };
+        std::vector<unsigned int> indices = { 0, 1, 2, 0, 2, 3, 1, 4, 5, 1, 5, 2 };
+        //Wind Every Triangle So Its Normal Points Up
+        std::vector<glm::vec3> normals;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            glm::vec3 n = glm::cross(positions[indices[i + 1]] - positions[indices[i]], positions[indices[i + 2]] - positions[indices[i]]);
+            if (n.z < 0.0f) {
+                std::swap(indices[i + 1], indices[i + 2]);
+                n = -n;
+            }
+            normals.push_back(glm::normalize(n));
+        }
+        std::vector<Meshlet> meshlets;
+        MeshletBuilder::Build(indices, (const unsigned char*)positions.data(), sizeof(glm::vec3), positions.size(), meshlets);
+        const Meshlet& meshlet = meshlets[0];
+
+        //Viewpoints on a Grid Through the Cluster; Skip Those on a Plane
+        int numBehind = 0, numCulled = 0, numVisibleCulled = 0;
+        for (int x = -8; x <= 8; ++x) {
+            for (int y = -8; y <= 8; ++y) {
+                for (int z = -8; z <= 8; ++z) {
+                    const glm::vec3 viewpoint = 0.25f * glm::vec3((float)x, (float)y, (float)z);
+                    bool inFront = false, onPlane = false;
+                    for (size_t t = 0; t < normals.size(); ++t) {
+                        const float distance = glm::dot(viewpoint - positions[indices[t * 3]], normals[t]);
+                        inFront = inFront || distance > 1e-4f;
+                        onPlane = onPlane || std::abs(distance) <= 1e-4f;
+                    }
+                    if (onPlane)
+                        continue;
+                    const bool culled = meshlet.IsBackfacing(viewpoint);
+                    numBehind += inFront ? 0 : 1;
+                    numCulled += culled ? 1 : 0;
+                    numVisibleCulled += (culled && inFront) ? 1 : 0;
+                }
+            }
+        }
+        // The faces are 90 degrees apart, so the cone must cull some of the viewpoints behind them.
+        const bool passed = numVisibleCulled == 0 && numCulled > 0;
+        numFailures += passed ? 0 : 1;
+        std::cout << "Cone Test (" << (slope > 0.0f ? "concave" : "convex") << "): apex (" << meshlet.coneApex.x << ", "
+                  << meshlet.coneApex.y << ", " << meshlet.coneApex.z << "), " << numCulled << " of " << numBehind
+                  << " viewpoints behind every plane culled, " << numVisibleCulled << " visible culled - "
+                  << (passed ? "PASSED" : "FAILED") << std::endl;
+    }
+    return (numFailures == 0) ? 0 : 1;
+}
+
+void SetupScene(const std::string& modelFilePath) {
+    LoadObjects(modelFilePath);
+    CreateLights();
+    CreateCamera();
+    CreateShaderLib();
+}
+
+int main(int argc, char** argv)
+{
+    // Setting window properties.
+    glutInit(&argc, argv);
+    glutSetOption(GLUT_MULTISAMPLE, 4);
+    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH | GLUT_MULTISAMPLE);
+    glutInitWindowSize(screenWidth, screenHeight);
+    glutInitWindowPosition(100, 100);
+    glutCreateWindow("Texture Mapping");
+
+    // Initialize GLEW.
+    // Must be done after glut is initialized!
+    GLenum res = glewInit();
+    if (res != GLEW_OK) {
+        std::cerr << "GLEW initialization error: " 
+                  << glewGetErrorString(res) << std::endl;
+        return 1;
+    }
+
+    // Residency of the CPU copies, before anything is loaded.
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--keep-cpu-copies")
+            cpuResidency = CPU_RESIDENCY_KEEP;
+    }
+    ImageTexture::SetCpuResidency(cpuResidency);
+
+    // Texture format, also before loading; a format GL cannot sample falls back to uncompressed.
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--textures") {
+            const std::string mode = argv[i + 1];
+            if (mode == "none")
+                textureCompression = TEXTURE_COMPRESSION_NONE;
+            else if (mode == "bc7")
+                textureCompression = TEXTURE_COMPRESSION_BC7;
+            else
+                textureCompression = TEXTURE_COMPRESSION_BC;
+        }
+    }
+    if (!ImageTexture::IsCompressionSupported(textureCompression)) {
+        std::cerr << "[WARNING] Compressed texture format not supported, uploading uncompressed textures" << std::endl;
+        textureCompression = TEXTURE_COMPRESSION_NONE;
+    }
+    ImageTexture::SetCompression(textureCompression);
+
+    // Mipmaps, likewise before loading.
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--mipmaps") {
+            const std::string mode = argv[i + 1];
+            if (mode == "gpu")
+                mipGeneration = MIP_GENERATION_GPU;
+            else if (mode == "kaiser")
+                mipGeneration = MIP_GENERATION_KAISER;
+            else
+                mipGeneration = MIP_GENERATION_BOX;
+        }
+    }
+    ImageTexture::SetMipGeneration(mipGeneration);
+
+    // Benchmark and test modes: compare the model source or texture formats, or the mipmap builders,
+    // or check the meshlet cones, and quit.
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--compare-sources") {
+            CompareModelSources();
+            return 0;
+        }
+        if (std::string(argv[i]) == "--compare-textures") {
+            CompareTextureFormats();
+            return 0;
+        }
+        if (std::string(argv[i]) == "--compare-mipmaps") {
+            CompareMipGeneration();
+            return 0;
+        }
+        if (std::string(argv[i]) == "--test-cones")
+            return RunConeTest();
+    }
+
+    // Initialization.
+    SetupRenderState();
+    SetupScene(modelFilePath);
+    CreateSkybox(skyFilePath);
+
+    // Initialize Path Menu
+    createPathMenu();
+
+    // Initialize Direction Menu
+    createDirectionMenu();
+
+    // Initialize Skybox Path Menu
+    createSkyBoxPathMenu();
+
+    // Stress scene: start with N instances of the model.
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--stress") {
+            stressScene.numInstances = std::min(std::max(std::atoi(argv[i + 1]), 1), maxStressInstances);
+            SetStressScene(true);
+        }
+    }
+
+    // Allocation test mode: render N offscreen frames, fail if the steady state allocates, and quit.
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--alloc-test") {
+            const int result = RunAllocationTest(std::max(std::atoi(argv[i + 1]), 1));
+            ReleaseResources();
+            return result;
+        }
+    }
+
+    // Register callback functions.
+    glutDisplayFunc(RenderSceneCB);
+    glutIdleFunc(RenderSceneCB);
+    glutReshapeFunc(ReshapeCB);
+    glutSpecialFunc(ProcessSpecialKeysCB);
+    glutKeyboardFunc(ProcessKeysCB);
+
+    // Start rendering loop.
+    glutMainLoop();
+
+    return 0;
+}
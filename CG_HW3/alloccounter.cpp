@@ -0,0 +1,194 @@
+#include "alloccounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+static std::atomic<uint64_t> numAllocations(0);
+static std::atomic<uint64_t> allocatedBytes(0);
+static thread_local uint64_t threadAllocations = 0;
+static thread_local uint64_t threadAllocatedBytes = 0;
+
+uint64_t AllocCounter::GetNumAllocations()
+{
+	return numAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocCounter::GetAllocatedBytes()
+{
+	return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocCounter::GetThreadAllocations()
+{
+	return threadAllocations;
+}
+
+uint64_t AllocCounter::GetThreadAllocatedBytes()
+{
+	return threadAllocatedBytes;
+}
+
+size_t AllocCounter::GetPeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return (size_t)usage.ru_maxrss;
+#else
+	return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+static void CountAllocation(const size_t size)
+{
+	numAllocations.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	threadAllocations++;
+	threadAllocatedBytes += size;
+}
+
+// Global replacements. The array and nothrow forms route through these, so every C++ heap
+// allocation of the program is counted once.
+void* operator new(size_t size)
+{
+	CountAllocation(size);
+	void* block = malloc(size != 0 ? size : 1);
+	if (block == nullptr)
+		throw std::bad_alloc();
+	return block;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	try {
+		return operator new(size);
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void* block) noexcept
+{
+	free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+	free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+	free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept
+{
+	free(block);
+}
+
+#ifdef __cpp_aligned_new
+// Over-aligned types (alignas above the default new alignment) come through these. Their
+// blocks need the matching aligned free, so the aligned deletes are replaced as well.
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	CountAllocation(size);
+	const size_t align = (size_t)alignment;
+	// aligned_alloc wants a size that is a multiple of the alignment.
+	const size_t alignedSize = (size != 0) ? (size + align - 1) / align * align : align;
+#ifdef _WIN32
+	void* block = _aligned_malloc(alignedSize, align);
+#else
+	void* block = aligned_alloc(align, alignedSize);
+#endif
+	if (block == nullptr)
+		throw std::bad_alloc();
+	return block;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	try {
+		return operator new(size, alignment);
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return operator new(size, alignment, std::nothrow);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+	_aligned_free(block);
+#else
+	free(block);
+#endif
+}
+
+void operator delete[](void* block, std::align_val_t alignment) noexcept
+{
+	operator delete(block, alignment);
+}
+
+void operator delete(void* block, size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(block, alignment);
+}
+
+void operator delete[](void* block, size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(block, alignment);
+}
+
+void operator delete(void* block, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	operator delete(block, alignment);
+}
+
+void operator delete[](void* block, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	operator delete(block, alignment);
+}
+#endif
@@ -0,0 +1,24 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// AllocCounter Declarations.
+// Process-wide and per-thread heap counters fed by the global operator new / delete
+// replacements in alloccounter.cpp. They only count in programs that link alloccounter.cpp.
+class AllocCounter
+{
+public:
+	// Number of operator new calls and bytes requested since the program started, on all threads.
+	static uint64_t GetNumAllocations();
+	static uint64_t GetAllocatedBytes();
+	// The same, counting only the calling thread's calls, so background work (model loads on the
+	// pool) does not show up in a reading taken around work on this thread.
+	static uint64_t GetThreadAllocations();
+	static uint64_t GetThreadAllocatedBytes();
+	// Peak resident set size (peak working set on Windows) of the process, in bytes.
+	static size_t GetPeakResidentBytes();
+};
+
+#endif
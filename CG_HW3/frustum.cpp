@@ -0,0 +1,49 @@
+#include "frustum.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define FRUSTUM_USE_SSE
+#endif
+
+void Frustum::CullBoxes(const BoxBatch& boxes, unsigned char* visible) const
+{
+	const size_t count = boxes.GetSize();
+	size_t i = 0;
+#ifdef FRUSTUM_USE_SSE
+	//Planes Broadcast Once; the Absolute Normal Gives Each Box's Projected Radius
+	__m128 normalX[6], normalY[6], normalZ[6], offset[6], absX[6], absY[6], absZ[6];
+	for (int p = 0; p < 6; ++p) {
+		normalX[p] = _mm_set1_ps(planes[p].x);
+		normalY[p] = _mm_set1_ps(planes[p].y);
+		normalZ[p] = _mm_set1_ps(planes[p].z);
+		offset[p] = _mm_set1_ps(planes[p].w);
+		absX[p] = _mm_set1_ps(std::abs(planes[p].x));
+		absY[p] = _mm_set1_ps(std::abs(planes[p].y));
+		absZ[p] = _mm_set1_ps(std::abs(planes[p].z));
+	}
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4) {
+		const __m128 cx = _mm_loadu_ps(&boxes.centerX[i]);
+		const __m128 cy = _mm_loadu_ps(&boxes.centerY[i]);
+		const __m128 cz = _mm_loadu_ps(&boxes.centerZ[i]);
+		const __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+		const __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+		const __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+		__m128 outside = zero;
+		for (int p = 0; p < 6; ++p) {
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX[p], cx), _mm_mul_ps(normalY[p], cy)),
+				_mm_add_ps(_mm_mul_ps(normalZ[p], cz), offset[p]));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], ex), _mm_mul_ps(absY[p], ey)), _mm_mul_ps(absZ[p], ez));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+		}
+		const int mask = _mm_movemask_ps(outside);
+		for (int k = 0; k < 4; ++k)
+			visible[i + k] = ((mask >> k) & 1) ? 0 : 1;
+	}
+#endif
+	for (; i < count; ++i) {
+		glm::vec3 center = glm::vec3(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+		glm::vec3 extent = glm::vec3(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+		visible[i] = IntersectsBox(center, extent) ? 1 : 0;
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm.hpp>
+#include <vector>
+#include <cstddef>
+
+// BoxBatch Declarations.
+// Axis-aligned boxes as center / half-extent, stored component by component so
+// Frustum::CullBoxes can test four at a time.
+struct BoxBatch
+{
+	void Clear() {
+		centerX.clear(); centerY.clear(); centerZ.clear();
+		extentX.clear(); extentY.clear(); extentZ.clear();
+	}
+	void Add(const glm::vec3& center, const glm::vec3& extent) {
+		centerX.push_back(center.x); centerY.push_back(center.y); centerZ.push_back(center.z);
+		extentX.push_back(extent.x); extentY.push_back(extent.y); extentZ.push_back(extent.z);
+	}
+	size_t GetSize() const { return centerX.size(); }
+
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;
+};
+
+// Frustum Declarations.
+// The six clip planes of a projection matrix (Gribb & Hartmann), normalized and pointing inward.
+// Built from projection * view * world, the planes live in the object's model space.
+struct Frustum
+{
+	Frustum() {
+		for (int i = 0; i < 6; ++i)
+			planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	Frustum(const glm::mat4x4& clipMatrix) {
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; ++i)
+			rows[i] = glm::vec4(clipMatrix[0][i], clipMatrix[1][i], clipMatrix[2][i], clipMatrix[3][i]);
+		planes[0] = rows[3] + rows[0];	// Left
+		planes[1] = rows[3] - rows[0];	// Right
+		planes[2] = rows[3] + rows[1];	// Bottom
+		planes[3] = rows[3] - rows[1];	// Top
+		planes[4] = rows[3] + rows[2];	// Near
+		planes[5] = rows[3] - rows[2];	// Far
+		for (int i = 0; i < 6; ++i)
+			planes[i] /= glm::length(glm::vec3(planes[i]));
+	}
+
+	// False only if the sphere is completely outside one of the planes.
+	bool IntersectsSphere(const glm::vec3& center, const float radius) const {
+		for (int i = 0; i < 6; ++i) {
+			if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+				return false;
+		}
+		return true;
+	}
+	// False only if the box is completely outside one of the planes.
+	bool IntersectsBox(const glm::vec3& center, const glm::vec3& extent) const {
+		for (int i = 0; i < 6; ++i) {
+			glm::vec3 normal = glm::vec3(planes[i]);
+			if (glm::dot(normal, center) + planes[i].w < -glm::dot(glm::abs(normal), extent))
+				return false;
+		}
+		return true;
+	}
+	// IntersectsBox for every box of the batch, four boxes per step with SSE; visible[i] gets 0 or 1.
+	void CullBoxes(const BoxBatch& boxes, unsigned char* visible) const;
+
+	glm::vec4 planes[6];
+};
+
+#endif
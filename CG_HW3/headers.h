@@ -1,27 +1,31 @@
-#ifndef HEADERS_H
-#define HEADERS_H
-
-// OpenGL and FreeGlut headers.
-#include <glew.h>
-#include <freeglut.h>
-
-// GLM.
-#include <glm.hpp>
-#include <gtc/type_ptr.hpp>
-
-// OpenCV.
-#include <opencv2/opencv.hpp>
-
-// C++ STL headers.
-#include <iostream>
-#include <vector>
-#include <string>
-#include <iomanip>
-#include <fstream>
-#include <sstream>
-#include <map>
-#include <math.h>
-
-#define PI 3.14159265
-
-#endif
+#ifndef HEADERS_H
+#define HEADERS_H
+
+// OpenGL and FreeGlut headers.
+#include <glew.h>
+#include <freeglut.h>
+
+// GLM.
+#include <glm.hpp>
+#include <gtc/type_ptr.hpp>
+
+// OpenCV.
+#include <opencv2/opencv.hpp>
+
+// C++ STL headers.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <math.h>
+
+#define PI 3.14159265
+
+#endif
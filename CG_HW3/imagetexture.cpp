@@ -1,76 +1,369 @@
-#include "imagetexture.h"
-
-ImageTexture::ImageTexture(const std::string filePath)
-	: texFilePath(filePath)
-{
-	imageWidth = 0;
-	imageHeight = 0;
-	numChannels = 0;
-	textureObj = 0;
-
-	// Try to load texture image.
-	texImage = cv::imread(texFilePath);
-	if (texImage.rows == 0 || texImage.cols == 0) {
-		std::cerr << "[ERROR] Failed to load image texture: " << filePath << std::endl;
-		return;
-	}
-	imageWidth = texImage.cols;
-	imageHeight = texImage.rows;
-	numChannels = texImage.channels();
-
-	// Flip texture in vertical direction.
-	// OpenCV has smaller y coordinate on top; while OpenGL has larger.
-	cv::flip(texImage, texImage, 0);
-
-	glGenTextures(1, &textureObj);
-    glBindTexture(GL_TEXTURE_2D, textureObj);
-    switch (numChannels) {
-	case 1:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, imageWidth, imageHeight, 
-						0, GL_RED, GL_UNSIGNED_BYTE, texImage.ptr());
-		break;
-	case 3:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 
-						0, GL_BGR, GL_UNSIGNED_BYTE, texImage.ptr());
-		break;
-	case 4:
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, imageWidth, imageHeight, 
-						0, GL_BGRA, GL_UNSIGNED_BYTE, texImage.ptr());
-		break;
-	default:
-		std::cerr << "[ERROR] Unsupport texture format" << std::endl;
-		break;
-	}
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	
-	glGenerateMipmap(GL_TEXTURE_2D);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-}
-
-ImageTexture::~ImageTexture()
-{
-	glDeleteTextures(1, &textureObj);
-	texImage.release();
-}
-
-void ImageTexture::Bind(GLenum textureUnit)
-{
-	glActiveTexture(textureUnit);
-    glBindTexture(GL_TEXTURE_2D, textureObj);
-}
-
-void ImageTexture::Preview()
-{
-	std::string windowText = "[DEBUG] TexturePreview: " + texFilePath;
-	cv::Mat previewImg = cv::Mat(texImage.rows, texImage.cols, texImage.type());
-	cv::cvtColor(texImage, previewImg, cv::COLOR_BGR2RGB);
-	cv::imshow(windowText, previewImg);
-	cv::waitKey(0);
-}
-
+#include "imagetexture.h"
+#include "ktxfile.h"
+#include "meshcache.h"
+
+CpuResidency ImageTexture::cpuResidency = CPU_RESIDENCY_RELEASE;
+TextureCompression ImageTexture::compression = TEXTURE_COMPRESSION_BC;
+MipGeneration ImageTexture::mipGeneration = MIP_GENERATION_BOX;
+
+ImageTexture::ImageTexture(const std::string filePath, const bool deferUpload)
+	: texFilePath(filePath)
+{
+	imageWidth = 0;
+	imageHeight = 0;
+	numChannels = 0;
+	textureObj = 0;
+	uploaded = false;
+
+	Decode();
+	if (!deferUpload)
+		Upload();
+}
+
+void ImageTexture::Decode()
+{
+	if (compression != TEXTURE_COMPRESSION_NONE && DecodeCompressed())
+		return;
+
+	// Try to load texture image.
+	texImage = cv::imread(texFilePath);
+	if (texImage.rows == 0 || texImage.cols == 0) {
+		std::cerr << "[ERROR] Failed to load image texture: " << texFilePath << std::endl;
+		return;
+	}
+	imageWidth = texImage.cols;
+	imageHeight = texImage.rows;
+	numChannels = texImage.channels();
+
+	// Flip texture in vertical direction.
+	// OpenCV has smaller y coordinate on top; while OpenGL has larger.
+	cv::flip(texImage, texImage, 0);
+
+	// Mipmaps here, off the GL thread, unless left to glGenerateMipmap.
+	if (mipGeneration != MIP_GENERATION_GPU)
+		MipBuilder::Build(texImage.ptr(), imageWidth, imageHeight, texImage.step, numChannels, GetMipFilter(), mipLevels, 0);
+}
+
+MipFilter ImageTexture::GetMipFilter()
+{
+	// Compressed chains are always built on the CPU, with the box filter when GL builds the others.
+	return (mipGeneration == MIP_GENERATION_KAISER) ? MIP_FILTER_KAISER : MIP_FILTER_BOX;
+}
+
+bool ImageTexture::DecodeCompressed()
+{
+	const std::string ktxPath = texFilePath + ".ktx";
+	uint64_t fileSize = 0;
+	int64_t modifiedTime = 0;
+	if (!MeshCache::GetFileStamp(texFilePath, fileSize, modifiedTime))
+		return false;
+
+	//Saved Chain of the Same Image, in a Format of This Mode, Filtered the Same Way
+	std::map<std::string, std::string> keyValues;
+	keyValues["SourceStamp"] = std::to_string(fileSize) + ' ' + std::to_string(modifiedTime);
+	keyValues["MipFilter"] = MipBuilder::GetFilterName(GetMipFilter());
+	std::map<std::string, std::string> savedKeyValues;
+	if (KtxFile::Read(ktxPath, compressedImage, savedKeyValues)
+		&& savedKeyValues["SourceStamp"] == keyValues["SourceStamp"] && savedKeyValues["MipFilter"] == keyValues["MipFilter"]
+		&& (compressedImage.format == BLOCK_FORMAT_BC7) == (compression == TEXTURE_COMPRESSION_BC7)) {
+		imageWidth = compressedImage.width;
+		imageHeight = compressedImage.height;
+		numChannels = (compressedImage.format == BLOCK_FORMAT_BC1) ? 3 : 4;
+		return true;
+	}
+	compressedImage = CompressedImage();
+
+	//Encode from RGBA8, Bottom Row First Like the Uncompressed Upload
+	cv::Mat image = cv::imread(texFilePath, cv::IMREAD_UNCHANGED);
+	if (image.empty())
+		return false;
+	if (image.depth() == CV_16U)
+		image.convertTo(image, CV_8U, 1.0 / 257.0);
+	if (image.depth() != CV_8U)
+		return false;
+	bool opaque = true;
+	switch (image.channels()) {
+	case 1:
+		cv::cvtColor(image, image, cv::COLOR_GRAY2RGBA);
+		break;
+	case 3:
+		cv::cvtColor(image, image, cv::COLOR_BGR2RGBA);
+		break;
+	case 4: {
+		cv::cvtColor(image, image, cv::COLOR_BGRA2RGBA);
+		cv::Mat alpha;
+		double minAlpha = 0.0;
+		cv::extractChannel(image, alpha, 3);
+		cv::minMaxLoc(alpha, &minAlpha);
+		opaque = (minAlpha >= 255.0);
+		break;
+	}
+	default:
+		return false;
+	}
+	cv::flip(image, image, 0);
+
+	BlockFormat format = BLOCK_FORMAT_BC7;
+	if (compression == TEXTURE_COMPRESSION_BC)
+		format = opaque ? BLOCK_FORMAT_BC1 : BLOCK_FORMAT_BC3;
+	TextureCompressor::CompressMipChain(image.ptr(), image.cols, image.rows, format, GetMipFilter(), compressedImage, 0);
+	if (!KtxFile::Write(ktxPath, compressedImage, keyValues))
+		std::cerr << "[WARNING] Failed to save compressed texture: " << ktxPath << std::endl;
+	imageWidth = image.cols;
+	imageHeight = image.rows;
+	numChannels = opaque ? 3 : 4;
+	return true;
+}
+
+void ImageTexture::Upload()
+{
+	if (uploaded || (texImage.empty() && compressedImage.data.empty()))
+		return;
+	AllocateStorage();
+	UploadRows(0, imageHeight);
+	for (int level = 1; level < GetNumLevels(); ++level)
+		UploadLevel(level);
+	FinishUpload();
+}
+
+void ImageTexture::AppendUploadTasks(std::vector<std::function<void()>>& tasks)
+{
+	if (uploaded || (texImage.empty() && compressedImage.data.empty()))
+		return;
+	// 256 rows (a multiple of the 4-row blocks) of a 2K RGB image are 1.5 MB, a fraction of a millisecond to copy.
+	const int bandRows = 256;
+	tasks.push_back([this]() { AllocateStorage(); });
+	for (int row = 0; row < imageHeight; row += bandRows) {
+		const int numRows = std::min(bandRows, imageHeight - row);
+		tasks.push_back([this, row, numRows]() { UploadRows(row, numRows); });
+	}
+	// Level 1 is a quarter of level 0 and each next one a quarter of that.
+	for (int level = 1; level < GetNumLevels(); ++level)
+		tasks.push_back([this, level]() { UploadLevel(level); });
+	tasks.push_back([this]() { FinishUpload(); });
+}
+
+bool ImageTexture::GetPixelFormat(GLint& internalFormat, GLenum& format) const
+{
+	switch (numChannels) {
+	case 1:
+		internalFormat = GL_RED;
+		format = GL_RED;
+		return true;
+	case 3:
+		internalFormat = GL_RGB;
+		format = GL_BGR;
+		return true;
+	case 4:
+		internalFormat = GL_RGBA;
+		format = GL_BGRA;
+		return true;
+	default:
+		return false;
+	}
+}
+
+void ImageTexture::AllocateStorage()
+{
+	GLint internalFormat;
+	GLenum format;
+	if (!IsCompressed() && !GetPixelFormat(internalFormat, format)) {
+		std::cerr << "[ERROR] Unsupport texture format" << std::endl;
+		return;
+	}
+
+	// An upload cut short (a dropped model switch) already has its texture object.
+	if (textureObj == 0)
+		glGenTextures(1, &textureObj);
+    glBindTexture(GL_TEXTURE_2D, textureObj);
+	if (IsCompressed()) {
+		// Every level is allocated now and filled by UploadRows and UploadLevel.
+		const GLenum blockFormat = KtxFile::GetInternalFormat(compressedImage.format);
+		for (size_t l = 0; l < compressedImage.levels.size(); ++l) {
+			const CompressedLevel& level = compressedImage.levels[l];
+			glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)l, blockFormat, level.width, level.height,
+				0, (GLsizei)level.size, nullptr);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)compressedImage.levels.size() - 1);
+	}
+	else {
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, imageWidth, imageHeight, 
+						0, format, GL_UNSIGNED_BYTE, nullptr);
+		// Levels built on the CPU; otherwise glGenerateMipmap makes them in FinishUpload.
+		for (size_t l = 0; l < mipLevels.size(); ++l) {
+			glTexImage2D(GL_TEXTURE_2D, (GLint)l + 1, internalFormat, mipLevels[l].width, mipLevels[l].height,
+				0, format, GL_UNSIGNED_BYTE, nullptr);
+		}
+		if (!mipLevels.empty())
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)mipLevels.size());
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void ImageTexture::UploadRows(const int firstRow, const int numRows)
+{
+	if (IsCompressed()) {
+		// Whole rows of blocks: firstRow is a multiple of 4, and only the last band may be short.
+		if (textureObj == 0 || compressedImage.data.empty())
+			return;
+		const size_t blockRowBytes = (size_t)((imageWidth + 3) / 4) * TextureCompressor::GetBlockBytes(compressedImage.format);
+		glBindTexture(GL_TEXTURE_2D, textureObj);
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, imageWidth, numRows,
+			KtxFile::GetInternalFormat(compressedImage.format), (GLsizei)((numRows + 3) / 4 * blockRowBytes),
+			compressedImage.data.data() + compressedImage.levels[0].offset + firstRow / 4 * blockRowBytes);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return;
+	}
+
+	GLint internalFormat;
+	GLenum format;
+	if (textureObj == 0 || !GetPixelFormat(internalFormat, format))
+		return;
+
+	glBindTexture(GL_TEXTURE_2D, textureObj);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, imageWidth, numRows,
+					format, GL_UNSIGNED_BYTE, texImage.ptr(firstRow));
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void ImageTexture::FinishUpload()
+{
+	if (textureObj == 0)
+		return;
+
+	// Without CPU levels (MIP_GENERATION_GPU) GL builds them from level 0.
+	if (!IsCompressed() && mipLevels.empty()) {
+		glBindTexture(GL_TEXTURE_2D, textureObj);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	uploaded = true;
+	// The GPU has every level now; Preview decodes the file again if it needs the pixels.
+	if (cpuResidency == CPU_RESIDENCY_RELEASE) {
+		texImage.release();
+		std::vector<MipLevel>().swap(mipLevels);
+		std::vector<unsigned char>().swap(compressedImage.data);
+	}
+}
+
+void ImageTexture::UploadLevel(const int level)
+{
+	if (textureObj == 0)
+		return;
+	glBindTexture(GL_TEXTURE_2D, textureObj);
+	if (IsCompressed() && !compressedImage.data.empty()) {
+		const CompressedLevel& compressedLevel = compressedImage.levels[level];
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, compressedLevel.width, compressedLevel.height,
+			KtxFile::GetInternalFormat(compressedImage.format), (GLsizei)compressedLevel.size,
+			compressedImage.data.data() + compressedLevel.offset);
+	}
+	else if (level <= (int)mipLevels.size()) {
+		// Small levels have rows of any length; the default unpack alignment expects 4 bytes.
+		GLint internalFormat, unpackAlignment = 4;
+		GLenum format;
+		GetPixelFormat(internalFormat, format);
+		const MipLevel& mipLevel = mipLevels[level - 1];
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mipLevel.width, mipLevel.height,
+			format, GL_UNSIGNED_BYTE, mipLevel.pixels.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+int ImageTexture::GetNumLevels() const
+{
+	return IsCompressed() ? (int)compressedImage.levels.size() : (int)mipLevels.size() + 1;
+}
+
+ImageTexture::~ImageTexture()
+{
+	if (textureObj != 0)
+		glDeleteTextures(1, &textureObj);
+	texImage.release();
+}
+
+size_t ImageTexture::GetCpuBytes() const
+{
+	size_t bytes = texImage.total() * texImage.elemSize() + compressedImage.data.size();
+	for (const MipLevel& level : mipLevels)
+		bytes += level.pixels.size();
+	return bytes;
+}
+
+size_t ImageTexture::GetResidentBytes() const
+{
+	return GetCpuBytes() + GetGpuBytes();
+}
+
+size_t ImageTexture::GetGpuBytes() const
+{
+	if (textureObj == 0)
+		return 0;
+	if (!IsCompressed())
+		return GetUncompressedGpuBytes();
+	size_t bytes = 0;
+	for (const CompressedLevel& level : compressedImage.levels)
+		bytes += level.size;
+	return bytes;
+}
+
+size_t ImageTexture::GetUncompressedGpuBytes() const
+{
+	// Every level down to 1x1; GL pads rows to 4 bytes by default.
+	size_t bytes = 0;
+	int width = imageWidth;
+	int height = imageHeight;
+	while (width > 0 && height > 0) {
+		bytes += (size_t)((width * numChannels + 3) / 4 * 4) * (size_t)height;
+		if (width == 1 && height == 1)
+			break;
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+	return bytes;
+}
+
+void ImageTexture::Bind(GLenum textureUnit)
+{
+	glActiveTexture(textureUnit);
+    glBindTexture(GL_TEXTURE_2D, textureObj);
+}
+
+void ImageTexture::Preview()
+{
+	// Decode a released (or compressed) image again, just for the preview.
+	cv::Mat image = texImage;
+	if (image.empty()) {
+		image = cv::imread(texFilePath);
+		if (image.empty())
+			return;
+		cv::flip(image, image, 0);
+	}
+	std::string windowText = "[DEBUG] TexturePreview: " + texFilePath;
+	cv::Mat previewImg = cv::Mat(image.rows, image.cols, image.type());
+	cv::cvtColor(image, previewImg, cv::COLOR_BGR2RGB);
+	cv::imshow(windowText, previewImg);
+	cv::waitKey(0);
+}
+
+bool ImageTexture::IsCompressionSupported(const TextureCompression mode)
+{
+	switch (mode) {
+	case TEXTURE_COMPRESSION_BC:
+		return GLEW_EXT_texture_compression_s3tc;
+	case TEXTURE_COMPRESSION_BC7:
+		return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	default:
+		return true;
+	}
+}
+
@@ -1,29 +1,112 @@
-#ifndef IMAGE_TEXTURE_H
-#define IMAGE_TEXTURE_H
-
-#include "headers.h"
-
-// Texture Declarations.
-class ImageTexture
-{
-public:
-	// Texture Public Methods.
-	ImageTexture(const std::string filePath);
-	~ImageTexture();
-
-	void Bind(GLenum textureUnit);
-	void Preview();
-	std::string GetPath() const { return texFilePath; }
-
-private:
-	// Texture Private Data.
-	std::string texFilePath;
-	GLuint textureObj;
-	int imageWidth;
-	int imageHeight;
-	int numChannels;
-	cv::Mat texImage;
-};
-
-#endif
-
+#ifndef IMAGE_TEXTURE_H
+#define IMAGE_TEXTURE_H
+
+#include "headers.h"
+#include "texturecompressor.h"
+#include "mipbuilder.h"
+
+// What stays in CPU memory once data is on the GPU.
+enum CpuResidency
+{
+	CPU_RESIDENCY_RELEASE,		// Free the CPU copy after upload; read it back or decode it again on demand.
+	CPU_RESIDENCY_KEEP			// Keep it for the object's lifetime.
+};
+
+// How textures are stored on the GPU.
+enum TextureCompression
+{
+	TEXTURE_COMPRESSION_NONE,	// Uncompressed pixels.
+	TEXTURE_COMPRESSION_BC,		// BC1 for opaque images, BC3 with alpha (4 or 8 bits per pixel).
+	TEXTURE_COMPRESSION_BC7		// BC7 for every image (8 bits per pixel).
+};
+
+// Where the mipmaps of a texture come from.
+enum MipGeneration
+{
+	MIP_GENERATION_GPU,			// glGenerateMipmap at upload; compressed chains use the CPU box filter.
+	MIP_GENERATION_BOX,			// MipBuilder box filter at decode time.
+	MIP_GENERATION_KAISER		// MipBuilder Kaiser filter at decode time.
+};
+
+// Texture Declarations.
+class ImageTexture
+{
+public:
+	// Texture Public Methods.
+	// deferUpload: only decode here (safe off the GL thread); the GL work is left to Upload or
+	// to the tasks from AppendUploadTasks, which must run in order on the GL thread.
+	ImageTexture(const std::string filePath, const bool deferUpload = false);
+	~ImageTexture();
+
+	// Upload a deferred texture in one go, on the GL thread.
+	void Upload();
+
+	// Append the GL upload of a deferred texture as small steps: allocate, one per band of
+	// rows, one per mip level, then the finish (glGenerateMipmap if the CPU built no levels).
+	void AppendUploadTasks(std::vector<std::function<void()>>& tasks);
+	bool IsUploaded() const { return uploaded; }
+
+	// Holds a block-compressed mip chain rather than pixels.
+	bool IsCompressed() const { return !compressedImage.levels.empty(); }
+
+	void Bind(GLenum textureUnit);
+	void Preview();
+	std::string GetPath() const { return texFilePath; }
+	GLuint GetTextureId() const { return textureObj; }
+	// Decoded pixels still held plus the GL storage with its mipmaps.
+	size_t GetResidentBytes() const;
+	// The GL storage alone, and what it would take as uncompressed pixels.
+	size_t GetGpuBytes() const;
+	size_t GetUncompressedGpuBytes() const;
+	// Decoded pixels or compressed blocks still held, and the size of the decoded pixels.
+	size_t GetCpuBytes() const;
+	size_t GetDecodedBytes() const { return (size_t)imageWidth * imageHeight * numChannels; }
+
+	// Policy for the decoded image of textures uploaded from now on (release by default).
+	static void SetCpuResidency(const CpuResidency residency) { cpuResidency = residency; }
+	static CpuResidency GetCpuResidency() { return cpuResidency; }
+	// Format of textures decoded from now on (BC by default). Compressed mip chains are saved as
+	// <image>.ktx and loaded from there while the image is unchanged.
+	static void SetCompression(const TextureCompression mode) { compression = mode; }
+	static TextureCompression GetCompression() { return compression; }
+	// Whether the current GL context can sample the formats of a mode (after glewInit).
+	static bool IsCompressionSupported(const TextureCompression mode);
+	// Mipmaps of textures decoded from now on (CPU box filter by default). The filter is saved
+	// in the .ktx, so changing it encodes the images again.
+	static void SetMipGeneration(const MipGeneration mode) { mipGeneration = mode; }
+	static MipGeneration GetMipGeneration() { return mipGeneration; }
+
+private:
+	// Texture Private Methods.
+	void Decode();
+	// Load the compressed chain saved next to the image, or encode the image and save it.
+	// False leaves the image to the uncompressed path.
+	bool DecodeCompressed();
+	bool GetPixelFormat(GLint& internalFormat, GLenum& format) const;
+	void AllocateStorage();
+	void UploadRows(const int firstRow, const int numRows);
+	void UploadLevel(const int level);
+	void FinishUpload();
+	// Level 0 included.
+	int GetNumLevels() const;
+	static MipFilter GetMipFilter();
+
+	// Texture Private Data.
+	std::string texFilePath;
+	GLuint textureObj;
+	int imageWidth;
+	int imageHeight;
+	int numChannels;
+	cv::Mat texImage;
+	// Levels 1..n of texImage when the CPU builds them.
+	std::vector<MipLevel> mipLevels;
+	// Levels stay listed after upload; only their data is released.
+	CompressedImage compressedImage;
+	bool uploaded;
+	static CpuResidency cpuResidency;
+	static TextureCompression compression;
+	static MipGeneration mipGeneration;
+};
+
+#endif
+
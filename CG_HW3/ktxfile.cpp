@@ -0,0 +1,161 @@
+#include "ktxfile.h"
+#include "mappedfile.h"
+#include "meshcache.h"
+
+static const unsigned char ktxIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// KtxHeader Declarations.
+struct KtxHeader
+{
+	unsigned char identifier[12];
+	uint32_t endianness;		// 0x04030201 when written in this machine's byte order.
+	uint32_t glType;			// 0 for compressed data.
+	uint32_t glTypeSize;
+	uint32_t glFormat;			// 0 for compressed data.
+	uint32_t glInternalFormat;
+	uint32_t glBaseInternalFormat;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t numberOfArrayElements;
+	uint32_t numberOfFaces;
+	uint32_t numberOfMipmapLevels;
+	uint32_t bytesOfKeyValueData;
+};
+
+GLenum KtxFile::GetInternalFormat(const BlockFormat format)
+{
+	switch (format) {
+	case BLOCK_FORMAT_BC1:
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case BLOCK_FORMAT_BC3:
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	default:
+		return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+}
+
+static void AppendUint32(std::string& contents, const uint32_t value)
+{
+	contents.append((const char*)&value, sizeof(value));
+}
+
+bool KtxFile::Write(const std::string& filePath, const CompressedImage& image,
+	const std::map<std::string, std::string>& keyValues)
+{
+	//Each Pair: Its Size, Key and Value Null Terminated, Padded to 4 Bytes
+	std::string keyValueData;
+	for (const auto& element : keyValues) {
+		const uint32_t pairSize = (uint32_t)(element.first.size() + 1 + element.second.size() + 1);
+		AppendUint32(keyValueData, pairSize);
+		keyValueData.append(element.first.c_str(), element.first.size() + 1);
+		keyValueData.append(element.second.c_str(), element.second.size() + 1);
+		keyValueData.append((4 - pairSize % 4) % 4, '\0');
+	}
+
+	KtxHeader header;
+	memcpy(header.identifier, ktxIdentifier, sizeof(ktxIdentifier));
+	header.endianness = 0x04030201;
+	header.glType = 0;
+	header.glTypeSize = 1;
+	header.glFormat = 0;
+	header.glInternalFormat = GetInternalFormat(image.format);
+	header.glBaseInternalFormat = (image.format == BLOCK_FORMAT_BC1) ? GL_RGB : GL_RGBA;
+	header.pixelWidth = (uint32_t)image.width;
+	header.pixelHeight = (uint32_t)image.height;
+	header.pixelDepth = 0;
+	header.numberOfArrayElements = 0;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = (uint32_t)image.levels.size();
+	header.bytesOfKeyValueData = (uint32_t)keyValueData.size();
+
+	std::string contents((const char*)&header, sizeof(header));
+	contents.reserve(sizeof(header) + keyValueData.size() + image.data.size() + 4 * image.levels.size());
+	contents += keyValueData;
+	// Block sizes are multiples of 8 bytes, so the levels need no padding.
+	for (const CompressedLevel& level : image.levels) {
+		AppendUint32(contents, (uint32_t)level.size);
+		contents.append((const char*)image.data.data() + level.offset, level.size);
+	}
+	return MeshCache::WriteAtomically(filePath, contents);
+}
+
+bool KtxFile::Read(const std::string& filePath, CompressedImage& image,
+	std::map<std::string, std::string>& keyValues)
+{
+	MappedFile file;
+	if (!file.Open(filePath) || file.GetSize() < sizeof(KtxHeader))
+		return false;
+	const char* data = file.GetData();
+	const size_t fileSize = file.GetSize();
+	const KtxHeader* header = (const KtxHeader*)data;
+	if (memcmp(header->identifier, ktxIdentifier, sizeof(ktxIdentifier)) != 0 || header->endianness != 0x04030201
+		|| header->glType != 0 || header->numberOfFaces != 1 || header->numberOfArrayElements != 0
+		|| header->pixelWidth == 0 || header->pixelHeight == 0 || header->numberOfMipmapLevels == 0
+		|| sizeof(KtxHeader) + (size_t)header->bytesOfKeyValueData > fileSize)
+		return false;
+
+	BlockFormat format;
+	if (header->glInternalFormat == GetInternalFormat(BLOCK_FORMAT_BC1))
+		format = BLOCK_FORMAT_BC1;
+	else if (header->glInternalFormat == GetInternalFormat(BLOCK_FORMAT_BC3))
+		format = BLOCK_FORMAT_BC3;
+	else if (header->glInternalFormat == GetInternalFormat(BLOCK_FORMAT_BC7))
+		format = BLOCK_FORMAT_BC7;
+	else
+		return false;
+	// The textures sample every level, so the file must hold the whole chain down to 1x1.
+	uint32_t numLevels = 1;
+	for (uint32_t size = std::max(header->pixelWidth, header->pixelHeight); size > 1; size /= 2)
+		numLevels++;
+	if (header->numberOfMipmapLevels != numLevels)
+		return false;
+
+	//Key-Value Pairs, Each Key and Value Null Terminated
+	keyValues.clear();
+	size_t position = sizeof(KtxHeader);
+	const size_t keyValueEnd = position + header->bytesOfKeyValueData;
+	while (position + sizeof(uint32_t) <= keyValueEnd) {
+		uint32_t pairSize;
+		memcpy(&pairSize, data + position, sizeof(pairSize));
+		position += sizeof(uint32_t);
+		if (position + pairSize > keyValueEnd)
+			return false;
+		const std::string pair(data + position, pairSize);
+		const size_t keyEnd = pair.find('\0');
+		if (keyEnd != std::string::npos)
+			keyValues[pair.substr(0, keyEnd)] = std::string(pair.c_str() + keyEnd + 1);
+		position += (pairSize + 3) / 4 * 4;
+	}
+
+	//Copy the Levels, Each Checked Against the Size Its Dimensions Imply
+	image.format = format;
+	image.width = (int)header->pixelWidth;
+	image.height = (int)header->pixelHeight;
+	image.levels.clear();
+	image.data.clear();
+	image.data.reserve(fileSize - keyValueEnd);
+	position = keyValueEnd;
+	int levelWidth = image.width;
+	int levelHeight = image.height;
+	for (uint32_t l = 0; l < header->numberOfMipmapLevels; ++l) {
+		uint32_t levelSize;
+		if (position + sizeof(uint32_t) > fileSize)
+			return false;
+		memcpy(&levelSize, data + position, sizeof(levelSize));
+		position += sizeof(uint32_t);
+		if (levelSize != TextureCompressor::GetCompressedSize(format, levelWidth, levelHeight) || position + levelSize > fileSize)
+			return false;
+		CompressedLevel level;
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.offset = image.data.size();
+		level.size = levelSize;
+		image.levels.push_back(level);
+		image.data.insert(image.data.end(), data + position, data + position + levelSize);
+		position += (levelSize + 3) / 4 * 4;
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+	return true;
+}
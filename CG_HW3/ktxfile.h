@@ -0,0 +1,25 @@
+#ifndef KTX_FILE_H
+#define KTX_FILE_H
+
+#include "headers.h"
+#include "texturecompressor.h"
+
+// KtxFile Declarations.
+// Block-compressed mip chains stored as KTX 1.1 files (*.ktx) next to the source image: the GL
+// internal format, every level, and string key-value pairs the writer uses to tell whether the
+// file still matches the image and settings it was encoded from.
+class KtxFile
+{
+public:
+	// KtxFile Public Methods.
+	static bool Write(const std::string& filePath, const CompressedImage& image,
+		const std::map<std::string, std::string>& keyValues);
+	// False if the file is missing, malformed or not in one of the BlockFormats.
+	static bool Read(const std::string& filePath, CompressedImage& image,
+		std::map<std::string, std::string>& keyValues);
+
+	// GL internal format of a BlockFormat (BC1 is stored without alpha).
+	static GLenum GetInternalFormat(const BlockFormat format);
+};
+
+#endif
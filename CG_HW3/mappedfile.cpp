@@ -0,0 +1,113 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+	data = nullptr;
+	size = 0;
+	isOpen = false;
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+#else
+	fileDesc = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+// Map the whole file read-only. An empty file opens successfully with a null data pointer.
+bool MappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	size = (size_t)fileSize.QuadPart;
+
+	if (size > 0) {
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL) {
+			Close();
+			return false;
+		}
+		mappingHandle = mapping;
+		data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == nullptr) {
+			Close();
+			return false;
+		}
+	}
+#else
+	fileDesc = open(filePath.c_str(), O_RDONLY);
+	if (fileDesc < 0)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(fileDesc, &fileStat) != 0) {
+		Close();
+		return false;
+	}
+	size = (size_t)fileStat.st_size;
+
+	if (size > 0) {
+		void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDesc, 0);
+		if (view == MAP_FAILED) {
+			Close();
+			return false;
+		}
+		madvise(view, size, MADV_SEQUENTIAL);
+		data = (const char*)view;
+	}
+#endif
+
+	isOpen = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mappingHandle != nullptr)
+		CloseHandle((HANDLE)mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle((HANDLE)fileHandle);
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+#else
+	if (data != nullptr)
+		munmap((void*)data, size);
+	if (fileDesc >= 0)
+		close(fileDesc);
+	fileDesc = -1;
+#endif
+	data = nullptr;
+	size = 0;
+	isOpen = false;
+}
@@ -0,0 +1,40 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+// MappedFile Declarations.
+// Read-only view of a whole file mapped into the address space.
+class MappedFile
+{
+public:
+	// MappedFile Public Methods.
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const { return isOpen; }
+	const char* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+private:
+	// Non-copyable, the mapping is owned by exactly one object.
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// MappedFile Private Data.
+	const char* data;
+	size_t size;
+	bool isOpen;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileDesc;
+#endif
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "meshcache.h"
+
+#include <filesystem>
+#include <fstream>
+
+bool MeshCache::GetFileStamp(const std::string& filePath, uint64_t& fileSize, int64_t& modifiedTime)
+{
+	std::error_code error;
+	const std::filesystem::path path(filePath);
+	uintmax_t size = std::filesystem::file_size(path, error);
+	if (error)
+		return false;
+	std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+	if (error)
+		return false;
+	fileSize = (uint64_t)size;
+	modifiedTime = (int64_t)time.time_since_epoch().count();
+	return true;
+}
+
+bool MeshCache::WriteAtomically(const std::string& filePath, const std::string& contents)
+{
+	const std::string tempPath = filePath + ".tmp";
+	{
+		std::ofstream output(tempPath, std::ios::binary | std::ios::trunc);
+		if (!output.is_open())
+			return false;
+		output.write(contents.data(), (std::streamsize)contents.size());
+		if (!output.good())
+			return false;
+	}
+	std::error_code error;
+	std::filesystem::rename(tempPath, filePath, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,74 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <string>
+#include <cstdint>
+
+// Binary mesh cache (*.meshbin) written next to the source model.
+// Layout: MeshCacheHeader, MeshCacheDependency[], MeshCacheSubMesh[], VertexPTN[],
+// unsigned int indices[] (LOD indices included), then a string table. All offsets are from the start of the file.
+#define MESH_CACHE_VERSION 3
+// Coarser levels of detail stored per sub-mesh, besides the full-resolution one.
+#define MESH_CACHE_MAX_LODS 3
+
+// MeshCacheHeader Declarations.
+struct MeshCacheHeader
+{
+	char magic[8];				// "MESHBIN\0"
+	uint32_t version;
+	uint32_t vertexSize;		// sizeof(VertexPTN) of the writer.
+	uint32_t normalized;
+	uint32_t numVertices;
+	uint32_t numIndices;
+	uint32_t numTriangles;
+	uint32_t numSubMeshes;
+	uint32_t numDependencies;
+	uint32_t vertexOrderOptimized;
+	uint32_t sourceCacheTransforms;	// Post-transform cache misses of the file's own triangle order.
+	float objCenter[3];
+	float objExtent[3];
+	uint64_t dependencyOffset;
+	uint64_t subMeshOffset;
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	uint64_t stringOffset;
+	uint64_t fileSize;
+};
+
+// MeshCacheDependency Declarations.
+// A source file the cache was built from; the cache is stale once any of them changes.
+struct MeshCacheDependency
+{
+	enum Type { OBJ = 0, MTLLIB = 1, OBJM = 2 };
+	uint32_t type;
+	uint32_t nameOffset;		// Into the string table, relative to the model folder.
+	uint32_t nameLength;
+	uint32_t reserved;
+	uint64_t fileSize;
+	int64_t modifiedTime;
+};
+
+// MeshCacheSubMesh Declarations.
+// The indices of each LOD follow the full-resolution ones, coarsest last.
+struct MeshCacheSubMesh
+{
+	uint32_t firstIndex;
+	uint32_t numIndices;
+	uint32_t materialNameOffset;
+	uint32_t materialNameLength;
+	uint32_t numLods;
+	uint32_t lodNumIndices[MESH_CACHE_MAX_LODS];
+	float lodErrors[MESH_CACHE_MAX_LODS];
+};
+
+// MeshCache Declarations.
+class MeshCache
+{
+public:
+	// Size and last-write time of a file; false if it does not exist.
+	static bool GetFileStamp(const std::string& filePath, uint64_t& fileSize, int64_t& modifiedTime);
+	// Write the whole buffer to filePath through a temporary file, so readers never see a partial cache.
+	static bool WriteAtomically(const std::string& filePath, const std::string& contents);
+};
+
+#endif
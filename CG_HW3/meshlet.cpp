@@ -0,0 +1,112 @@
+#include "meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Fill in the bounding sphere and normal cone of meshlet from its triangles.
+static void ComputeBounds(Meshlet& meshlet, const unsigned int* indices, const unsigned char* positions, const size_t positionStride)
+{
+	auto position = [&](unsigned int v) { return *(const glm::vec3*)(positions + v * positionStride); };
+	const unsigned int numTriangles = meshlet.numIndices / 3;
+
+	//Sphere Around the Box Center; Looser Than Minimal but Stable and Cheap
+	glm::vec3 minPos = position(indices[0]);
+	glm::vec3 maxPos = minPos;
+	for (unsigned int i = 0; i < meshlet.numIndices; ++i) {
+		minPos = glm::min(minPos, position(indices[i]));
+		maxPos = glm::max(maxPos, position(indices[i]));
+	}
+	meshlet.center = 0.5f * (minPos + maxPos);
+	float radius2 = 0.0f;
+	for (unsigned int i = 0; i < meshlet.numIndices; ++i) {
+		glm::vec3 d = position(indices[i]) - meshlet.center;
+		radius2 = std::max(radius2, glm::dot(d, d));
+	}
+	meshlet.radius = std::sqrt(radius2);
+
+	//Cone Axis Is the Mean Face Normal; Degenerate Triangles Do Not Vote
+	std::vector<glm::vec3> normals(numTriangles, glm::vec3(0.0f));
+	glm::vec3 axis = glm::vec3(0.0f);
+	for (unsigned int t = 0; t < numTriangles; ++t) {
+		glm::vec3 p0 = position(indices[t * 3]);
+		glm::vec3 n = glm::cross(position(indices[t * 3 + 1]) - p0, position(indices[t * 3 + 2]) - p0);
+		float length = glm::length(n);
+		if (length > 0.0f) {
+			normals[t] = n / length;
+			axis += normals[t];
+		}
+	}
+	meshlet.coneApex = meshlet.center;
+	meshlet.coneAxis = glm::vec3(0.0f);
+	meshlet.coneCutoff = 1.0f;
+	float axisLength = glm::length(axis);
+	if (axisLength <= 0.0f)
+		return;
+	axis /= axisLength;
+
+	float minDot = 1.0f;
+	for (unsigned int t = 0; t < numTriangles; ++t) {
+		if (normals[t] != glm::vec3(0.0f))
+			minDot = std::min(minDot, glm::dot(axis, normals[t]));
+	}
+	// Normals spread over (nearly) a hemisphere: some triangle always faces the viewer.
+	if (minDot <= 0.1f)
+		return;
+
+	//Pull the Apex Back Until Every Triangle Plane Lies in Front of It
+	float maxT = 0.0f;
+	for (unsigned int t = 0; t < numTriangles; ++t) {
+		if (normals[t] == glm::vec3(0.0f)) continue;
+		float dc = glm::dot(meshlet.center - position(indices[t * 3]), normals[t]);
+		float dn = glm::dot(axis, normals[t]);
+		maxT = std::max(maxT, dc / dn);
+	}
+	meshlet.coneApex = meshlet.center - axis * maxT;
+	meshlet.coneAxis = axis;
+	meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+void MeshletBuilder::Build(const std::vector<unsigned int>& indices, const unsigned char* positions,
+	const size_t positionStride, const size_t numVertices, std::vector<Meshlet>& meshlets)
+{
+	meshlets.clear();
+	// Meshlet that last used each vertex, so counting distinct vertices needs no search.
+	std::vector<unsigned int> usedBy(numVertices, ~0u);
+	const size_t numIndices = indices.size() / 3 * 3;
+
+	Meshlet current;
+	current.firstIndex = 0;
+	current.numIndices = 0;
+	int numMeshletVertices = 0;
+	for (size_t i = 0; i < numIndices; i += 3) {
+		const unsigned int id = (unsigned int)meshlets.size();
+		int newVertices = 0;
+		for (int k = 0; k < 3; ++k) {
+			const unsigned int v = indices[i + k];
+			// A vertex repeated within the triangle only counts once.
+			if (usedBy[v] != id && (k == 0 || v != indices[i]) && (k < 2 || v != indices[i + 1]))
+				newVertices++;
+		}
+		//Close the Meshlet When the Triangle Would Overflow It
+		if (numMeshletVertices + newVertices > kMaxVertices || current.numIndices / 3 + 1 > (unsigned int)kMaxTriangles) {
+			ComputeBounds(current, &indices[current.firstIndex], positions, positionStride);
+			meshlets.push_back(current);
+			current.firstIndex = (unsigned int)i;
+			current.numIndices = 0;
+			numMeshletVertices = 0;
+		}
+		const unsigned int owner = (unsigned int)meshlets.size();
+		for (int k = 0; k < 3; ++k) {
+			const unsigned int v = indices[i + k];
+			if (usedBy[v] != owner) {
+				usedBy[v] = owner;
+				numMeshletVertices++;
+			}
+		}
+		current.numIndices += 3;
+	}
+	if (current.numIndices > 0) {
+		ComputeBounds(current, &indices[current.firstIndex], positions, positionStride);
+		meshlets.push_back(current);
+	}
+}
@@ -0,0 +1,44 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <glm.hpp>
+#include <vector>
+#include <cstddef>
+
+// Meshlet Declarations.
+// A run of consecutive triangles in a SubMesh's index list, small enough to be culled as a unit.
+struct Meshlet
+{
+	unsigned int firstIndex;	// Into the SubMesh's vertexIndices.
+	unsigned int numIndices;
+	// Bounding sphere.
+	glm::vec3 center;
+	float radius;
+	// Normal cone: a viewer inside the cone opening at coneApex sees the back of every triangle.
+	// A cluster whose normals spread too far gets coneCutoff 1 and is never treated as backfacing.
+	glm::vec3 coneApex;
+	glm::vec3 coneAxis;
+	float coneCutoff;
+
+	bool IsBackfacing(const glm::vec3& cameraPos) const {
+		glm::vec3 view = coneApex - cameraPos;
+		float distance = glm::length(view);
+		return distance > 0.0f && glm::dot(view, coneAxis) >= coneCutoff * distance;
+	}
+};
+
+// MeshletBuilder Declarations.
+class MeshletBuilder
+{
+public:
+	static const int kMaxVertices = 64;
+	static const int kMaxTriangles = 124;
+
+	// Cut an index list into meshlets in its current order, so it should already be sorted for
+	// locality (see VertexCacheOptimizer). positions points at the first vertex position, each
+	// positionStride bytes apart.
+	static void Build(const std::vector<unsigned int>& indices, const unsigned char* positions,
+		const size_t positionStride, const size_t numVertices, std::vector<Meshlet>& meshlets);
+};
+
+#endif
@@ -0,0 +1,198 @@
+#include "meshsimplifier.h"
+
+#include <glm.hpp>
+#include <algorithm>
+#include <cmath>
+
+// Symmetric 4x4 plane quadric, plus the total weight so the cost can be read as an RMS distance.
+struct Quadric
+{
+	Quadric() {
+		for (int i = 0; i < 10; ++i)
+			q[i] = 0.0;
+		weight = 0.0;
+	}
+	void AddPlane(const glm::dvec3& n, const double d, const double w) {
+		q[0] += w * n.x * n.x; q[1] += w * n.x * n.y; q[2] += w * n.x * n.z; q[3] += w * n.x * d;
+		q[4] += w * n.y * n.y; q[5] += w * n.y * n.z; q[6] += w * n.y * d;
+		q[7] += w * n.z * n.z; q[8] += w * n.z * d;
+		q[9] += w * d * d;
+		weight += w;
+	}
+	void Add(const Quadric& other) {
+		for (int i = 0; i < 10; ++i)
+			q[i] += other.q[i];
+		weight += other.weight;
+	}
+	// Weighted sum of squared distances from p to the planes.
+	double Evaluate(const glm::dvec3& p) const {
+		return q[0] * p.x * p.x + 2.0 * q[1] * p.x * p.y + 2.0 * q[2] * p.x * p.z + 2.0 * q[3] * p.x
+			+ q[4] * p.y * p.y + 2.0 * q[5] * p.y * p.z + 2.0 * q[6] * p.y
+			+ q[7] * p.z * p.z + 2.0 * q[8] * p.z
+			+ q[9];
+	}
+	double q[10];
+	double weight;
+};
+
+struct Collapse
+{
+	unsigned int from;
+	unsigned int to;
+	float error;
+};
+
+float MeshSimplifier::Simplify(const std::vector<unsigned int>& indices, const unsigned char* positions,
+	const size_t positionStride, const size_t numVertices, const std::vector<unsigned char>& locked,
+	const size_t targetIndexCount, const float maxError, std::vector<unsigned int>& result)
+{
+	auto position = [&](unsigned int v) { return glm::dvec3(*(const glm::vec3*)(positions + v * positionStride)); };
+	result.assign(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+	float worstError = 0.0f;
+
+	//Area-Weighted Quadrics of the Original Faces; They Travel with Every Collapse
+	std::vector<Quadric> quadrics(numVertices);
+	for (size_t i = 0; i < result.size(); i += 3) {
+		glm::dvec3 p0 = position(result[i]);
+		glm::dvec3 n = glm::cross(position(result[i + 1]) - p0, position(result[i + 2]) - p0);
+		double length = glm::length(n);
+		if (length == 0.0) continue;
+		n /= length;
+		const double area = 0.5 * length;
+		for (int k = 0; k < 3; ++k)
+			quadrics[result[i + k]].AddPlane(n, -glm::dot(n, p0), area);
+	}
+
+	std::vector<unsigned int> offsets, adjacency, remap(numVertices);
+	std::vector<unsigned char> pinned(numVertices), dirty(numVertices);
+	std::vector<std::pair<unsigned int, unsigned int>> edges;
+	std::vector<Collapse> collapses;
+	while (result.size() > targetIndexCount) {
+		const size_t numTriangles = result.size() / 3;
+
+		//Triangles Around Each Vertex
+		offsets.assign(numVertices + 1, 0);
+		for (unsigned int v : result)
+			offsets[v + 1]++;
+		for (size_t v = 0; v < numVertices; ++v)
+			offsets[v + 1] += offsets[v];
+		adjacency.resize(result.size());
+		std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t t = 0; t < numTriangles; ++t) {
+			for (int k = 0; k < 3; ++k)
+				adjacency[fill[result[t * 3 + k]]++] = (unsigned int)t;
+		}
+
+		//Open and Non-Manifold Edges Pin Their Vertices, Like the Caller's Locks
+		edges.clear();
+		for (size_t t = 0; t < numTriangles; ++t) {
+			for (int k = 0; k < 3; ++k) {
+				unsigned int a = result[t * 3 + k], b = result[t * 3 + (k + 1) % 3];
+				edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		for (size_t v = 0; v < numVertices; ++v)
+			pinned[v] = (v < locked.size()) ? locked[v] : 0;
+		size_t numUnique = 0;
+		for (size_t i = 0; i < edges.size();) {
+			size_t j = i;
+			while (j < edges.size() && edges[j] == edges[i])
+				j++;
+			if (j - i != 2) {
+				pinned[edges[i].first] = 1;
+				pinned[edges[i].second] = 1;
+			}
+			edges[numUnique++] = edges[i];
+			i = j;
+		}
+		edges.resize(numUnique);
+
+		//Cost of Moving from onto to, or -1 When the Collapse Is Not Allowed
+		auto collapseError = [&](unsigned int from, unsigned int to) -> float {
+			if (pinned[from])
+				return -1.0f;
+			const glm::dvec3 target = position(to);
+			for (unsigned int j = offsets[from]; j < offsets[from + 1]; ++j) {
+				const unsigned int* corners = &result[adjacency[j] * 3];
+				int fromCorner = (corners[0] == from) ? 0 : (corners[1] == from) ? 1 : 2;
+				unsigned int b = corners[(fromCorner + 1) % 3], c = corners[(fromCorner + 2) % 3];
+				if (b == to || c == to) {
+					// This triangle disappears; its other edge to the target must not be a pinned one.
+					unsigned int other = (b == to) ? c : b;
+					if (pinned[to] && pinned[other])
+						return -1.0f;
+					continue;
+				}
+				// The surviving triangles must not flip.
+				glm::dvec3 pb = position(b), pc = position(c);
+				glm::dvec3 before = glm::cross(pb - position(from), pc - position(from));
+				glm::dvec3 after = glm::cross(pb - target, pc - target);
+				if (glm::dot(before, after) <= 0.0)
+					return -1.0f;
+			}
+			Quadric q = quadrics[from];
+			q.Add(quadrics[to]);
+			return (float)std::sqrt(std::max(q.Evaluate(target), 0.0) / std::max(q.weight, 1e-30));
+		};
+
+		collapses.clear();
+		for (const auto& edge : edges) {
+			float forward = collapseError(edge.first, edge.second);
+			float backward = collapseError(edge.second, edge.first);
+			Collapse collapse;
+			if (forward >= 0.0f && (backward < 0.0f || forward <= backward)) {
+				collapse.from = edge.first;
+				collapse.to = edge.second;
+				collapse.error = forward;
+			}
+			else if (backward >= 0.0f) {
+				collapse.from = edge.second;
+				collapse.to = edge.first;
+				collapse.error = backward;
+			}
+			else continue;
+			if (collapse.error <= maxError)
+				collapses.push_back(collapse);
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+		//Cheapest First; a Collapse Freezes the 1-Ring of Its Source for the Rest of the Pass
+		for (size_t v = 0; v < numVertices; ++v) {
+			remap[v] = (unsigned int)v;
+			dirty[v] = 0;
+		}
+		const size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+		size_t removed = 0;
+		for (const Collapse& collapse : collapses) {
+			if (removed >= trianglesToRemove)
+				break;
+			if (dirty[collapse.from] || dirty[collapse.to])
+				continue;
+			for (unsigned int j = offsets[collapse.from]; j < offsets[collapse.from + 1]; ++j) {
+				const unsigned int* corners = &result[adjacency[j] * 3];
+				for (int k = 0; k < 3; ++k)
+					dirty[corners[k]] = 1;
+				if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to)
+					removed++;
+			}
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to].Add(quadrics[collapse.from]);
+			worstError = std::max(worstError, collapse.error);
+		}
+		if (removed == 0)
+			break;
+
+		//Apply the Pass and Drop the Triangles That Collapsed
+		size_t write = 0;
+		for (size_t t = 0; t < numTriangles; ++t) {
+			unsigned int a = remap[result[t * 3]], b = remap[result[t * 3 + 1]], c = remap[result[t * 3 + 2]];
+			if (a == b || b == c || a == c) continue;
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+	return worstError;
+}
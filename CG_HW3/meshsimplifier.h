@@ -0,0 +1,23 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <vector>
+#include <cstddef>
+
+// MeshSimplifier Declarations.
+class MeshSimplifier
+{
+public:
+	// Collapse edges of an indexed triangle list by the quadric error metric until at most
+	// targetIndexCount indices remain or the next collapse would cost more than maxError.
+	// Every collapse moves a vertex onto a neighbour, so no vertices are created and the
+	// result indexes the same vertex buffer. Locked vertices, and vertices on an open or
+	// non-manifold edge of the list, never move, and no collapse removes an edge between two
+	// of them, so borders and seams keep their exact shape.
+	// Returns the largest collapse error made (an RMS distance in position units).
+	static float Simplify(const std::vector<unsigned int>& indices, const unsigned char* positions,
+		const size_t positionStride, const size_t numVertices, const std::vector<unsigned char>& locked,
+		const size_t targetIndexCount, const float maxError, std::vector<unsigned int>& result);
+};
+
+#endif
@@ -0,0 +1,258 @@
+#include "mipbuilder.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define MIPBUILDER_USE_SSE
+#endif
+
+// Kaiser kernel: half width in target texels, and the window's shape parameter.
+static const double kaiserRadius = 2.0;
+static const double kaiserAlpha = 4.0;
+// Target rows per pool task.
+static const int bandRows = 16;
+
+// SrgbTables Declarations.
+// Exact conversions both ways: 8-bit sRGB to linear, and linear back to the nearest 8-bit sRGB
+// code, found through the linear values halfway between codes.
+struct SrgbTables
+{
+	SrgbTables() {
+		for (int i = 0; i < 256; ++i)
+			toLinear[i] = (float)Decode(i / 255.0);
+		for (int i = 0; i < 255; ++i)
+			thresholds[i] = (float)Decode((i + 0.5) / 255.0);
+		// A starting code for each 1/4096 of the linear range; Encode steps from it to the exact one.
+		int code = 0;
+		for (int i = 0; i <= 4096; ++i) {
+			while (code < 255 && i / 4096.0f >= thresholds[code])
+				code++;
+			guess[i] = (unsigned char)code;
+		}
+	}
+	static double Decode(const double value) {
+		return (value <= 0.04045) ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+	}
+	unsigned char Encode(const float linear) const {
+		if (!(linear > 0.0f))
+			return 0;
+		if (linear >= 1.0f)
+			return 255;
+		int code = guess[(int)(linear * 4096.0f)];
+		while (code < 255 && linear >= thresholds[code])
+			code++;
+		while (code > 0 && linear < thresholds[code - 1])
+			code--;
+		return (unsigned char)code;
+	}
+
+	float toLinear[256];
+	float thresholds[255];
+	unsigned char guess[4097];
+};
+
+static const SrgbTables& GetSrgbTables()
+{
+	static const SrgbTables tables;
+	return tables;
+}
+
+// FilterTaps Declarations.
+// For each target texel, numTaps source indices (clamped to the edges) and their normalized weights.
+struct FilterTaps
+{
+	int numTaps;
+	std::vector<int> indices;
+	std::vector<float> weights;
+};
+
+static double Sinc(const double x)
+{
+	const double pi = 3.14159265358979323846;
+	return (x == 0.0) ? 1.0 : std::sin(pi * x) / (pi * x);
+}
+
+// Modified Bessel function of the first kind, order 0, by its power series.
+static double BesselI0(const double x)
+{
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32 && term > sum * 1e-12; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+// Taps of one axis. Target texel i covers source [i * scale, (i + 1) * scale): the box weighs
+// each source texel by its overlap, the Kaiser kernel by the windowed sinc at its center
+// (in target texels, so the cutoff is the target's Nyquist rate).
+static void BuildTaps(const int sourceSize, const int targetSize, const MipFilter filter, FilterTaps& taps)
+{
+	const double scale = (double)sourceSize / targetSize;
+	const double radius = (filter == MIP_FILTER_BOX) ? 0.5 * scale : kaiserRadius * scale;
+	const int maxTaps = (int)std::ceil(2.0 * radius) + 1;
+	std::vector<int> indices((size_t)targetSize * maxTaps);
+	std::vector<double> weights((size_t)targetSize * maxTaps);
+	int numTaps = 1;
+	for (int i = 0; i < targetSize; ++i) {
+		const double center = (i + 0.5) * scale;
+		const int first = (int)std::floor(center - radius);
+		double sum = 0.0;
+		for (int t = 0; t < maxTaps; ++t) {
+			const int j = first + t;
+			double weight;
+			if (filter == MIP_FILTER_BOX)
+				weight = std::max(std::min(j + 1.0, center + radius) - std::max((double)j, center - radius), 0.0);
+			else {
+				const double x = (j + 0.5 - center) / scale;
+				const double r = x / kaiserRadius;
+				weight = (std::abs(r) < 1.0) ? Sinc(x) * BesselI0(kaiserAlpha * std::sqrt(1.0 - r * r)) / BesselI0(kaiserAlpha) : 0.0;
+			}
+			indices[(size_t)i * maxTaps + t] = std::min(std::max(j, 0), sourceSize - 1);
+			weights[(size_t)i * maxTaps + t] = weight;
+			sum += weight;
+			if (weight != 0.0)
+				numTaps = std::max(numTaps, t + 1);
+		}
+		for (int t = 0; t < maxTaps; ++t)
+			weights[(size_t)i * maxTaps + t] /= sum;
+	}
+
+	//Drop the Trailing Taps No Texel Uses
+	taps.numTaps = numTaps;
+	taps.indices.resize((size_t)targetSize * numTaps);
+	taps.weights.resize((size_t)targetSize * numTaps);
+	for (int i = 0; i < targetSize; ++i) {
+		for (int t = 0; t < numTaps; ++t) {
+			taps.indices[(size_t)i * numTaps + t] = indices[(size_t)i * maxTaps + t];
+			taps.weights[(size_t)i * numTaps + t] = (float)weights[(size_t)i * maxTaps + t];
+		}
+	}
+}
+
+static int GetAlphaChannel(const int numChannels)
+{
+	return (numChannels == 2 || numChannels == 4) ? numChannels - 1 : -1;
+}
+
+void MipBuilder::Build(const unsigned char* pixels, const int width, const int height, const size_t stride,
+	const int numChannels, const MipFilter filter, std::vector<MipLevel>& levels, const int numThreads)
+{
+	//Size Every Level First; Each Is Built from the One Above
+	int numLevels = 0;
+	for (int w = width, h = height; w > 1 || h > 1; w = std::max(w / 2, 1), h = std::max(h / 2, 1))
+		numLevels++;
+	levels.resize(numLevels);
+	const unsigned char* source = pixels;
+	size_t sourceStride = stride;
+	int sourceWidth = width;
+	int sourceHeight = height;
+	for (MipLevel& level : levels) {
+		level.width = std::max(sourceWidth / 2, 1);
+		level.height = std::max(sourceHeight / 2, 1);
+		BuildLevel(source, sourceWidth, sourceHeight, sourceStride, numChannels, filter, level, numThreads);
+		source = level.pixels.data();
+		sourceStride = (size_t)level.width * numChannels;
+		sourceWidth = level.width;
+		sourceHeight = level.height;
+	}
+}
+
+void MipBuilder::BuildLevel(const unsigned char* source, const int sourceWidth, const int sourceHeight,
+	const size_t sourceStride, const int numChannels, const MipFilter filter, MipLevel& level, const int numThreads)
+{
+	const SrgbTables& srgb = GetSrgbTables();
+	const int alphaChannel = GetAlphaChannel(numChannels);
+	FilterTaps columns, rows;
+	BuildTaps(sourceWidth, level.width, filter, columns);
+	BuildTaps(sourceHeight, level.height, filter, rows);
+	level.pixels.resize((size_t)level.width * level.height * numChannels);
+
+	// A band filters the source rows it needs across, then down into its target rows. Texels are
+	// four floats wide whatever the channel count, one SSE register each.
+	auto filterBand = [&](int band) {
+		const int firstRow = band * bandRows;
+		const int lastRow = std::min(firstRow + bandRows, level.height);
+		int sourceFirst = INT_MAX, sourceLast = -1;
+		for (size_t k = (size_t)firstRow * rows.numTaps; k < (size_t)lastRow * rows.numTaps; ++k) {
+			sourceFirst = std::min(sourceFirst, rows.indices[k]);
+			sourceLast = std::max(sourceLast, rows.indices[k]);
+		}
+		const size_t rowFloats = (size_t)level.width * 4;
+		std::vector<float> linearRow((size_t)sourceWidth * 4, 0.0f);
+		std::vector<float> filtered((size_t)(sourceLast - sourceFirst + 1) * rowFloats);
+		std::vector<float> targetRow(rowFloats);
+
+		//Across: Decode Each Source Row to Linear, Then Filter It to the Target Width
+		for (int y = sourceFirst; y <= sourceLast; ++y) {
+			const unsigned char* in = source + (size_t)y * sourceStride;
+			for (int x = 0; x < sourceWidth; ++x) {
+				for (int c = 0; c < numChannels; ++c) {
+					const unsigned char value = in[x * numChannels + c];
+					linearRow[(size_t)x * 4 + c] = (c == alphaChannel) ? value / 255.0f : srgb.toLinear[value];
+				}
+			}
+			float* out = filtered.data() + (size_t)(y - sourceFirst) * rowFloats;
+			for (int x = 0; x < level.width; ++x) {
+				const int* indices = &columns.indices[(size_t)x * columns.numTaps];
+				const float* weights = &columns.weights[(size_t)x * columns.numTaps];
+#ifdef MIPBUILDER_USE_SSE
+				__m128 sum = _mm_setzero_ps();
+				for (int t = 0; t < columns.numTaps; ++t)
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(&linearRow[(size_t)indices[t] * 4])));
+				_mm_storeu_ps(out + (size_t)x * 4, sum);
+#else
+				for (int c = 0; c < 4; ++c) {
+					float sum = 0.0f;
+					for (int t = 0; t < columns.numTaps; ++t)
+						sum += weights[t] * linearRow[(size_t)indices[t] * 4 + c];
+					out[(size_t)x * 4 + c] = sum;
+				}
+#endif
+			}
+		}
+
+		//Down: Weigh the Filtered Rows into Each Target Row, Then Encode It
+		for (int y = firstRow; y < lastRow; ++y) {
+			const int* indices = &rows.indices[(size_t)y * rows.numTaps];
+			const float* weights = &rows.weights[(size_t)y * rows.numTaps];
+			std::fill(targetRow.begin(), targetRow.end(), 0.0f);
+			for (int t = 0; t < rows.numTaps; ++t) {
+				const float* in = filtered.data() + (size_t)(indices[t] - sourceFirst) * rowFloats;
+				size_t i = 0;
+#ifdef MIPBUILDER_USE_SSE
+				const __m128 weight = _mm_set1_ps(weights[t]);
+				for (; i < rowFloats; i += 4)
+					_mm_storeu_ps(&targetRow[i], _mm_add_ps(_mm_loadu_ps(&targetRow[i]), _mm_mul_ps(weight, _mm_loadu_ps(in + i))));
+#endif
+				for (; i < rowFloats; ++i)
+					targetRow[i] += weights[t] * in[i];
+			}
+			unsigned char* out = level.pixels.data() + (size_t)y * level.width * numChannels;
+			for (int x = 0; x < level.width; ++x) {
+				for (int c = 0; c < numChannels; ++c) {
+					const float value = targetRow[(size_t)x * 4 + c];
+					out[x * numChannels + c] = (c == alphaChannel)
+						? (unsigned char)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f) : srgb.Encode(value);
+				}
+			}
+		}
+	};
+
+	const int numBands = (level.height + bandRows - 1) / bandRows;
+	if (numThreads != 1 && numBands > 1)
+		ThreadPool::Shared().ParallelFor(numBands, filterBand);
+	else {
+		for (int band = 0; band < numBands; ++band)
+			filterBand(band);
+	}
+}
+
+const char* MipBuilder::GetFilterName(const MipFilter filter)
+{
+	return (filter == MIP_FILTER_KAISER) ? "kaiser" : "box";
+}
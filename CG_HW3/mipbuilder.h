@@ -0,0 +1,47 @@
+#ifndef MIP_BUILDER_H
+#define MIP_BUILDER_H
+
+#include <vector>
+#include <cstddef>
+
+// Downsampling kernels; both adapt to odd sizes, where a level is not an exact half.
+enum MipFilter
+{
+	MIP_FILTER_BOX,				// Area average of the source texels each target texel covers.
+	MIP_FILTER_KAISER			// Kaiser-windowed sinc, sharper with less aliasing; slower.
+};
+
+// MipLevel Declarations.
+struct MipLevel
+{
+	int width;
+	int height;
+	std::vector<unsigned char> pixels;	// Tightly packed rows, as many channels as the source.
+};
+
+// MipBuilder Declarations.
+// CPU mip chain for 8-bit images. Color channels are sRGB and filtered in linear space (alpha
+// stays linear), so bright and dark texels average to the right brightness rather than the
+// darker result of filtering the encoded values. Each level is built separably from the one
+// above, four channels at a time with SSE, with bands of rows on the shared pool. The output
+// does not depend on the thread count. No GL calls, so it is safe on any thread.
+class MipBuilder
+{
+public:
+	// MipBuilder Public Methods.
+	// Build levels 1..n, down to 1x1, of a width x height image with numChannels (1 to 4)
+	// interleaved channels whose rows are stride bytes apart; the last channel of a 2- or
+	// 4-channel image is alpha. levels[i] receives level i + 1. Texels past the edges repeat the
+	// edge. numThreads: 1 builds serially, anything else uses the shared pool.
+	static void Build(const unsigned char* pixels, const int width, const int height, const size_t stride,
+		const int numChannels, const MipFilter filter, std::vector<MipLevel>& levels, const int numThreads = 1);
+
+	static const char* GetFilterName(const MipFilter filter);
+
+private:
+	// MipBuilder Private Methods.
+	static void BuildLevel(const unsigned char* source, const int sourceWidth, const int sourceHeight,
+		const size_t sourceStride, const int numChannels, const MipFilter filter, MipLevel& level, const int numThreads);
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "objparser.h"
+#include "textscanner.h"
+
+void ObjParser::SplitIntoChunks(const char* data, const size_t size, const int maxChunks,
+	std::vector<std::pair<const char*, const char*>>& ranges)
+{
+	ranges.clear();
+	const char* end = data + size;
+	const size_t numChunks = (size_t)std::max(maxChunks, 1);
+	const char* begin = data;
+	for (size_t i = 1; i <= numChunks && begin < end; ++i) {
+		const char* cut = (i == numChunks) ? end : data + size * i / numChunks;
+		if (cut < begin) cut = begin;
+		// Extend the slice to the end of the line it cuts through.
+		if (cut < end) {
+			const char* eol = (const char*)memchr(cut, '\n', (size_t)(end - cut));
+			cut = (eol != nullptr) ? eol + 1 : end;
+		}
+		if (cut > begin)
+			ranges.push_back(std::make_pair(begin, cut));
+		begin = cut;
+	}
+}
+
+// Parse one index of a corner. Missing components leave the flag clear.
+static bool ParseCornerIndex(TextScanner& corner, const int count, int& index, bool& relative)
+{
+	int objIndex = 0;
+	if (!corner.ParseInt(objIndex) || objIndex == 0)
+		return false;
+	relative = (objIndex < 0);
+	index = relative ? count + objIndex : objIndex - 1;
+	return true;
+}
+
+void ObjParser::ParseChunk(const char* begin, const char* end, ObjChunk& chunk)
+{
+	TextScanner scanner(begin, end);
+	const char* head;
+	size_t headLength;
+	for (; !scanner.AtEnd(); scanner.NextLine()) {
+		if (!scanner.NextToken(head, headLength)) continue;
+
+		if (TextScanner::TokenIs(head, headLength, "v")) {
+			glm::vec3 position(0.0f, 0.0f, 0.0f);
+			scanner.ParseFloat(position.x);
+			scanner.ParseFloat(position.y);
+			scanner.ParseFloat(position.z);
+			chunk.positions.push_back(position);
+			chunk.minPosition = glm::min(chunk.minPosition, position);
+			chunk.maxPosition = glm::max(chunk.maxPosition, position);
+		}
+		else if (TextScanner::TokenIs(head, headLength, "vt")) {
+			glm::vec2 texcoord(0.0f, 0.0f);
+			scanner.ParseFloat(texcoord.x);
+			scanner.ParseFloat(texcoord.y);
+			chunk.texcoords.push_back(texcoord);
+		}
+		else if (TextScanner::TokenIs(head, headLength, "vn")) {
+			glm::vec3 normal(0.0f, 0.0f, 0.0f);
+			scanner.ParseFloat(normal.x);
+			scanner.ParseFloat(normal.y);
+			scanner.ParseFloat(normal.z);
+			chunk.normals.push_back(normal);
+		}
+		else if (TextScanner::TokenIs(head, headLength, "f")) {
+			// "p", "p/t", "p//n" or "p/t/n"; negative indices count back from the current attribute.
+			unsigned int numCorners = 0;
+			const char* token;
+			size_t length;
+			while (scanner.NextToken(token, length)) {
+				TextScanner cornerScanner(token, token + length);
+				ObjCorner corner;
+				corner.flags = 0;
+				corner.tIndex = 0;
+				corner.nIndex = 0;
+				bool relative = false;
+				if (!ParseCornerIndex(cornerScanner, (int)chunk.positions.size(), corner.pIndex, relative))
+					continue;
+				if (relative) corner.flags |= ObjCorner::P_RELATIVE;
+				if (!cornerScanner.AtEnd() && *cornerScanner.cur == '/') {
+					++cornerScanner.cur;
+					if (ParseCornerIndex(cornerScanner, (int)chunk.texcoords.size(), corner.tIndex, relative))
+						corner.flags |= ObjCorner::HAS_T | (relative ? ObjCorner::T_RELATIVE : 0);
+					if (!cornerScanner.AtEnd() && *cornerScanner.cur == '/') {
+						++cornerScanner.cur;
+						if (ParseCornerIndex(cornerScanner, (int)chunk.normals.size(), corner.nIndex, relative))
+							corner.flags |= ObjCorner::HAS_N | (relative ? ObjCorner::N_RELATIVE : 0);
+					}
+				}
+				chunk.corners.push_back(corner);
+				numCorners++;
+			}
+			chunk.faceSizes.push_back(numCorners);
+		}
+		else if (TextScanner::TokenIs(head, headLength, "mtllib") || TextScanner::TokenIs(head, headLength, "usemtl")) {
+			ObjStatement statement;
+			statement.type = (head[0] == 'm') ? ObjStatement::MTLLIB : ObjStatement::USEMTL;
+			statement.faceIndex = chunk.faceSizes.size();
+			scanner.NextToken(statement.name, statement.nameLength);
+			chunk.statements.push_back(statement);
+		}
+	}
+}
+
+void ObjParser::ParseObjmChunk(const char* begin, const char* end, ObjChunk& chunk)
+{
+	// Records are about 60-70 bytes; reserving up front keeps the arrays from regrowing.
+	const size_t expectedRecords = (size_t)(end - begin) / 60 + 1;
+	chunk.positions.reserve(expectedRecords);
+	chunk.texcoords.reserve(expectedRecords);
+	chunk.normals.reserve(expectedRecords);
+
+	TextScanner scanner(begin, end);
+	const char* head;
+	size_t headLength;
+	for (; !scanner.AtEnd(); scanner.NextLine()) {
+		if (!scanner.NextToken(head, headLength)) continue;
+
+		if (TextScanner::TokenIs(head, headLength, "vtx")) {
+			glm::vec3 position(0.0f, 0.0f, 0.0f);
+			glm::vec2 texcoord(0.0f, 0.0f);
+			glm::vec3 normal(0.0f, 0.0f, 0.0f);
+			scanner.ParseFloat(position.x);
+			scanner.ParseFloat(position.y);
+			scanner.ParseFloat(position.z);
+			scanner.ParseFloat(texcoord.x);
+			scanner.ParseFloat(texcoord.y);
+			scanner.ParseFloat(normal.x);
+			scanner.ParseFloat(normal.y);
+			scanner.ParseFloat(normal.z);
+			chunk.positions.push_back(position);
+			chunk.texcoords.push_back(texcoord);
+			chunk.normals.push_back(normal);
+			chunk.minPosition = glm::min(chunk.minPosition, position);
+			chunk.maxPosition = glm::max(chunk.maxPosition, position);
+		}
+		else if (TextScanner::TokenIs(head, headLength, "mtllib") || TextScanner::TokenIs(head, headLength, "usemtl")) {
+			ObjStatement statement;
+			statement.type = (head[0] == 'm') ? ObjStatement::MTLLIB : ObjStatement::USEMTL;
+			statement.faceIndex = chunk.positions.size();
+			scanner.NextToken(statement.name, statement.nameLength);
+			chunk.statements.push_back(statement);
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef OBJ_PARSER_H
+#define OBJ_PARSER_H
+
+#include "headers.h"
+
+// ObjCorner Declarations.
+// One "p/t/n" face corner. Absolute indices are already 0-based and global; relative
+// (negative) ones are stored against the chunk's own attribute count and fixed up at merge time.
+struct ObjCorner
+{
+	enum {
+		P_RELATIVE = 1, T_RELATIVE = 2, N_RELATIVE = 4,
+		HAS_T = 8, HAS_N = 16
+	};
+	int pIndex;
+	int tIndex;
+	int nIndex;
+	unsigned int flags;
+};
+
+// ObjStatement Declarations.
+// Non-geometry records that must be replayed in file order (mtllib / usemtl).
+struct ObjStatement
+{
+	enum Type { MTLLIB, USEMTL };
+	Type type;
+	// Number of faces of the chunk that come before this statement (vtx records for .objm).
+	size_t faceIndex;
+	const char* name;
+	size_t nameLength;
+};
+
+// ObjChunk Declarations.
+// Everything parsed from one line-aligned slice of an OBJ file.
+struct ObjChunk
+{
+	ObjChunk() {
+		minPosition = glm::vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+		maxPosition = glm::vec3(FLT_MIN, FLT_MIN, FLT_MIN);
+	}
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> texcoords;
+	std::vector<glm::vec3> normals;
+	std::vector<ObjCorner> corners;
+	// Corner count of each face, in file order.
+	std::vector<unsigned int> faceSizes;
+	std::vector<ObjStatement> statements;
+	glm::vec3 minPosition;
+	glm::vec3 maxPosition;
+};
+
+// ObjParser Declarations.
+class ObjParser
+{
+public:
+	// Cut [data, data + size) into at most maxChunks slices that start and end on line boundaries.
+	static void SplitIntoChunks(const char* data, const size_t size, const int maxChunks,
+		std::vector<std::pair<const char*, const char*>>& ranges);
+	// Tokenize one slice; touches nothing but the chunk, so slices can be parsed concurrently.
+	static void ParseChunk(const char* begin, const char* end, ObjChunk& chunk);
+	// Same for the pre-expanded .objm format: every "vtx px py pz u v nx ny nz" record appends
+	// one entry to positions, texcoords and normals, and each run of three records is a triangle.
+	static void ParseObjmChunk(const char* begin, const char* end, ObjChunk& chunk);
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "occlusionculler.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+OcclusionCuller::OcclusionCuller(const int width, const int height)
+{
+	this->width = std::max(width, 1);
+	this->height = std::max(height, 1);
+	tilesX = (this->width + kTileSize - 1) / kTileSize;
+	tilesY = (this->height + kTileSize - 1) / kTileSize;
+	viewProjMatrix = glm::mat4x4(1.0f);
+	tileBins.resize((size_t)tilesX * tilesY);
+
+	int levelWidth = this->width, levelHeight = this->height;
+	while (true) {
+		levels.push_back(std::vector<float>((size_t)levelWidth * levelHeight, 1.0f));
+		levelWidths.push_back(levelWidth);
+		levelHeights.push_back(levelHeight);
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+	}
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4x4& viewProjMatrix)
+{
+	this->viewProjMatrix = viewProjMatrix;
+	triangles.clear();
+	for (std::vector<int>& bin : tileBins)
+		bin.clear();
+	stats = OcclusionStats();
+}
+
+void OcclusionCuller::AddOccluder(const unsigned char* positions, const size_t stride, const unsigned int* indices,
+	const size_t numIndices, const glm::mat4x4& worldMatrix)
+{
+	const glm::mat4x4 clipMatrix = viewProjMatrix * worldMatrix;
+	for (size_t i = 0; i + 2 < numIndices; i += 3) {
+		glm::vec4 clip[3];
+		for (int k = 0; k < 3; ++k) {
+			const glm::vec3& position = *(const glm::vec3*)(positions + (size_t)indices[i + k] * stride);
+			clip[k] = clipMatrix * glm::vec4(position, 1.0f);
+		}
+		//Clip Against the Near Plane (z = -w); the Rasterizer Scissors the Other Sides
+		int numInside = 0;
+		for (int k = 0; k < 3; ++k)
+			numInside += (clip[k].z + clip[k].w > 0.0f) ? 1 : 0;
+		if (numInside == 3)
+			AddClippedTriangle(clip[0], clip[1], clip[2]);
+		else if (numInside > 0) {
+			glm::vec4 polygon[4];
+			int numPolygon = 0;
+			for (int k = 0; k < 3; ++k) {
+				const glm::vec4& p = clip[k];
+				const glm::vec4& q = clip[(k + 1) % 3];
+				const float dp = p.z + p.w, dq = q.z + q.w;
+				if (dp > 0.0f)
+					polygon[numPolygon++] = p;
+				if ((dp > 0.0f) != (dq > 0.0f))
+					polygon[numPolygon++] = p + (q - p) * (dp / (dp - dq));
+			}
+			for (int k = 1; k + 1 < numPolygon; ++k)
+				AddClippedTriangle(polygon[0], polygon[k], polygon[k + 1]);
+		}
+	}
+}
+
+void OcclusionCuller::AddClippedTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+	ScreenTriangle triangle;
+	const glm::vec4* clip[3] = { &a, &b, &c };
+	for (int k = 0; k < 3; ++k) {
+		const float invW = 1.0f / std::max(clip[k]->w, 1e-6f);
+		triangle.v[k] = glm::vec3(
+			(clip[k]->x * invW * 0.5f + 0.5f) * (float)width,
+			(clip[k]->y * invW * 0.5f + 0.5f) * (float)height,
+			clip[k]->z * invW * 0.5f + 0.5f);
+	}
+	//Drop Triangles That Miss the Buffer
+	const glm::vec3 minV = glm::min(triangle.v[0], glm::min(triangle.v[1], triangle.v[2]));
+	const glm::vec3 maxV = glm::max(triangle.v[0], glm::max(triangle.v[1], triangle.v[2]));
+	if (maxV.x < 0.0f || maxV.y < 0.0f || minV.x > (float)width || minV.y > (float)height || minV.z > 1.0f)
+		return;
+	const int tileX0 = std::max(0, (int)minV.x / kTileSize), tileX1 = std::min(tilesX - 1, (int)maxV.x / kTileSize);
+	const int tileY0 = std::max(0, (int)minV.y / kTileSize), tileY1 = std::min(tilesY - 1, (int)maxV.y / kTileSize);
+	for (int tileY = tileY0; tileY <= tileY1; ++tileY) {
+		for (int tileX = tileX0; tileX <= tileX1; ++tileX)
+			tileBins[(size_t)tileY * tilesX + tileX].push_back((int)triangles.size());
+	}
+	triangles.push_back(triangle);
+}
+
+void OcclusionCuller::Rasterize()
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+	std::fill(levels[0].begin(), levels[0].end(), 1.0f);
+	const int numTiles = tilesX * tilesY;
+	if (!triangles.empty()) {
+		if (numTiles > 1 && triangles.size() > 64)
+			ThreadPool::Shared().ParallelFor(numTiles, [this](int tile) { RasterizeTile(tile); });
+		else {
+			for (int tile = 0; tile < numTiles; ++tile)
+				RasterizeTile(tile);
+		}
+	}
+	BuildPyramid();
+	stats.numOccluderTriangles = (int)triangles.size();
+	stats.rasterSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+// Pixel centers inside the triangle (either winding) take the nearer of their depth and the occluder's.
+void OcclusionCuller::RasterizeTile(const int tile)
+{
+	const int tileX0 = (tile % tilesX) * kTileSize;
+	const int tileY0 = (tile / tilesX) * kTileSize;
+	const int tileX1 = std::min(tileX0 + kTileSize, width) - 1;
+	const int tileY1 = std::min(tileY0 + kTileSize, height) - 1;
+	float* depth = levels[0].data();
+
+	for (int index : tileBins[tile]) {
+		const ScreenTriangle& triangle = triangles[index];
+		glm::vec3 a = triangle.v[0], b = triangle.v[1], c = triangle.v[2];
+		const glm::vec3 minV = glm::min(a, glm::min(b, c));
+		const glm::vec3 maxV = glm::max(a, glm::max(b, c));
+		const int x0 = std::max(tileX0, (int)std::ceil(minV.x - 0.5f));
+		const int x1 = std::min(tileX1, (int)std::floor(maxV.x - 0.5f));
+		const int y0 = std::max(tileY0, (int)std::ceil(minV.y - 0.5f));
+		const int y1 = std::min(tileY1, (int)std::floor(maxV.y - 0.5f));
+		if (x0 > x1 || y0 > y1)
+			continue;
+		float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+		if (area == 0.0f)
+			continue;
+		if (area < 0.0f) {
+			std::swap(b, c);
+			area = -area;
+		}
+		//Edge Functions and the Depth Plane, Stepped One Pixel at a Time
+		const float stepX0 = b.y - c.y, stepY0 = c.x - b.x;
+		const float stepX1 = c.y - a.y, stepY1 = a.x - c.x;
+		const float stepX2 = a.y - b.y, stepY2 = b.x - a.x;
+		const float invArea = 1.0f / area;
+		const float depthStepX = ((b.z - a.z) * stepX1 + (c.z - a.z) * stepX2) * invArea;
+		const float depthStepY = ((b.z - a.z) * stepY1 + (c.z - a.z) * stepY2) * invArea;
+		const float px = (float)x0 + 0.5f, py = (float)y0 + 0.5f;
+		float rowE0 = (px - b.x) * stepX0 + (py - b.y) * stepY0;
+		float rowE1 = (px - c.x) * stepX1 + (py - c.y) * stepY1;
+		float rowE2 = (px - a.x) * stepX2 + (py - a.y) * stepY2;
+		float rowDepth = a.z + (b.z - a.z) * rowE1 * invArea + (c.z - a.z) * rowE2 * invArea;
+		for (int y = y0; y <= y1; ++y) {
+			float e0 = rowE0, e1 = rowE1, e2 = rowE2, z = rowDepth;
+			float* row = depth + (size_t)y * width;
+			for (int x = x0; x <= x1; ++x) {
+				if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f)
+					row[x] = std::min(row[x], std::max(z, 0.0f));
+				e0 += stepX0; e1 += stepX1; e2 += stepX2; z += depthStepX;
+			}
+			rowE0 += stepY0; rowE1 += stepY1; rowE2 += stepY2; rowDepth += depthStepY;
+		}
+	}
+}
+
+void OcclusionCuller::BuildPyramid()
+{
+	for (size_t level = 1; level < levels.size(); ++level) {
+		const std::vector<float>& source = levels[level - 1];
+		const int sourceWidth = levelWidths[level - 1], sourceHeight = levelHeights[level - 1];
+		std::vector<float>& target = levels[level];
+		for (int y = 0; y < levelHeights[level]; ++y) {
+			const int sy0 = 2 * y, sy1 = std::min(2 * y + 1, sourceHeight - 1);
+			for (int x = 0; x < levelWidths[level]; ++x) {
+				const int sx0 = 2 * x, sx1 = std::min(2 * x + 1, sourceWidth - 1);
+				target[(size_t)y * levelWidths[level] + x] = std::max(
+					std::max(source[(size_t)sy0 * sourceWidth + sx0], source[(size_t)sy0 * sourceWidth + sx1]),
+					std::max(source[(size_t)sy1 * sourceWidth + sx0], source[(size_t)sy1 * sourceWidth + sx1]));
+			}
+		}
+	}
+}
+
+// A box is hidden when its nearest corner is behind the farthest occluder depth over its screen rectangle.
+// Boxes reaching behind the eye, or off the buffer, are kept (frustum culling handles the latter).
+bool OcclusionCuller::IsBoxVisible(const glm::vec3& center, const glm::vec3& extent) const
+{
+	//Corners in Clip Space as the Center Plus or Minus Each Transformed Half Axis
+	const glm::vec4 clipCenter = viewProjMatrix * glm::vec4(center, 1.0f);
+	const glm::vec4 axisX = viewProjMatrix[0] * extent.x;
+	const glm::vec4 axisY = viewProjMatrix[1] * extent.y;
+	const glm::vec4 axisZ = viewProjMatrix[2] * extent.z;
+	glm::vec3 minV = glm::vec3(INFINITY), maxV = glm::vec3(-INFINITY);
+	for (int corner = 0; corner < 8; ++corner) {
+		const glm::vec4 clip = clipCenter + ((corner & 1) ? axisX : -axisX)
+			+ ((corner & 2) ? axisY : -axisY) + ((corner & 4) ? axisZ : -axisZ);
+		if (clip.w <= 1e-6f)
+			return true;
+		const float invW = 1.0f / clip.w;
+		const glm::vec3 window = glm::vec3(
+			(clip.x * invW * 0.5f + 0.5f) * (float)width,
+			(clip.y * invW * 0.5f + 0.5f) * (float)height,
+			clip.z * invW * 0.5f + 0.5f);
+		minV = glm::min(minV, window);
+		maxV = glm::max(maxV, window);
+	}
+	if (minV.z <= 0.0f)
+		return true;
+	int x0 = std::max(0, (int)std::floor(minV.x)), x1 = std::min(width - 1, (int)std::floor(maxV.x));
+	int y0 = std::max(0, (int)std::floor(minV.y)), y1 = std::min(height - 1, (int)std::floor(maxV.y));
+	if (x0 > x1 || y0 > y1)
+		return true;
+
+	//Coarsest Level Where the Rectangle Still Spans Only a Few Texels
+	size_t level = 0;
+	while (level + 1 < levels.size() && (x1 - x0 >= 4 || y1 - y0 >= 4)) {
+		x0 >>= 1; x1 >>= 1; y0 >>= 1; y1 >>= 1;
+		++level;
+	}
+	const std::vector<float>& depth = levels[level];
+	const int levelWidth = levelWidths[level];
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = x0; x <= x1; ++x) {
+			if (depth[(size_t)y * levelWidth + x] >= minV.z)
+				return true;
+		}
+	}
+	return false;
+}
+
+int OcclusionCuller::CullBoxes(const BoxBatch& boxes, unsigned char* visible)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+	const int count = (int)boxes.GetSize();
+	const int numTasks = (count + kBoxesPerTask - 1) / kBoxesPerTask;
+	taskCulled.assign(numTasks, 0);
+	for (int i = 0; i < count; ++i)
+		stats.numTested += visible[i] ? 1 : 0;
+	// Two captures keep the task body in std::function's local storage (no allocation per frame).
+	struct CullTask {
+		const BoxBatch* boxes;
+		unsigned char* visible;
+		int count;
+	} cull = { &boxes, visible, count };
+	auto testRange = [this, &cull](int task) {
+		const int end = std::min(cull.count, (task + 1) * kBoxesPerTask);
+		for (int i = task * kBoxesPerTask; i < end; ++i) {
+			if (!cull.visible[i])
+				continue;
+			const BoxBatch& batch = *cull.boxes;
+			const glm::vec3 center = glm::vec3(batch.centerX[i], batch.centerY[i], batch.centerZ[i]);
+			const glm::vec3 extent = glm::vec3(batch.extentX[i], batch.extentY[i], batch.extentZ[i]);
+			if (!IsBoxVisible(center, extent)) {
+				cull.visible[i] = 0;
+				taskCulled[task]++;
+			}
+		}
+	};
+	if (numTasks > 1)
+		ThreadPool::Shared().ParallelFor(numTasks, testRange);
+	else if (numTasks == 1)
+		testRange(0);
+
+	int numCulled = 0;
+	for (int culled : taskCulled)
+		numCulled += culled;
+	stats.numCulled += numCulled;
+	stats.testSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+	return numCulled;
+}
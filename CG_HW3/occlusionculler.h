@@ -0,0 +1,87 @@
+#ifndef OCCLUSIONCULLER_H
+#define OCCLUSIONCULLER_H
+
+#include <glm.hpp>
+#include <vector>
+#include <cstddef>
+#include "frustum.h"
+
+// OcclusionStats Declarations.
+// Work of the frame since the last BeginFrame.
+struct OcclusionStats
+{
+	OcclusionStats() {
+		numOccluderTriangles = 0;
+		numTested = 0;
+		numCulled = 0;
+		rasterSeconds = 0.0;
+		testSeconds = 0.0;
+	}
+	int numOccluderTriangles;	// After near-plane clipping and off-screen rejection.
+	int numTested;				// Boxes tested against the depth pyramid.
+	int numCulled;				// Of those, hidden behind the occluders (draws skipped).
+	double rasterSeconds;		// Rasterizing the occluders and building the pyramid.
+	double testSeconds;
+};
+
+// OcclusionCuller Declarations.
+// Low-resolution CPU depth buffer: a few large occluders are rasterized tile by tile on the
+// shared thread pool and reduced into a pyramid of farthest depths, then world-space boxes
+// are tested against the pyramid level where they cover at most 4 x 4 texels.
+class OcclusionCuller
+{
+public:
+	// OcclusionCuller Public Methods.
+	OcclusionCuller(const int width = 256, const int height = 128);
+
+	// Start a frame seen through viewProjMatrix; occluders and boxes are given in world space.
+	void BeginFrame(const glm::mat4x4& viewProjMatrix);
+	// Triangles indices[0 .. numIndices) of the positions (stride bytes apart), placed by worldMatrix.
+	void AddOccluder(const unsigned char* positions, const size_t stride, const unsigned int* indices,
+		const size_t numIndices, const glm::mat4x4& worldMatrix);
+	// Rasterize the occluders added since BeginFrame and build the depth pyramid.
+	void Rasterize();
+
+	// Clear visible[i] for the boxes completely behind the occluders; boxes already at 0 are skipped.
+	// Returns the number of boxes culled.
+	int CullBoxes(const BoxBatch& boxes, unsigned char* visible);
+	bool IsBoxVisible(const glm::vec3& center, const glm::vec3& extent) const;
+
+	const OcclusionStats& GetStats() const { return stats; }
+	int GetWidth() const { return width; }
+	int GetHeight() const { return height; }
+
+	static const int kTileSize = 32;
+	static const int kBoxesPerTask = 256;
+
+private:
+	// Occluder triangle in buffer pixels (x, y) and window depth [0, 1] (z).
+	struct ScreenTriangle
+	{
+		glm::vec3 v[3];
+	};
+
+	// OcclusionCuller Private Methods.
+	void AddClippedTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+	void RasterizeTile(const int tile);
+	void BuildPyramid();
+
+	// OcclusionCuller Private Data.
+	int width;
+	int height;
+	int tilesX;
+	int tilesY;
+	glm::mat4x4 viewProjMatrix;
+	std::vector<ScreenTriangle> triangles;
+	// Per tile, the triangles whose bounds overlap it.
+	std::vector<std::vector<int>> tileBins;
+	// levels[0] is the depth buffer (nearest occluder per pixel center, 1 where none);
+	// each further level keeps the farthest depth of a 2 x 2 block of the previous one.
+	std::vector<std::vector<float>> levels;
+	std::vector<int> levelWidths;
+	std::vector<int> levelHeights;
+	std::vector<int> taskCulled;
+	OcclusionStats stats;
+};
+
+#endif
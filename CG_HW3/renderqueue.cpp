@@ -0,0 +1,129 @@
+#include "renderqueue.h"
+
+uint64_t RenderQueue::MakeSortKey(const RenderPass pass, const unsigned int shaderId, const unsigned int textureId,
+	const unsigned int materialId, const float depth)
+{
+	const float clampedDepth = std::min(std::max(depth, 0.0f), 1.0f);
+	const uint64_t depthBits = (uint64_t)(clampedDepth * (float)((1 << 20) - 1));
+	return ((uint64_t)(pass & 0xF) << 60)
+		| ((uint64_t)(shaderId & 0xFF) << 52)
+		| ((uint64_t)(textureId & 0xFFFF) << 36)
+		| ((uint64_t)(materialId & 0xFFFF) << 20)
+		| depthBits;
+}
+
+void RenderQueue::Submit(const uint64_t sortKey, const int drawable, const int item)
+{
+	RenderPacket packet;
+	packet.sortKey = sortKey;
+	packet.drawable = drawable;
+	packet.item = item;
+	packets.push_back(packet);
+}
+
+void RenderQueue::Sort()
+{
+	const size_t count = packets.size();
+	if (count < 2)
+		return;
+
+	//Histograms of All Eight Bytes in One Read
+	size_t histograms[8][256] = {};
+	for (const RenderPacket& packet : packets) {
+		for (int pass = 0; pass < 8; ++pass)
+			histograms[pass][(packet.sortKey >> (pass * 8)) & 0xFF]++;
+	}
+
+	sortBuffer.resize(count);
+	for (int pass = 0; pass < 8; ++pass) {
+		size_t* histogram = histograms[pass];
+		if (histogram[(packets[0].sortKey >> (pass * 8)) & 0xFF] == count)
+			continue;
+		size_t offset = 0;
+		for (int bucket = 0; bucket < 256; ++bucket) {
+			const size_t bucketSize = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketSize;
+		}
+		for (const RenderPacket& packet : packets)
+			sortBuffer[histogram[(packet.sortKey >> (pass * 8)) & 0xFF]++] = packet;
+		packets.swap(sortBuffer);
+	}
+}
+
+RenderStateCache::RenderStateCache()
+{
+	BeginFrame();
+}
+
+void RenderStateCache::BeginFrame()
+{
+	boundProgram = nullptr;
+	boundTexture = nullptr;
+	for (int i = 0; i < NUM_UNIFORM_BLOCKS; ++i) {
+		boundBuffers[i] = 0;
+		boundBufferOffsets[i] = 0;
+	}
+	stats = RenderStats();
+}
+
+void RenderStateCache::EndFrame()
+{
+	if (boundProgram != nullptr)
+		boundProgram->UnBind();
+	boundProgram = nullptr;
+}
+
+bool RenderStateCache::BindProgram(ShaderProg* shader)
+{
+	if (shader == boundProgram)
+		return false;
+	shader->Bind();
+	boundProgram = shader;
+	stats.numProgramBinds++;
+	return true;
+}
+
+void RenderStateCache::BindTexture(ImageTexture* texture)
+{
+	if (texture == nullptr || texture == boundTexture)
+		return;
+	texture->Bind(GL_TEXTURE0);
+	boundTexture = texture;
+	stats.numTextureBinds++;
+}
+
+void RenderStateCache::BindUniformBuffer(const UniformBlockBinding binding, const GLuint bufferId,
+	const size_t offset, const size_t size)
+{
+	if (bufferId == boundBuffers[binding] && offset == boundBufferOffsets[binding])
+		return;
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, bufferId, offset, size);
+	boundBuffers[binding] = bufferId;
+	boundBufferOffsets[binding] = offset;
+	stats.numBufferBinds++;
+}
+
+void RenderStateCache::SetUniform(const GLint location, const glm::mat4x4& value)
+{
+	glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+	stats.numUniformUploads++;
+}
+
+void RenderStateCache::SetUniform(const GLint location, const glm::vec3& value)
+{
+	glUniform3fv(location, 1, glm::value_ptr(value));
+	stats.numUniformUploads++;
+}
+
+void RenderStateCache::SetUniform(const GLint location, const float value)
+{
+	glUniform1f(location, value);
+	stats.numUniformUploads++;
+}
+
+void RenderStateCache::SetUniform(const GLint location, const int value)
+{
+	glUniform1i(location, value);
+	stats.numUniformUploads++;
+}
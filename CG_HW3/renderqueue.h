@@ -0,0 +1,100 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "headers.h"
+#include "shaderprog.h"
+#include "imagetexture.h"
+#include "uniformbuffer.h"
+
+// Passes in drawing order.
+enum RenderPass
+{
+	RENDER_PASS_OPAQUE = 0,
+	RENDER_PASS_GIZMO = 1,		// Light markers.
+	RENDER_PASS_SKY = 2			// Last, so the depth test rejects the sky behind everything else.
+};
+
+// RenderPacket Declarations.
+// One draw. The queue only orders packets; what drawable and item refer to is up to the caller.
+struct RenderPacket
+{
+	uint64_t sortKey;
+	int drawable;
+	int item;
+};
+
+// RenderQueue Declarations.
+class RenderQueue
+{
+public:
+	// RenderQueue Public Methods.
+	// Sort key, most significant first: pass (4 bits), shader (8), texture (16), material (16) and
+	// depth (20, from 0 = near to 1 = far). Ids are folded to their width; a collision only costs
+	// some grouping, the state cache still compares the real objects.
+	static uint64_t MakeSortKey(const RenderPass pass, const unsigned int shaderId, const unsigned int textureId,
+		const unsigned int materialId, const float depth);
+
+	void Clear() { packets.clear(); }
+	void Submit(const uint64_t sortKey, const int drawable, const int item);
+	// Stable LSD radix sort on the key, one byte per pass; bytes every key shares are skipped.
+	void Sort();
+	const std::vector<RenderPacket>& GetPackets() const { return packets; }
+
+private:
+	// RenderQueue Private Data.
+	std::vector<RenderPacket> packets;
+	std::vector<RenderPacket> sortBuffer;
+};
+
+// RenderStats Declarations.
+// GL state changes issued through a RenderStateCache since its BeginFrame.
+struct RenderStats
+{
+	RenderStats() {
+		numProgramBinds = 0;
+		numTextureBinds = 0;
+		numBufferBinds = 0;
+		numUniformUploads = 0;
+	}
+	int numProgramBinds;
+	int numTextureBinds;
+	int numBufferBinds;			// Uniform buffer ranges attached to a block binding.
+	int numUniformUploads;		// Plain (non-block) uniforms.
+};
+
+// RenderStateCache Declarations.
+// Binds programs, textures (unit 0) and uniform buffer ranges only when they differ from the
+// bound ones, and counts every bind and upload it issues.
+class RenderStateCache
+{
+public:
+	// RenderStateCache Public Methods.
+	RenderStateCache();
+
+	// Forget the bound state, since other code may have changed it between frames, and zero the stats.
+	void BeginFrame();
+	// Leave no program bound.
+	void EndFrame();
+	// Returns true if the program had to be bound.
+	bool BindProgram(ShaderProg* shader);
+	void BindTexture(ImageTexture* texture);
+	// Attach size bytes of a buffer from offset to a block binding point.
+	void BindUniformBuffer(const UniformBlockBinding binding, const GLuint bufferId, const size_t offset, const size_t size);
+
+	void SetUniform(const GLint location, const glm::mat4x4& value);
+	void SetUniform(const GLint location, const glm::vec3& value);
+	void SetUniform(const GLint location, const float value);
+	void SetUniform(const GLint location, const int value);
+
+	const RenderStats& GetStats() const { return stats; }
+
+private:
+	// RenderStateCache Private Data.
+	ShaderProg* boundProgram;
+	ImageTexture* boundTexture;
+	GLuint boundBuffers[NUM_UNIFORM_BLOCKS];
+	size_t boundBufferOffsets[NUM_UNIFORM_BLOCKS];
+	RenderStats stats;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "ringbuffer.h"
+
+RingBuffer::RingBuffer()
+{
+	bufferId = 0;
+	frameSize = 0;
+	uniformAlignment = 256;
+	persistent = false;
+	mappedData = nullptr;
+	frameIndex = 0;
+	frameOffset = 0;
+	for (int i = 0; i < RING_BUFFER_FRAMES; ++i)
+		fences[i] = 0;
+}
+
+RingBuffer::~RingBuffer()
+{
+	Release();
+}
+
+void RingBuffer::Create(const size_t size)
+{
+	Release();
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	uniformAlignment = (alignment > 0) ? (size_t)alignment : 256;
+	// Regions start on an alignment boundary, so offsets aligned within a region stay aligned.
+	frameSize = (size + uniformAlignment - 1) / uniformAlignment * uniformAlignment;
+	const size_t bufferSize = frameSize * RING_BUFFER_FRAMES;
+
+	// The copy target keeps whatever is bound to the uniform and vertex targets untouched.
+	glGenBuffers(1, &bufferId);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+	persistent = (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage);
+	if (persistent) {
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, bufferSize, nullptr, flags);
+		mappedData = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bufferSize, flags);
+		if (mappedData == nullptr) {
+			// Storage is immutable, so the fallback needs a fresh buffer.
+			std::cerr << "[WARNING] Persistent mapping failed; streaming through glMapBufferRange" << std::endl;
+			glDeleteBuffers(1, &bufferId);
+			glGenBuffers(1, &bufferId);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+			persistent = false;
+		}
+	}
+	if (!persistent)
+		glBufferData(GL_COPY_WRITE_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	frameIndex = 0;
+	frameOffset = 0;
+	stats = RingBufferStats();
+}
+
+void RingBuffer::Release()
+{
+	for (int i = 0; i < RING_BUFFER_FRAMES; ++i) {
+		if (fences[i] != 0)
+			glDeleteSync(fences[i]);
+		fences[i] = 0;
+	}
+	if (bufferId != 0) {
+		if (mappedData != nullptr) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &bufferId);
+	}
+	bufferId = 0;
+	mappedData = nullptr;
+	frameSize = 0;
+	persistent = false;
+}
+
+void RingBuffer::BeginFrame()
+{
+	frameIndex = (frameIndex + 1) % RING_BUFFER_FRAMES;
+	frameOffset = 0;
+	stats.bytesAllocated = 0;
+	stats.numOverflows = 0;
+
+	// Wait Until the GPU Has Read This Region's Data from RING_BUFFER_FRAMES Frames Ago
+	GLsync& fence = fences[frameIndex];
+	if (fence != 0) {
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED) {
+			auto startTime = std::chrono::high_resolution_clock::now();
+			stats.numFenceWaits++;
+			do {
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			} while (result == GL_TIMEOUT_EXPIRED);
+			stats.waitSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+		}
+		glDeleteSync(fence);
+		fence = 0;
+	}
+
+	if (!persistent && bufferId != 0) {
+		// The fence already guarantees the GPU is done with the region, so skip the driver's sync.
+		glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+		mappedData = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, frameIndex * frameSize, frameSize,
+			GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+}
+
+void* RingBuffer::Allocate(const size_t size, const size_t alignment, size_t& offset)
+{
+	const size_t start = (alignment > 1) ? (frameOffset + alignment - 1) / alignment * alignment : frameOffset;
+	if (mappedData == nullptr || start + size > frameSize) {
+		stats.numOverflows++;
+		return nullptr;
+	}
+	frameOffset = start + size;
+	stats.bytesAllocated = frameOffset;
+	offset = frameIndex * frameSize + start;
+	return persistent ? mappedData + offset : mappedData + start;
+}
+
+void RingBuffer::FinishWrites()
+{
+	// Coherent persistent writes are visible to the commands issued after them.
+	if (persistent || mappedData == nullptr)
+		return;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+	glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, 0, frameOffset);
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	mappedData = nullptr;
+}
+
+void RingBuffer::EndFrame()
+{
+	FinishWrites();
+	if (bufferId != 0)
+		fences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,72 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "headers.h"
+
+// Frames the CPU may write ahead of the GPU; each has its own region of the buffer.
+#define RING_BUFFER_FRAMES 3
+
+// RingBufferStats Declarations.
+struct RingBufferStats
+{
+	RingBufferStats() {
+		bytesAllocated = 0;
+		numOverflows = 0;
+		numFenceWaits = 0;
+		waitSeconds = 0.0;
+	}
+	size_t bytesAllocated;		// In the current frame's region, alignment padding included.
+	int numOverflows;			// Allocations refused this frame because the region was full.
+	int numFenceWaits;			// Frames that found their region still in use by the GPU (since Create).
+	double waitSeconds;			// Time spent blocked on those fences.
+};
+
+// RingBuffer Declarations.
+// Streaming buffer for data rewritten every frame. Each frame bump-allocates from one of
+// RING_BUFFER_FRAMES regions; a fence at EndFrame tells when the GPU is done reading it, so the
+// CPU only waits if it gets a whole ring ahead. With GL 4.4 / ARB_buffer_storage the buffer
+// stays persistently and coherently mapped; otherwise the region is mapped unsynchronized for
+// the frame's writes.
+class RingBuffer
+{
+public:
+	// RingBuffer Public Methods.
+	RingBuffer();
+	~RingBuffer();
+
+	// frameSize: bytes per frame region (rounded up to the uniform buffer offset alignment).
+	void Create(const size_t frameSize);
+	void Release();
+
+	// Frame sequence: BeginFrame, Allocate and write, FinishWrites before the draws that read
+	// the data, then EndFrame once those draws are issued.
+	void BeginFrame();
+	// Returns where to write size bytes, aligned to alignment within the buffer, and stores their
+	// buffer offset in offset; nullptr if the frame's region is full (or, when not persistent,
+	// after FinishWrites).
+	void* Allocate(const size_t size, const size_t alignment, size_t& offset);
+	void FinishWrites();
+	void EndFrame();
+
+	GLuint GetBufferId() const { return bufferId; }
+	size_t GetFrameSize() const { return frameSize; }
+	bool IsPersistent() const { return persistent; }
+	// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, for data bound with glBindBufferRange.
+	size_t GetUniformAlignment() const { return uniformAlignment; }
+	const RingBufferStats& GetStats() const { return stats; }
+
+private:
+	// RingBuffer Private Data.
+	GLuint bufferId;
+	size_t frameSize;
+	size_t uniformAlignment;
+	bool persistent;
+	// The whole buffer when persistent, else the current region while it is mapped.
+	unsigned char* mappedData;
+	int frameIndex;
+	size_t frameOffset;
+	GLsync fences[RING_BUFFER_FRAMES];
+	RingBufferStats stats;
+};
+
+#endif
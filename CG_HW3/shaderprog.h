@@ -1,150 +1,116 @@
-#ifndef SHADER_PROGRAM_H
-#define SHADER_PROGRAM_H
-
-#include "headers.h"
-
-// ShaderProg Declarations.
-class ShaderProg
-{
-public:
-	// ShaderProg Public Methods.
-	ShaderProg();
-	~ShaderProg();
-
-	bool LoadFromFiles(const std::string vsFilePath, const std::string fsFilePath);
-	void Bind() { glUseProgram(shaderProgId); };
-	void UnBind() { glUseProgram(0); };
-
-	GLint GetLocMVP() const { return locMVP; }
-
-protected:
-	// ShaderProg Protected Methods.
-	virtual void GetUniformVariableLocation();
-
-	// ShaderProg Protected Data.
-	GLuint shaderProgId;
-
-private:
-	// ShaderProg Private Methods.
-	GLuint AddShader(const std::string& sourceText, GLenum shaderType);
-	static bool LoadShaderTextFromFile(const std::string filePath, std::string& sourceText);
-
-	// ShaderProg Private Data.
-	GLint locMVP;
-};
-
-// ------------------------------------------------------------------------------------------------
-
-// FillColorShaderProg Declarations.
-class FillColorShaderProg : public ShaderProg
-{
-public:
-	// FillColorShaderProg Public Methods.
-	FillColorShaderProg();
-	~FillColorShaderProg();
-
-	GLint GetLocFillColor() const { return locFillColor; }
-
-protected:
-	// FillColorShaderProg Protected Methods.
-	void GetUniformVariableLocation();
-
-private:
-	// FillColorShaderProg Private Data.
-	GLint locFillColor;
-};
-
-// ------------------------------------------------------------------------------------------------
-
-// PhongShadingDemoShaderProg Declarations.
-class PhongShadingDemoShaderProg : public ShaderProg
-{
-public:
-	// PhongShadingDemoShaderProg Public Methods.
-	PhongShadingDemoShaderProg();
-	~PhongShadingDemoShaderProg();
-
-	GLint GetLocM() const { return locM; }
-	GLint GetLocNM() const { return locNM; }
-	GLint GetLocCameraPos() const { return locCameraPos; }
-	GLint GetLocKa() const { return locKa; }
-	GLint GetLocKd() const { return locKd; }
-	GLint GetLocKs() const { return locKs; }
-	GLint GetLocNs() const { return locNs; }
-	GLint GetLocAmbientLight() const { return locAmbientLight; }
-	GLint GetLocDirLightDir() const { return locDirLightDir; }
-	GLint GetLocDirLightRadiance() const { return locDirLightRadiance; }
-	GLint GetLocPointLightPos() const { return locPointLightPos; }
-	GLint GetLocPointLightIntensity() const { return locPointLightIntensity; }
-	GLint GetLocSpotLightPos() const { return locSpotLightPos; }
-	GLint GetLocSpotLightDir() const { return locSpotLightDir; }
-	GLint GetLocSpotLightIntensity() const { return locSpotLightIntensity; }
-	GLint GetLocSpotLightTotalWidth() const { return locSpotLightTotalWidth; }
-	GLint GetLocSpotLightFoS() const { return locSpotLightFoS; }
-	GLint GetLocCosSpotLightTotalWidth() const { return locCosSpotLightTotalWidth; }
-	GLint GetLocCosSpotLightFoS() const { return locCosSpotLightFoS; }
-	GLint GetLocLightingMode() const { return locLightingMode; }
-	GLint GetLocMapKd() const { return locMapKd; }
-	GLint GetLocUseMapKd() const { return locUseMapKd; }
-
-protected:
-	// PhongShadingDemoShaderProg Protected Methods.
-	void GetUniformVariableLocation();
-
-private:
-	// PhongShadingDemoShaderProg Public Data.
-	// Transformation matrix.
-	GLint locM;
-	GLint locNM;
-	GLint locCameraPos;
-	// Material properties.
-	GLint locKa;
-	GLint locKd;
-	GLint locKs;
-	GLint locNs;
-	// Light data.
-	// Ambient Light
-	GLint locAmbientLight;
-	// Directional Light
-	GLint locDirLightDir;
-	GLint locDirLightRadiance;
-	// Point Light
-	GLint locPointLightPos;
-	GLint locPointLightIntensity;
-	// Spot Light
-	GLint locSpotLightPos;
-	GLint locSpotLightDir;
-	GLint locSpotLightIntensity;
-	GLint locSpotLightTotalWidth;
-	GLint locSpotLightFoS;
-	GLint locCosSpotLightTotalWidth;
-	GLint locCosSpotLightFoS;
-	// Lighting Mode
-	GLint locLightingMode;
-	// Texture data.
-	GLint locMapKd;
-	GLint locUseMapKd;
-};
-
-// ------------------------------------------------------------------------------------------------
-
-// SkyboxShaderProg Declarations.
-class SkyboxShaderProg : public ShaderProg
-{
-public:
-	// SkyboxShaderProg Public Methods.
-	SkyboxShaderProg();
-	~SkyboxShaderProg();
-
-	GLint GetLocMapKd() const { return locMapKd; }
-
-protected:
-	// PhongShadingDemoShaderProg Protected Methods.
-	void GetUniformVariableLocation();
-
-private:
-	// SkyboxShaderProg Public Data.
-	GLint locMapKd;
-};
-
-#endif
+#ifndef SHADER_PROGRAM_H
+#define SHADER_PROGRAM_H
+
+#include "headers.h"
+#include "uniformbuffer.h"
+
+// ShaderProg Declarations.
+class ShaderProg
+{
+public:
+	// ShaderProg Public Methods.
+	ShaderProg();
+	~ShaderProg();
+
+	// defines: extra lines (e.g. "#define MULTI_DRAW\n") inserted after each stage's #version.
+	bool LoadFromFiles(const std::string vsFilePath, const std::string fsFilePath, const std::string defines = "");
+	void Bind() { glUseProgram(shaderProgId); };
+	void UnBind() { glUseProgram(0); };
+
+	GLint GetLocM() const { return locM; }
+	GLuint GetProgramId() const { return shaderProgId; }
+
+protected:
+	// ShaderProg Protected Methods.
+	virtual void GetUniformVariableLocation();
+
+	// ShaderProg Protected Data.
+	GLuint shaderProgId;
+
+private:
+	// ShaderProg Private Methods.
+	void BindUniformBlocks();
+	GLuint AddShader(const std::string& sourceText, GLenum shaderType);
+	static bool LoadShaderTextFromFile(const std::string filePath, std::string& sourceText);
+	static void InsertDefines(std::string& sourceText, const std::string& defines);
+
+	// ShaderProg Private Data.
+	// Model to world; the view and projection come from the FrameUniforms block.
+	GLint locM;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+// FillColorShaderProg Declarations.
+class FillColorShaderProg : public ShaderProg
+{
+public:
+	// FillColorShaderProg Public Methods.
+	FillColorShaderProg();
+	~FillColorShaderProg();
+
+	GLint GetLocFillColor() const { return locFillColor; }
+
+protected:
+	// FillColorShaderProg Protected Methods.
+	void GetUniformVariableLocation();
+
+private:
+	// FillColorShaderProg Private Data.
+	GLint locFillColor;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+// PhongShadingDemoShaderProg Declarations.
+class PhongShadingDemoShaderProg : public ShaderProg
+{
+public:
+	// PhongShadingDemoShaderProg Public Methods.
+	PhongShadingDemoShaderProg();
+	~PhongShadingDemoShaderProg();
+
+	GLint GetLocNM() const { return locNM; }
+	GLint GetLocMaterialIndex() const { return locMaterialIndex; }
+	// mapKd is the diffuse map, or the mesh's texture array in a MULTI_DRAW program.
+	GLint GetLocMapKd() const { return locMapKd; }
+	GLint GetLocUseOctNormal() const { return locUseOctNormal; }
+
+protected:
+	// PhongShadingDemoShaderProg Protected Methods.
+	void GetUniformVariableLocation();
+
+private:
+	// PhongShadingDemoShaderProg Public Data.
+	// Transformation matrix.
+	GLint locNM;
+	// Material properties: an index into the MaterialUniforms block.
+	GLint locMaterialIndex;
+	// Texture data.
+	GLint locMapKd;
+	// Vertex layout.
+	GLint locUseOctNormal;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+// SkyboxShaderProg Declarations.
+class SkyboxShaderProg : public ShaderProg
+{
+public:
+	// SkyboxShaderProg Public Methods.
+	SkyboxShaderProg();
+	~SkyboxShaderProg();
+
+	GLint GetLocMapKd() const { return locMapKd; }
+
+protected:
+	// PhongShadingDemoShaderProg Protected Methods.
+	void GetUniformVariableLocation();
+
+private:
+	// SkyboxShaderProg Public Data.
+	GLint locMapKd;
+};
+
+#endif
@@ -6,41 +6,48 @@ in vec3 iNormalWorld;
 in vec2 iTexCoord;
 
 
-// Material properties.
-uniform vec3 Ka;
-uniform vec3 Kd;
-uniform vec3 Ks;
-uniform float Ns;
-
-// Camera Position
-uniform vec3 cameraPos;
-
-// Light data.
-uniform vec3 ambientLight;
-
-// Directional Light
-uniform vec3 dirLightDir;
-uniform vec3 dirLightRadiance;
-
-// Point Light
-uniform vec3 pointLightPos;
-uniform vec3 pointLightIntensity;
-
-// Spot Light
-uniform vec3 spotLightPos;
-uniform vec3 spotLightIntensity;
-uniform vec3 spotLightDir;
-uniform float spotLightTotalWidth;
-uniform float spotLightFoS;
-uniform float cosSpotLightTotalWidth;
-uniform float cosSpotLightFos;
-
-// Lighting Mode
-uniform int lightingMode;
+// Material properties: the mesh's materials (std140, mirrored by MaterialUniforms in
+// uniformbuffer.h), Kd.w flags a diffuse texture and Ks.w holds Ns.
+struct Material
+{
+    vec4 Ka;
+    vec4 Kd;
+    vec4 Ks;
+};
+layout (std140) uniform MaterialUniforms
+{
+    Material materials[256];
+};
+#ifdef MULTI_DRAW
+flat in int iMaterialIndex;
+flat in int iTextureLayer;
+#else
+uniform int materialIndex;
+#endif
+
+// Per-frame data shared by every program (std140, mirrored by FrameUniforms in uniformbuffer.h).
+layout (std140) uniform FrameUniforms
+{
+    mat4 viewProjMatrix;
+    vec4 cameraPos;
+    vec4 ambientLight;
+    vec4 dirLightDir;
+    vec4 dirLightRadiance;
+    vec4 pointLightPos;
+    vec4 pointLightIntensity;
+    vec4 spotLightPos;
+    vec4 spotLightIntensity;
+    vec4 spotLightDir;
+    vec4 spotLightCone;    // Total width, falloff start (degrees), then their cosines.
+    int lightingMode;
+};
 
 // Texture Data
+#ifdef MULTI_DRAW
+uniform sampler2DArray mapKd;
+#else
 uniform sampler2D mapKd;
-uniform bool useMapKd;
+#endif
 
 out vec4 FragColor;
 
@@ -77,12 +84,28 @@ float getDegree(vec3 v1, vec3 v2){
 
 void main()
 {
+    // Fetch This Draw's Material
+#ifdef MULTI_DRAW
+    Material material = materials[iMaterialIndex];
+#else
+    Material material = materials[materialIndex];
+#endif
+    vec3 Ka = material.Ka.rgb;
+    vec3 Kd = material.Kd.rgb;
+    vec3 Ks = material.Ks.rgb;
+    float Ns = material.Ks.w;
+    bool useMapKd = material.Kd.w != 0.0;
+
     vec3 N = normalize(iNormalWorld);
     vec3 worldLightDir;
     vec3 diffuse;
     vec3 specular;
-    vec3 worldViewDir = normalize(cameraPos - iPosWorld);
+    vec3 worldViewDir = normalize(cameraPos.xyz - iPosWorld);
+#ifdef MULTI_DRAW
+    vec3 texKd = useMapKd ? texture(mapKd, vec3(iTexCoord, iTextureLayer)).rgb : Kd;
+#else
     vec3 texKd = useMapKd ? texture2D(mapKd, iTexCoord).rgb : Kd;
+#endif
 
     // For Spot Light & Point Light To Calculate Local Ligth Intensity
     float attenuation;
@@ -93,32 +116,32 @@ void main()
     
     //----------------------------------------------------------------
     // Ambient Light
-       vec3 ambient = Ka * ambientLight;
+       vec3 ambient = Ka * ambientLight.xyz;
     //----------------------------------------------------------------
     
 
     //----------------------------------------------------------------
     // Directional Light
-       worldLightDir = normalize(-dirLightDir);      
+       worldLightDir = normalize(-dirLightDir.xyz);      
 
        //Diffuse
        //diffuse = Diffuse(Kd, dirLightRadiance, N, worldLightDir);
-       diffuse = Diffuse(texKd, dirLightRadiance, N, worldLightDir);
+       diffuse = Diffuse(texKd, dirLightRadiance.xyz, N, worldLightDir);
 
        //Specular
-       specular = Specular(Ks, dirLightRadiance, N, worldLightDir, worldViewDir, Ns);
+       specular = Specular(Ks, dirLightRadiance.xyz, N, worldLightDir, worldViewDir, Ns);
        
        //Directional Light Sum
        vec3 dirLight = diffuse + specular;
     //----------------------------------------------------------------
     // Point Light
-       worldLightDir = normalize(pointLightPos - iPosWorld);
+       worldLightDir = normalize(pointLightPos.xyz - iPosWorld);
        
-       distSurfaceToLight = distance(pointLightPos, iPosWorld);
+       distSurfaceToLight = distance(pointLightPos.xyz, iPosWorld);
     
        attenuation = 1.0f / (distSurfaceToLight * distSurfaceToLight);
     
-       radiance = pointLightIntensity * attenuation;
+       radiance = pointLightIntensity.xyz * attenuation;
     
        //Diffuse
        //diffuse = Diffuse(Kd, radiance, N, worldLightDir);
@@ -131,20 +154,20 @@ void main()
        vec3 pointLight = diffuse + specular;
     //----------------------------------------------------------------
     // Spot Light
-       worldLightDir = normalize(spotLightPos - iPosWorld);
+       worldLightDir = normalize(spotLightPos.xyz - iPosWorld);
        
        
-       float angleA = getDegree(-normalize(spotLightDir), worldLightDir);
+       float angleA = getDegree(-normalize(spotLightDir.xyz), worldLightDir);
        
        float cosA = degreeToCos(angleA);
        //float cosT = degreeToCos(spotLightTotalWidth);
        //float cosF = degreeToCos(spotLightFoS);
        
-       radiance = spotLightIntensity * clamp((cosA - cosSpotLightTotalWidth) / (cosSpotLightFos - cosSpotLightTotalWidth), 0.0, 1.0);
+       radiance = spotLightIntensity.xyz * clamp((cosA - spotLightCone.z) / (spotLightCone.w - spotLightCone.z), 0.0, 1.0);
        //radiance = spotLightIntensity * clamp((cosA - cosT) / (cosF - cosT), 0.0, 1.0);
 
 
-       distSurfaceToLight = distance(spotLightPos, iPosWorld);
+       distSurfaceToLight = distance(spotLightPos.xyz, iPosWorld);
        attenuation = 1.0f / (distSurfaceToLight * distSurfaceToLight);
 
        radiance *= attenuation;
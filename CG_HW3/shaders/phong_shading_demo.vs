@@ -4,25 +4,71 @@ layout (location = 0) in vec3 Position;
 layout (location = 1) in vec3 Normal;
 layout (location = 2) in vec2 TexCoord;
 
+// Per-frame data shared by every program (std140, mirrored by FrameUniforms in uniformbuffer.h).
+layout (std140) uniform FrameUniforms
+{
+    mat4 viewProjMatrix;
+    vec4 cameraPos;
+    vec4 ambientLight;
+    vec4 dirLightDir;
+    vec4 dirLightRadiance;
+    vec4 pointLightPos;
+    vec4 pointLightIntensity;
+    vec4 spotLightPos;
+    vec4 spotLightIntensity;
+    vec4 spotLightDir;
+    vec4 spotLightCone;    // Total width, falloff start (degrees), then their cosines.
+    int lightingMode;
+};
+
+#ifdef INSTANCED
+// Transformation matrix, per instance.
+layout (location = 4) in mat4 InstanceWorldMatrix;
+layout (location = 8) in mat4 InstanceNormalMatrix;
+#define worldMatrix InstanceWorldMatrix
+#define normalMatrix InstanceNormalMatrix
+#else
 // Transformation matrix.
 uniform mat4 worldMatrix;
 uniform mat4 normalMatrix;
-uniform mat4 MVP;
+#endif
+// Compact vertices carry an octahedral-encoded normal in Normal.xy.
+uniform bool useOctNormal;
+
+#ifdef MULTI_DRAW
+// Per draw, selected by the command's base instance: material index and texture layer.
+layout (location = 3) in ivec2 DrawData;
+flat out int iMaterialIndex;
+flat out int iTextureLayer;
+#endif
 
 // Data pass to fragment shader.
 out vec3 iPosWorld;
 out vec3 iNormalWorld;
 out vec2 iTexCoord;
 
+vec3 OctDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
 void main()
 {
     // Vertext Position Transform
-    gl_Position = MVP * vec4(Position, 1.0);
+    vec4 positionTmp = worldMatrix * vec4(Position, 1.0);
+    gl_Position = viewProjMatrix * positionTmp;
     
     // Pass Vertex Attributes
-    vec4 positionTmp = worldMatrix * vec4(Position, 1.0);
     iPosWorld = positionTmp.xyz / positionTmp.w;
 
-    iNormalWorld = (normalMatrix * vec4(Normal, 0.0)).xyz;
+    vec3 normal = useOctNormal ? OctDecode(Normal.xy) : Normal;
+    iNormalWorld = (normalMatrix * vec4(normal, 0.0)).xyz;
     iTexCoord = TexCoord;
+#ifdef MULTI_DRAW
+    iMaterialIndex = DrawData.x;
+    iTextureLayer = DrawData.y;
+#endif
 }
\ No newline at end of file
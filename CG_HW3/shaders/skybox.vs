@@ -5,12 +5,29 @@ layout (location = 1) in vec2 TexCoord;
 
 out vec2 iTexCoord;
 
-uniform mat4 MVP;
+// Per-frame data shared by every program (std140, mirrored by FrameUniforms in uniformbuffer.h).
+layout (std140) uniform FrameUniforms
+{
+    mat4 viewProjMatrix;
+    vec4 cameraPos;
+    vec4 ambientLight;
+    vec4 dirLightDir;
+    vec4 dirLightRadiance;
+    vec4 pointLightPos;
+    vec4 pointLightIntensity;
+    vec4 spotLightPos;
+    vec4 spotLightIntensity;
+    vec4 spotLightDir;
+    vec4 spotLightCone;    // Total width, falloff start (degrees), then their cosines.
+    int lightingMode;
+};
+
+uniform mat4 worldMatrix;
 
 
 void main()
 {
-    gl_Position = MVP * vec4(Position, 1.0);
+    gl_Position = viewProjMatrix * worldMatrix * vec4(Position, 1.0);
     
     // Pass 
     iTexCoord = TexCoord;
@@ -1,62 +1,67 @@
-#ifndef SKYBOX_H
-#define SKYBOX_H
-
-#include "headers.h"
-#include "imagetexture.h"
-#include "shaderprog.h"
-#include "material.h"
-#include "camera.h"
-
-
-// VertexPT Declarations.
-struct VertexPT
-{
-	VertexPT() {
-		position = glm::vec3(0.0f, 0.0f, 0.0f);
-		texcoord = glm::vec2(0.0f, 0.0f);
-	}
-	VertexPT(glm::vec3 p, glm::vec2 uv) {
-		position = p;
-		texcoord = uv;
-	}
-	glm::vec3 position;
-	glm::vec2 texcoord;
-};
-
-
-// Skybox Declarations.
-class Skybox
-{
-public:
-	// Skybox Public Methods.
-	Skybox(const std::string& texImagePath, const int nSlices, 
-			const int nStacks, const float radius);
-	~Skybox();
-	void Render(Camera* camera, SkyboxShaderProg* shader);
-	
-	void SetRotation(const float newRotation) { rotationY = newRotation; } 
-	void RotateRight(const float RotateSpeed) { rotationY -= RotateSpeed; }
-	void RotateLeft(const float RotateSpeed) { rotationY += RotateSpeed; }
-
-	ImageTexture* GetTexture() { return panorama; };
-	float GetRotation() const  { return rotationY; }
-
-private:
-	// Skybox Private Methods.
-	static void CreateSphere3D(const int nSlices, const int nStacks, const float radius, 
-					std::vector<VertexPT>& vertices, std::vector<unsigned int>& indices);
-
-	// Skybox Private Data.
-	GLuint vboId;
-	GLuint iboId;
-	std::vector<VertexPT> vertices;
-	std::vector<unsigned int> indices;
-	
-	SkyboxMaterial* material;
-	ImageTexture* panorama;
-
-	float rotationY;
-};
-
-#endif
-
+#ifndef SKYBOX_H
+#define SKYBOX_H
+
+#include "headers.h"
+#include "imagetexture.h"
+#include "shaderprog.h"
+#include "material.h"
+#include "camera.h"
+
+
+// VertexPT Declarations.
+struct VertexPT
+{
+	VertexPT() {
+		position = glm::vec3(0.0f, 0.0f, 0.0f);
+		texcoord = glm::vec2(0.0f, 0.0f);
+	}
+	VertexPT(glm::vec3 p, glm::vec2 uv) {
+		position = p;
+		texcoord = uv;
+	}
+	glm::vec3 position;
+	glm::vec2 texcoord;
+};
+
+
+// Skybox Declarations.
+class Skybox
+{
+public:
+	// Skybox Public Methods.
+	Skybox(const std::string& texImagePath, const int nSlices, 
+			const int nStacks, const float radius);
+	~Skybox();
+	// Draw with shader; the view and projection come from the FrameUniforms block bound at the time.
+	void Render(SkyboxShaderProg* shader);
+	// Only the draw call; the caller has bound the shader, its uniforms and the panorama.
+	void Draw();
+	glm::mat4x4 GetRotationMatrix() const { return glm::rotate(glm::mat4x4(1.0f), glm::radians(rotationY), glm::vec3(0, 1, 0)); }
+	
+	void SetRotation(const float newRotation) { rotationY = newRotation; } 
+	void RotateRight(const float RotateSpeed) { rotationY -= RotateSpeed; }
+	void RotateLeft(const float RotateSpeed) { rotationY += RotateSpeed; }
+
+	ImageTexture* GetTexture() { return panorama; };
+	float GetRotation() const  { return rotationY; }
+
+private:
+	// Skybox Private Methods.
+	static void CreateSphere3D(const int nSlices, const int nStacks, const float radius, 
+					std::vector<VertexPT>& vertices, std::vector<unsigned int>& indices);
+
+	// Skybox Private Data.
+	GLuint vaoId;
+	GLuint vboId;
+	GLuint iboId;
+	std::vector<VertexPT> vertices;
+	std::vector<unsigned int> indices;
+	
+	SkyboxMaterial* material;
+	ImageTexture* panorama;
+
+	float rotationY;
+};
+
+#endif
+
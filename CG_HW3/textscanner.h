@@ -0,0 +1,151 @@
+#ifndef TEXT_SCANNER_H
+#define TEXT_SCANNER_H
+
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+// TextScanner Declarations.
+// Allocation-free, locale-independent cursor over an in-memory text buffer
+// (e.g. a MappedFile). Lines end at '\n'; '\r' is treated as a blank.
+struct TextScanner
+{
+	TextScanner(const char* begin, const char* end) : cur(begin), end(end) {}
+
+	bool AtEnd() const { return cur >= end; }
+
+	static bool IsBlank(const char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+	static bool IsDigit(const char c) { return (unsigned char)(c - '0') < 10; }
+
+	void SkipBlanks() {
+		while (cur < end && IsBlank(*cur)) ++cur;
+	}
+
+	// True once only blanks remain on the current line.
+	bool AtLineEnd() {
+		SkipBlanks();
+		return cur >= end || *cur == '\n';
+	}
+
+	// Move to the first character of the next line.
+	void NextLine() {
+		const char* eol = (const char*)memchr(cur, '\n', (size_t)(end - cur));
+		cur = (eol != nullptr) ? eol + 1 : end;
+	}
+
+	// Read the next blank-separated token on the current line.
+	bool NextToken(const char*& token, size_t& length) {
+		SkipBlanks();
+		const char* start = cur;
+		while (cur < end && *cur != '\n' && !IsBlank(*cur)) ++cur;
+		token = start;
+		length = (size_t)(cur - start);
+		return length > 0;
+	}
+
+	static bool TokenIs(const char* token, const size_t length, const char* literal) {
+		return strlen(literal) == length && memcmp(token, literal, length) == 0;
+	}
+
+	// Parse a signed decimal integer at the cursor.
+	bool ParseInt(int& value) {
+		const char* p = cur;
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			negative = (*p == '-');
+			++p;
+		}
+		if (p >= end || !IsDigit(*p))
+			return false;
+		int result = 0;
+		while (p < end && IsDigit(*p)) {
+			result = result * 10 + (*p - '0');
+			++p;
+		}
+		value = negative ? -result : result;
+		cur = p;
+		return true;
+	}
+
+	// Parse a float at the cursor after skipping blanks.
+	// Short decimals (up to 24 mantissa bits and |exponent| <= 10) take an exact fast path:
+	// the mantissa and the power of ten are both exact floats, so a single multiply or divide
+	// gives the correctly rounded result. Everything else goes through std::from_chars, so the
+	// result always matches a correctly rounded strtof without touching the C locale.
+	bool ParseFloat(float& value) {
+		SkipBlanks();
+		const char* start = cur;
+		const char* p = cur;
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			negative = (*p == '-');
+			++p;
+		}
+		const char* numStart = p;
+
+		uint64_t mantissa = 0;
+		int numDigits = 0;
+		int exponent = 0;
+		bool anyDigit = false;
+		while (p < end && IsDigit(*p)) {
+			mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+			if (mantissa != 0) ++numDigits;
+			anyDigit = true;
+			++p;
+		}
+		if (p < end && *p == '.') {
+			++p;
+			while (p < end && IsDigit(*p)) {
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				if (mantissa != 0) ++numDigits;
+				--exponent;
+				anyDigit = true;
+				++p;
+			}
+		}
+		if (anyDigit && p < end && (*p == 'e' || *p == 'E')) {
+			const char* q = p + 1;
+			bool expNegative = false;
+			if (q < end && (*q == '-' || *q == '+')) {
+				expNegative = (*q == '-');
+				++q;
+			}
+			if (q < end && IsDigit(*q)) {
+				int expValue = 0;
+				while (q < end && IsDigit(*q)) {
+					if (expValue < 10000) expValue = expValue * 10 + (*q - '0');
+					++q;
+				}
+				exponent += expNegative ? -expValue : expValue;
+				p = q;
+			}
+		}
+
+		if (anyDigit && numDigits <= 19 && mantissa <= (1u << 24) && exponent >= -10 && exponent <= 10) {
+			static const float kPow10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+			float result = (float)mantissa;
+			if (exponent < 0) result /= kPow10[-exponent];
+			else result *= kPow10[exponent];
+			value = negative ? -result : result;
+			cur = p;
+			return true;
+		}
+
+		// Slow path: long mantissas, large exponents, inf/nan.
+		// std::from_chars does not accept a leading '+'.
+		const char* fromStart = (start < numStart && *start == '+') ? numStart : start;
+		float result = 0.0f;
+		std::from_chars_result res = std::from_chars(fromStart, end, result);
+		if (res.ec == std::errc::invalid_argument)
+			return false;
+		value = result;
+		cur = res.ptr;
+		return true;
+	}
+
+	const char* cur;
+	const char* end;
+};
+
+#endif
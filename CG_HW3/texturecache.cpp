@@ -0,0 +1,173 @@
+#include "texturecache.h"
+#include "meshcache.h"
+
+#include <filesystem>
+
+// Idle textures kept for reloads by default: a few models' worth of 2K maps.
+static const size_t defaultIdleBudget = 256 * 1024 * 1024;
+
+TextureCache::TextureCache()
+{
+	idleBudget = defaultIdleBudget;
+	releaseTick = 0;
+	numHits = 0;
+	numMisses = 0;
+	numEvictions = 0;
+}
+
+TextureCache::~TextureCache()
+{
+	// Runs at exit, after the GL context may be gone: the textures are left to the process
+	// teardown. Call EvictIdle while the context is current to free them earlier.
+}
+
+TextureCache& TextureCache::Shared()
+{
+	static TextureCache cache;
+	return cache;
+}
+
+// The canonical path, so "a/../b.png" and "b.png" match, plus the file stamp.
+std::string TextureCache::MakeKey(const std::string& filePath)
+{
+	std::error_code error;
+	std::filesystem::path canonical = std::filesystem::weakly_canonical(std::filesystem::path(filePath), error);
+	std::string key = error ? filePath : canonical.string();
+	uint64_t fileSize = 0;
+	int64_t modifiedTime = 0;
+	MeshCache::GetFileStamp(filePath, fileSize, modifiedTime);
+	key += '|' + std::to_string(fileSize) + '|' + std::to_string(modifiedTime);
+	return key;
+}
+
+ImageTexture* TextureCache::Acquire(const std::string& filePath)
+{
+	TextureRequest request(filePath, MakeKey(filePath), 1);
+	Request(request);
+	Decode(request);
+	return Resolve(request);
+}
+
+void TextureCache::Request(TextureRequest& request)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	auto it = entries.find(request.key);
+	if (it != entries.end()) {
+		it->second.refCount += request.numHandles;
+		numHits += request.numHandles;
+		request.texture = it->second.texture;
+		return;
+	}
+
+	//Miss: Reserve the Entry; Decode Fills It In
+	Entry& entry = entries[request.key];
+	entry.texture = nullptr;
+	entry.refCount = request.numHandles;
+	entry.lastRelease = 0;
+	numMisses++;
+	numHits += request.numHandles - 1;
+	request.decodeHere = true;
+}
+
+void TextureCache::Decode(TextureRequest& request)
+{
+	if (!request.decodeHere)
+		return;
+	ImageTexture* texture = new ImageTexture(request.filePath, true);
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		entries[request.key].texture = texture;
+		keys[texture] = request.key;
+	}
+	request.texture = texture;
+	request.decodeHere = false;
+	decodedCondition.notify_all();
+}
+
+ImageTexture* TextureCache::Resolve(TextureRequest& request)
+{
+	if (request.texture != nullptr)
+		return request.texture;
+	// Another load is decoding it; our handles keep the entry in place while we wait.
+	std::unique_lock<std::mutex> lock(cacheMutex);
+	Entry& entry = entries[request.key];
+	decodedCondition.wait(lock, [&entry]() { return entry.texture != nullptr; });
+	request.texture = entry.texture;
+	return request.texture;
+}
+
+void TextureCache::Release(ImageTexture* texture)
+{
+	if (texture == nullptr)
+		return;
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	auto keyIt = keys.find(texture);
+	if (keyIt == keys.end()) {
+		std::cerr << "[WARNING] Releasing a texture the cache does not own: " << texture->GetPath() << std::endl;
+		return;
+	}
+	Entry& entry = entries[keyIt->second];
+	if (--entry.refCount > 0)
+		return;
+	entry.lastRelease = ++releaseTick;
+	EvictIdleAbove(idleBudget);
+}
+
+void TextureCache::SetIdleBudget(const size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	idleBudget = bytes;
+	EvictIdleAbove(idleBudget);
+}
+
+void TextureCache::EvictIdle()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	EvictIdleAbove(0);
+}
+
+void TextureCache::EvictIdleAbove(const size_t budget)
+{
+	size_t idleBytes = 0;
+	for (const auto& element : entries) {
+		if (element.second.refCount == 0)
+			idleBytes += element.second.texture->GetResidentBytes();
+	}
+	// A budget of 0 also drops idle textures that hold no bytes (images that failed to load).
+	while (budget == 0 || idleBytes > budget) {
+		//Least Recently Released Idle Entry
+		auto oldest = entries.end();
+		for (auto it = entries.begin(); it != entries.end(); ++it) {
+			if (it->second.refCount == 0 && (oldest == entries.end() || it->second.lastRelease < oldest->second.lastRelease))
+				oldest = it;
+		}
+		if (oldest == entries.end())
+			break;
+		idleBytes -= oldest->second.texture->GetResidentBytes();
+		keys.erase(oldest->second.texture);
+		delete oldest->second.texture;
+		entries.erase(oldest);
+		numEvictions++;
+	}
+}
+
+TextureCacheStats TextureCache::GetStats()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	TextureCacheStats stats;
+	stats.numHits = numHits;
+	stats.numMisses = numMisses;
+	stats.numEvictions = numEvictions;
+	for (const auto& element : entries) {
+		if (element.second.texture == nullptr)
+			continue;
+		const size_t bytes = element.second.texture->GetResidentBytes();
+		stats.numTextures++;
+		stats.residentBytes += bytes;
+		if (element.second.refCount == 0) {
+			stats.numIdle++;
+			stats.idleBytes += bytes;
+		}
+	}
+	return stats;
+}
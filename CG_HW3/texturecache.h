@@ -0,0 +1,118 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include "headers.h"
+#include "imagetexture.h"
+
+#include <mutex>
+#include <condition_variable>
+
+// TextureCacheStats Declarations.
+struct TextureCacheStats
+{
+	TextureCacheStats() {
+		numHits = 0;
+		numMisses = 0;
+		numEvictions = 0;
+		numTextures = 0;
+		numIdle = 0;
+		residentBytes = 0;
+		idleBytes = 0;
+	}
+	int numHits;				// Acquires served without decoding (since start).
+	int numMisses;				// Acquires that decoded the image.
+	int numEvictions;			// Textures deleted after their last release.
+	int numTextures;			// Cached now, idle ones included.
+	int numIdle;				// Cached with no handle out, kept for a later reload.
+	size_t residentBytes;		// Decoded pixels plus GPU storage (mipmaps included) of every cached texture.
+	size_t idleBytes;			// The part of residentBytes held by idle textures.
+};
+
+// TextureRequest Declarations.
+// One image of a load going through TextureCache::Request, Decode and Resolve.
+struct TextureRequest
+{
+	TextureRequest(const std::string& path, const std::string& cacheKey, const int handles) {
+		filePath = path;
+		key = cacheKey;
+		numHandles = handles;
+		decodeHere = false;
+		texture = nullptr;
+	}
+
+	std::string filePath;
+	std::string key;			// From TextureCache::MakeKey.
+	int numHandles;				// Handles taken, one per Release the caller will make.
+	bool decodeHere;			// Set by Request when the image is this request's to decode.
+	ImageTexture* texture;		// Set once the image is decoded.
+};
+
+// TextureCache Declarations.
+// Hands out shared ImageTextures keyed by canonical path, file size and modification time, so
+// materials naming the same image share one texture and an edited file is decoded again.
+// Textures are reference counted: a texture whose last handle is released goes idle, and idle
+// ones are evicted least recently used first once they hold more than the idle budget. With a
+// budget of 0 a texture is deleted on its last release.
+class TextureCache
+{
+public:
+	// TextureCache Public Methods.
+	TextureCache();
+	~TextureCache();
+
+	// Texture for filePath, decoded (not uploaded) on a miss. Safe on any thread; concurrent
+	// acquires of the same image wait for one decode, so do not call it from tasks that the
+	// decoding thread may wait on. Loads decoding on the pool use the three steps below.
+	ImageTexture* Acquire(const std::string& filePath);
+
+	// Acquire split so that no pool task waits on another: Request takes the handles and, on a
+	// miss, reserves the entry for this request to decode. Decode does that (a no-op for the
+	// others) and never waits, so it can run in a ParallelFor. Resolve waits for images another
+	// load is still decoding; call it after every Decode of the load has returned. The requests
+	// of one load must have distinct keys.
+	void Request(TextureRequest& request);
+	void Decode(TextureRequest& request);
+	ImageTexture* Resolve(TextureRequest& request);
+
+	// Cache key of filePath: its canonical path, size and modification time.
+	static std::string MakeKey(const std::string& filePath);
+	// Drop a handle from Acquire. Evicting deletes the GL texture, so call on the GL thread.
+	void Release(ImageTexture* texture);
+
+	void SetIdleBudget(const size_t bytes);
+	size_t GetIdleBudget() const { return idleBudget; }
+	// Delete every idle texture (GL thread).
+	void EvictIdle();
+
+	TextureCacheStats GetStats();
+
+	// Process-wide cache shared by every mesh.
+	static TextureCache& Shared();
+
+private:
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	// TextureCache Private Methods.
+	// Evict idle entries, oldest first, until they fit budget; the caller holds cacheMutex.
+	void EvictIdleAbove(const size_t budget);
+
+	// TextureCache Private Data.
+	struct Entry
+	{
+		ImageTexture* texture;		// nullptr while the first acquire is decoding it.
+		int refCount;
+		uint64_t lastRelease;		// Release tick that made it idle, for the LRU order.
+	};
+	std::map<std::string, Entry> entries;
+	std::map<const ImageTexture*, std::string> keys;
+	std::mutex cacheMutex;
+	std::condition_variable decodedCondition;
+	size_t idleBudget;
+	uint64_t releaseTick;
+	int numHits;
+	int numMisses;
+	int numEvictions;
+};
+
+#endif
@@ -0,0 +1,557 @@
+#include "texturecompressor.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define COMPRESSOR_USE_SSE
+#endif
+
+// Share of the second endpoint for each index: BC1 colors, then BC7's 4-bit weights (out of 64).
+static const float bc1Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+static const int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// The 16 pixels of one block, a row of each channel (0-255) for the four-wide palette search.
+struct BlockPixels
+{
+	float channels[4][16];
+};
+
+static void LoadBlock(const unsigned char* rgba, const int width, const int height, const size_t stride,
+	const int blockX, const int blockY, BlockPixels& block)
+{
+	for (int y = 0; y < 4; ++y) {
+		const unsigned char* row = rgba + (size_t)std::min(blockY * 4 + y, height - 1) * stride;
+		for (int x = 0; x < 4; ++x) {
+			const unsigned char* pixel = row + (size_t)std::min(blockX * 4 + x, width - 1) * 4;
+			for (int c = 0; c < 4; ++c)
+				block.channels[c][y * 4 + x] = (float)pixel[c];
+		}
+	}
+}
+
+// Nearest palette entry of every pixel over channels firstChannel..firstChannel + numChannels - 1;
+// returns the summed squared error.
+static float SelectIndices(const BlockPixels& block, const int firstChannel, const int numChannels,
+	const float palette[][4], const int numColors, unsigned char indices[16])
+{
+	float error = 0.0f;
+#ifdef COMPRESSOR_USE_SSE
+	for (int i = 0; i < 16; i += 4) {
+		__m128 channels[4];
+		for (int c = 0; c < numChannels; ++c)
+			channels[c] = _mm_loadu_ps(&block.channels[firstChannel + c][i]);
+		__m128 best = _mm_set1_ps(FLT_MAX);
+		__m128 bestIndex = _mm_setzero_ps();
+		for (int k = 0; k < numColors; ++k) {
+			__m128 distance = _mm_setzero_ps();
+			for (int c = 0; c < numChannels; ++c) {
+				const __m128 difference = _mm_sub_ps(channels[c], _mm_set1_ps(palette[k][firstChannel + c]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+			}
+			const __m128 closer = _mm_cmplt_ps(distance, best);
+			best = _mm_min_ps(distance, best);
+			bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps((float)k)), _mm_andnot_ps(closer, bestIndex));
+		}
+		float distances[4], chosen[4];
+		_mm_storeu_ps(distances, best);
+		_mm_storeu_ps(chosen, bestIndex);
+		for (int j = 0; j < 4; ++j) {
+			indices[i + j] = (unsigned char)chosen[j];
+			error += distances[j];
+		}
+	}
+#else
+	for (int i = 0; i < 16; ++i) {
+		float best = FLT_MAX;
+		for (int k = 0; k < numColors; ++k) {
+			float distance = 0.0f;
+			for (int c = firstChannel; c < firstChannel + numChannels; ++c) {
+				const float difference = block.channels[c][i] - palette[k][c];
+				distance += difference * difference;
+			}
+			if (distance < best) {
+				best = distance;
+				indices[i] = (unsigned char)k;
+			}
+		}
+		error += best;
+	}
+#endif
+	return error;
+}
+
+// Ends of the block's principal axis (through the mean, by power iteration on the covariance),
+// clipped to the extent of the pixels' projections on it.
+static void FindPrincipalAxis(const BlockPixels& block, const int firstChannel, const int numChannels, float endpoints[2][4])
+{
+	const int lastChannel = firstChannel + numChannels;
+	float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int c = firstChannel; c < lastChannel; ++c) {
+		float low = 255.0f, high = 0.0f;
+		for (int i = 0; i < 16; ++i) {
+			mean[c] += block.channels[c][i];
+			low = std::min(low, block.channels[c][i]);
+			high = std::max(high, block.channels[c][i]);
+		}
+		mean[c] /= 16.0f;
+		axis[c] = high - low;
+	}
+	float covariance[4][4] = {};
+	for (int i = 0; i < 16; ++i) {
+		for (int a = firstChannel; a < lastChannel; ++a) {
+			for (int b = firstChannel; b < lastChannel; ++b)
+				covariance[a][b] += (block.channels[a][i] - mean[a]) * (block.channels[b][i] - mean[b]);
+		}
+	}
+
+	//Power Iteration, Starting from the Channel Ranges
+	for (int iteration = 0; iteration < 8; ++iteration) {
+		float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float largest = 0.0f;
+		for (int a = firstChannel; a < lastChannel; ++a) {
+			for (int b = firstChannel; b < lastChannel; ++b)
+				next[a] += covariance[a][b] * axis[b];
+			largest = std::max(largest, std::abs(next[a]));
+		}
+		if (largest < 1e-6f)
+			break;
+		for (int c = firstChannel; c < lastChannel; ++c)
+			axis[c] = next[c] / largest;
+	}
+
+	float lengthSquared = 0.0f;
+	for (int c = firstChannel; c < lastChannel; ++c)
+		lengthSquared += axis[c] * axis[c];
+	float low = 0.0f, high = 0.0f;
+	if (lengthSquared > 1e-12f) {
+		low = FLT_MAX;
+		high = -FLT_MAX;
+		for (int i = 0; i < 16; ++i) {
+			float t = 0.0f;
+			for (int c = firstChannel; c < lastChannel; ++c)
+				t += (block.channels[c][i] - mean[c]) * axis[c];
+			low = std::min(low, t);
+			high = std::max(high, t);
+		}
+		low /= lengthSquared;
+		high /= lengthSquared;
+	}
+	for (int c = 0; c < 4; ++c) {
+		endpoints[0][c] = std::min(std::max(mean[c] + axis[c] * low, 0.0f), 255.0f);
+		endpoints[1][c] = std::min(std::max(mean[c] + axis[c] * high, 0.0f), 255.0f);
+	}
+}
+
+// Endpoints with the least squared error for fixed indices, weights[index] being the share of the
+// second one. False when every pixel uses the same blend, which leaves them undetermined.
+static bool SolveEndpoints(const BlockPixels& block, const int firstChannel, const int numChannels,
+	const unsigned char indices[16], const float* weights, float endpoints[2][4])
+{
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ap[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	float bp[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; ++i) {
+		const float b = weights[indices[i]];
+		const float a = 1.0f - b;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (int c = firstChannel; c < firstChannel + numChannels; ++c) {
+			ap[c] += a * block.channels[c][i];
+			bp[c] += b * block.channels[c][i];
+		}
+	}
+	const float determinant = aa * bb - ab * ab;
+	if (std::abs(determinant) < 1e-4f)
+		return false;
+	for (int c = firstChannel; c < firstChannel + numChannels; ++c) {
+		endpoints[0][c] = std::min(std::max((ap[c] * bb - bp[c] * ab) / determinant, 0.0f), 255.0f);
+		endpoints[1][c] = std::min(std::max((bp[c] * aa - ap[c] * ab) / determinant, 0.0f), 255.0f);
+	}
+	return true;
+}
+
+static uint16_t PackColor565(const float color[4])
+{
+	const int r = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+	const int g = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+	const int b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void UnpackColor565(const uint16_t packed, int color[3])
+{
+	const int r = (packed >> 11) & 31;
+	const int g = (packed >> 5) & 63;
+	const int b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+// Quantize a pair of endpoints to 5:6:5, pick each pixel's index, and return the error.
+static float EncodeColorEndpoints(const BlockPixels& block, const float endpoints[2][4], uint16_t packed[2], unsigned char indices[16])
+{
+	float palette[4][4] = {};
+	for (int e = 0; e < 2; ++e) {
+		int color[3];
+		packed[e] = PackColor565(endpoints[e]);
+		UnpackColor565(packed[e], color);
+		for (int c = 0; c < 3; ++c)
+			palette[e][c] = (float)color[c];
+	}
+	for (int c = 0; c < 3; ++c) {
+		palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+		palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+	}
+	return SelectIndices(block, 0, 3, palette, 4, indices);
+}
+
+// BC1 color block (also the color half of BC3), always in the four-color mode.
+static void EncodeColorBlock(const BlockPixels& block, unsigned char* out)
+{
+	float endpoints[2][4];
+	uint16_t packed[2];
+	unsigned char indices[16];
+	FindPrincipalAxis(block, 0, 3, endpoints);
+	float error = EncodeColorEndpoints(block, endpoints, packed, indices);
+
+	//Refit the Endpoints to the Chosen Indices, Keep Them If They Do Better
+	float refined[2][4];
+	uint16_t refinedPacked[2];
+	unsigned char refinedIndices[16];
+	if (error > 0.0f && SolveEndpoints(block, 0, 3, indices, bc1Weights, refined)) {
+		const float refinedError = EncodeColorEndpoints(block, refined, refinedPacked, refinedIndices);
+		if (refinedError < error) {
+			packed[0] = refinedPacked[0];
+			packed[1] = refinedPacked[1];
+			std::memcpy(indices, refinedIndices, sizeof(indices));
+		}
+	}
+
+	// Four colors need color0 > color1; swapping the ends swaps indices 0/1 and 2/3.
+	if (packed[0] < packed[1]) {
+		std::swap(packed[0], packed[1]);
+		for (int i = 0; i < 16; ++i)
+			indices[i] ^= 1;
+	}
+	else if (packed[0] == packed[1])
+		std::memset(indices, 0, sizeof(indices));
+	uint32_t bits = 0;
+	for (int i = 0; i < 16; ++i)
+		bits |= (uint32_t)indices[i] << (2 * i);
+	out[0] = (unsigned char)(packed[0] & 0xFF);
+	out[1] = (unsigned char)(packed[0] >> 8);
+	out[2] = (unsigned char)(packed[1] & 0xFF);
+	out[3] = (unsigned char)(packed[1] >> 8);
+	for (int b = 0; b < 4; ++b)
+		out[4 + b] = (unsigned char)(bits >> (8 * b));
+}
+
+// BC3 alpha block: the alpha range split into 8 steps.
+static void EncodeAlphaBlock(const BlockPixels& block, unsigned char* out)
+{
+	float low = 255.0f, high = 0.0f;
+	for (int i = 0; i < 16; ++i) {
+		low = std::min(low, block.channels[3][i]);
+		high = std::max(high, block.channels[3][i]);
+	}
+	const int alpha0 = (int)high;
+	const int alpha1 = (int)low;
+	unsigned char indices[16] = {};
+	if (alpha0 > alpha1) {
+		float palette[8][4] = {};
+		palette[0][3] = (float)alpha0;
+		palette[1][3] = (float)alpha1;
+		for (int k = 2; k < 8; ++k)
+			palette[k][3] = ((8 - k) * alpha0 + (k - 1) * alpha1) / 7.0f;
+		SelectIndices(block, 3, 1, palette, 8, indices);
+	}
+	uint64_t bits = 0;
+	for (int i = 0; i < 16; ++i)
+		bits |= (uint64_t)indices[i] << (3 * i);
+	out[0] = (unsigned char)alpha0;
+	out[1] = (unsigned char)alpha1;
+	for (int b = 0; b < 6; ++b)
+		out[2 + b] = (unsigned char)(bits >> (8 * b));
+}
+
+// BC7 mode 6 endpoint: 7 bits per channel plus a shared low bit, whichever bit lands closer.
+static void QuantizeBc7Endpoint(const float endpoint[4], int quantized[4], int& pBit)
+{
+	float bestError = FLT_MAX;
+	for (int p = 0; p < 2; ++p) {
+		int candidate[4];
+		float error = 0.0f;
+		for (int c = 0; c < 4; ++c) {
+			candidate[c] = std::min(std::max((int)std::floor((endpoint[c] - p) / 2.0f + 0.5f), 0), 127);
+			const float difference = (float)(candidate[c] * 2 + p) - endpoint[c];
+			error += difference * difference;
+		}
+		if (error < bestError) {
+			bestError = error;
+			pBit = p;
+			std::memcpy(quantized, candidate, sizeof(candidate));
+		}
+	}
+}
+
+static float EncodeBc7Endpoints(const BlockPixels& block, const float endpoints[2][4], int quantized[2][4], int pBits[2], unsigned char indices[16])
+{
+	int ends[2][4];
+	for (int e = 0; e < 2; ++e) {
+		QuantizeBc7Endpoint(endpoints[e], quantized[e], pBits[e]);
+		for (int c = 0; c < 4; ++c)
+			ends[e][c] = quantized[e][c] * 2 + pBits[e];
+	}
+	float palette[16][4];
+	for (int k = 0; k < 16; ++k) {
+		for (int c = 0; c < 4; ++c)
+			palette[k][c] = (float)(((64 - bc7Weights[k]) * ends[0][c] + bc7Weights[k] * ends[1][c] + 32) >> 6);
+	}
+	return SelectIndices(block, 0, 4, palette, 16, indices);
+}
+
+static void WriteBits(unsigned char* block, int& position, const uint32_t value, const int numBits)
+{
+	for (int b = 0; b < numBits; ++b, ++position) {
+		if ((value >> b) & 1)
+			block[position >> 3] |= (unsigned char)(1 << (position & 7));
+	}
+}
+
+static uint32_t ReadBits(const unsigned char* block, int& position, const int numBits)
+{
+	uint32_t value = 0;
+	for (int b = 0; b < numBits; ++b, ++position)
+		value |= (uint32_t)((block[position >> 3] >> (position & 7)) & 1) << b;
+	return value;
+}
+
+static void EncodeBc7Block(const BlockPixels& block, unsigned char* out)
+{
+	float endpoints[2][4];
+	int quantized[2][4];
+	int pBits[2];
+	unsigned char indices[16];
+	FindPrincipalAxis(block, 0, 4, endpoints);
+	float error = EncodeBc7Endpoints(block, endpoints, quantized, pBits, indices);
+
+	//Refit the Endpoints to the Chosen Indices, Keep Them If They Do Better
+	float weights[16];
+	for (int k = 0; k < 16; ++k)
+		weights[k] = bc7Weights[k] / 64.0f;
+	float refined[2][4];
+	int refinedQuantized[2][4];
+	int refinedPBits[2];
+	unsigned char refinedIndices[16];
+	if (error > 0.0f && SolveEndpoints(block, 0, 4, indices, weights, refined)) {
+		const float refinedError = EncodeBc7Endpoints(block, refined, refinedQuantized, refinedPBits, refinedIndices);
+		if (refinedError < error) {
+			std::memcpy(quantized, refinedQuantized, sizeof(quantized));
+			std::memcpy(pBits, refinedPBits, sizeof(pBits));
+			std::memcpy(indices, refinedIndices, sizeof(indices));
+		}
+	}
+
+	// The first index is stored with 3 bits, so its high bit must be 0: swap the ends if not.
+	if (indices[0] >= 8) {
+		for (int c = 0; c < 4; ++c)
+			std::swap(quantized[0][c], quantized[1][c]);
+		std::swap(pBits[0], pBits[1]);
+		for (int i = 0; i < 16; ++i)
+			indices[i] = (unsigned char)(15 - indices[i]);
+	}
+	std::memset(out, 0, 16);
+	int position = 0;
+	WriteBits(out, position, 1 << 6, 7);
+	for (int c = 0; c < 4; ++c) {
+		WriteBits(out, position, quantized[0][c], 7);
+		WriteBits(out, position, quantized[1][c], 7);
+	}
+	WriteBits(out, position, pBits[0], 1);
+	WriteBits(out, position, pBits[1], 1);
+	for (int i = 0; i < 16; ++i)
+		WriteBits(out, position, indices[i], (i == 0) ? 3 : 4);
+}
+
+static void DecodeColorBlock(const unsigned char* in, const bool fourColors, unsigned char pixels[16][4])
+{
+	const uint16_t packed0 = (uint16_t)(in[0] | (in[1] << 8));
+	const uint16_t packed1 = (uint16_t)(in[2] | (in[3] << 8));
+	int palette[4][4];
+	UnpackColor565(packed0, palette[0]);
+	UnpackColor565(packed1, palette[1]);
+	palette[0][3] = 255;
+	palette[1][3] = 255;
+	for (int c = 0; c < 3; ++c) {
+		if (fourColors || packed0 > packed1) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		else {
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = (fourColors || packed0 > packed1) ? 255 : 0;
+	const uint32_t bits = (uint32_t)in[4] | ((uint32_t)in[5] << 8) | ((uint32_t)in[6] << 16) | ((uint32_t)in[7] << 24);
+	for (int i = 0; i < 16; ++i) {
+		for (int c = 0; c < 4; ++c)
+			pixels[i][c] = (unsigned char)palette[(bits >> (2 * i)) & 3][c];
+	}
+}
+
+static void DecodeAlphaBlock(const unsigned char* in, unsigned char pixels[16][4])
+{
+	const int alpha0 = in[0];
+	const int alpha1 = in[1];
+	int palette[8] = { alpha0, alpha1, 0, 0, 0, 0, 0, 255 };
+	if (alpha0 > alpha1) {
+		for (int k = 2; k < 8; ++k)
+			palette[k] = ((8 - k) * alpha0 + (k - 1) * alpha1) / 7;
+	}
+	else {
+		for (int k = 2; k < 6; ++k)
+			palette[k] = ((6 - k) * alpha0 + (k - 1) * alpha1) / 5;
+	}
+	uint64_t bits = 0;
+	for (int b = 0; b < 6; ++b)
+		bits |= (uint64_t)in[2 + b] << (8 * b);
+	for (int i = 0; i < 16; ++i)
+		pixels[i][3] = (unsigned char)palette[(bits >> (3 * i)) & 7];
+}
+
+static void DecodeBc7Block(const unsigned char* in, unsigned char pixels[16][4])
+{
+	std::memset(pixels, 0, 16 * 4);
+	if ((in[0] & 0x7F) != 0x40)
+		return;
+	int position = 7;
+	int ends[2][4];
+	for (int c = 0; c < 4; ++c) {
+		ends[0][c] = (int)ReadBits(in, position, 7) << 1;
+		ends[1][c] = (int)ReadBits(in, position, 7) << 1;
+	}
+	const int pBit0 = (int)ReadBits(in, position, 1);
+	const int pBit1 = (int)ReadBits(in, position, 1);
+	for (int c = 0; c < 4; ++c) {
+		ends[0][c] |= pBit0;
+		ends[1][c] |= pBit1;
+	}
+	for (int i = 0; i < 16; ++i) {
+		const int weight = bc7Weights[ReadBits(in, position, (i == 0) ? 3 : 4)];
+		for (int c = 0; c < 4; ++c)
+			pixels[i][c] = (unsigned char)(((64 - weight) * ends[0][c] + weight * ends[1][c] + 32) >> 6);
+	}
+}
+
+size_t TextureCompressor::GetBlockBytes(const BlockFormat format)
+{
+	return (format == BLOCK_FORMAT_BC1) ? 8 : 16;
+}
+
+size_t TextureCompressor::GetCompressedSize(const BlockFormat format, const int width, const int height)
+{
+	return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * GetBlockBytes(format);
+}
+
+void TextureCompressor::Compress(const unsigned char* rgba, const int width, const int height, const size_t stride,
+	const BlockFormat format, unsigned char* blocks, const int numThreads)
+{
+	const int blocksWide = (width + 3) / 4;
+	const int blocksHigh = (height + 3) / 4;
+	const size_t blockBytes = GetBlockBytes(format);
+	auto encodeRow = [&](int blockY) {
+		BlockPixels block;
+		unsigned char* out = blocks + (size_t)blockY * blocksWide * blockBytes;
+		for (int blockX = 0; blockX < blocksWide; ++blockX, out += blockBytes) {
+			LoadBlock(rgba, width, height, stride, blockX, blockY, block);
+			switch (format) {
+			case BLOCK_FORMAT_BC1:
+				EncodeColorBlock(block, out);
+				break;
+			case BLOCK_FORMAT_BC3:
+				EncodeAlphaBlock(block, out);
+				EncodeColorBlock(block, out + 8);
+				break;
+			case BLOCK_FORMAT_BC7:
+				EncodeBc7Block(block, out);
+				break;
+			}
+		}
+	};
+	if (numThreads != 1 && blocksHigh > 1)
+		ThreadPool::Shared().ParallelFor(blocksHigh, encodeRow);
+	else {
+		for (int blockY = 0; blockY < blocksHigh; ++blockY)
+			encodeRow(blockY);
+	}
+}
+
+void TextureCompressor::Decompress(const unsigned char* blocks, const int width, const int height,
+	const BlockFormat format, unsigned char* rgba)
+{
+	const int blocksWide = (width + 3) / 4;
+	const int blocksHigh = (height + 3) / 4;
+	const size_t blockBytes = GetBlockBytes(format);
+	unsigned char pixels[16][4];
+	for (int blockY = 0; blockY < blocksHigh; ++blockY) {
+		for (int blockX = 0; blockX < blocksWide; ++blockX, blocks += blockBytes) {
+			switch (format) {
+			case BLOCK_FORMAT_BC1:
+				DecodeColorBlock(blocks, false, pixels);
+				break;
+			case BLOCK_FORMAT_BC3:
+				DecodeColorBlock(blocks + 8, true, pixels);
+				DecodeAlphaBlock(blocks, pixels);
+				break;
+			case BLOCK_FORMAT_BC7:
+				DecodeBc7Block(blocks, pixels);
+				break;
+			}
+			//Copy the Part of the Block Inside the Image
+			for (int y = 0; y < 4 && blockY * 4 + y < height; ++y) {
+				for (int x = 0; x < 4 && blockX * 4 + x < width; ++x)
+					std::memcpy(rgba + ((size_t)(blockY * 4 + y) * width + blockX * 4 + x) * 4, pixels[y * 4 + x], 4);
+			}
+		}
+	}
+}
+
+void TextureCompressor::CompressMipChain(const unsigned char* rgba, const int width, const int height,
+	const BlockFormat format, const MipFilter filter, CompressedImage& image, const int numThreads)
+{
+	std::vector<MipLevel> mipLevels;
+	MipBuilder::Build(rgba, width, height, (size_t)width * 4, 4, filter, mipLevels, numThreads);
+	image.format = format;
+	image.width = width;
+	image.height = height;
+	image.levels.clear();
+
+	//Lay Out Every Level First, So the Buffer Is Allocated Once
+	size_t totalSize = 0;
+	for (size_t l = 0; l <= mipLevels.size(); ++l) {
+		CompressedLevel level;
+		level.width = (l == 0) ? width : mipLevels[l - 1].width;
+		level.height = (l == 0) ? height : mipLevels[l - 1].height;
+		level.offset = totalSize;
+		level.size = GetCompressedSize(format, level.width, level.height);
+		image.levels.push_back(level);
+		totalSize += level.size;
+	}
+	image.data.resize(totalSize);
+
+	for (size_t l = 0; l < image.levels.size(); ++l) {
+		const CompressedLevel& level = image.levels[l];
+		const unsigned char* pixels = (l == 0) ? rgba : mipLevels[l - 1].pixels.data();
+		Compress(pixels, level.width, level.height, (size_t)level.width * 4, format, image.data.data() + level.offset, numThreads);
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef TEXTURE_COMPRESSOR_H
+#define TEXTURE_COMPRESSOR_H
+
+#include "mipbuilder.h"
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Block-compressed formats; all of them store 4x4 pixel blocks.
+enum BlockFormat
+{
+	BLOCK_FORMAT_BC1,			// 8 bytes per block, RGB (4 bits per pixel).
+	BLOCK_FORMAT_BC3,			// 16 bytes per block, BC1 color plus interpolated alpha (8 bits per pixel).
+	BLOCK_FORMAT_BC7			// 16 bytes per block, RGBA at higher quality (8 bits per pixel).
+};
+
+// CompressedLevel Declarations.
+struct CompressedLevel
+{
+	int width;
+	int height;
+	size_t offset;				// Into CompressedImage::data.
+	size_t size;
+};
+
+// CompressedImage Declarations.
+// A block-compressed mip chain, level 0 first and 1x1 last, all levels in one buffer.
+// Rows are stored bottom-up like the GL texture they are uploaded to.
+struct CompressedImage
+{
+	CompressedImage() {
+		format = BLOCK_FORMAT_BC1;
+		width = 0;
+		height = 0;
+	}
+	bool IsEmpty() const { return data.empty(); }
+
+	BlockFormat format;
+	int width;
+	int height;
+	std::vector<CompressedLevel> levels;
+	std::vector<unsigned char> data;
+};
+
+// TextureCompressor Declarations.
+// CPU encoder for BC1, BC3 and BC7 blocks. Endpoints come from the principal axis of each block,
+// refined by a least squares pass; the palette search runs four pixels at a time with SSE. BC7
+// blocks are all written in mode 6 (one RGBA subset, 4-bit indices). No GL calls, so it is safe
+// on any thread.
+class TextureCompressor
+{
+public:
+	// TextureCompressor Public Methods.
+	static size_t GetBlockBytes(const BlockFormat format);
+	static size_t GetCompressedSize(const BlockFormat format, const int width, const int height);
+
+	// Encode a width x height RGBA8 image whose rows are stride bytes apart. Blocks on the right and
+	// top edges repeat the last column and row. numThreads: 1 encodes serially, anything else
+	// splits the rows of blocks over the shared pool.
+	static void Compress(const unsigned char* rgba, const int width, const int height, const size_t stride,
+		const BlockFormat format, unsigned char* blocks, const int numThreads = 1);
+	// Decode back to tightly packed RGBA8. For BC7 only mode 6 blocks (the ones Compress writes)
+	// are supported; other modes decode to transparent black.
+	static void Decompress(const unsigned char* blocks, const int width, const int height,
+		const BlockFormat format, unsigned char* rgba);
+
+	// Encode a tightly packed RGBA8 image and its mip chain down to 1x1, the levels built by
+	// MipBuilder with filter.
+	static void CompressMipChain(const unsigned char* rgba, const int width, const int height,
+		const BlockFormat format, const MipFilter filter, CompressedImage& image, const int numThreads = 1);
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(const int numThreads)
+{
+	stopping = false;
+	taskHead = 0;
+	numTasks = 0;
+	for (int i = 0; i < std::max(numThreads, 1); ++i)
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+	queueCondition.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+	static ThreadPool pool((int)std::thread::hardware_concurrency() - 1);
+	return pool;
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		PushTask(Task{std::move(task), nullptr});
+	}
+	queueCondition.notify_one();
+}
+
+void ThreadPool::PushTask(Task&& task, const bool urgent)
+{
+	//Full Ring: Grow It, Unrolled So the Oldest Task Is First Again
+	if (numTasks == tasks.size()) {
+		std::vector<Task> grown(std::max<size_t>(16, tasks.size() * 2));
+		for (size_t i = 0; i < numTasks; ++i)
+			grown[i] = std::move(tasks[(taskHead + i) % tasks.size()]);
+		tasks.swap(grown);
+		taskHead = 0;
+	}
+	if (urgent) {
+		taskHead = (taskHead + tasks.size() - 1) % tasks.size();
+		tasks[taskHead] = std::move(task);
+	}
+	else
+		tasks[(taskHead + numTasks) % tasks.size()] = std::move(task);
+	numTasks++;
+}
+
+ThreadPool::Task ThreadPool::PopTask()
+{
+	Task task = std::move(tasks[taskHead]);
+	tasks[taskHead] = Task{nullptr, nullptr};
+	taskHead = (taskHead + 1) % tasks.size();
+	numTasks--;
+	return task;
+}
+
+// Loop shared by ParallelFor and its helpers. It lives on the caller's stack, so the caller
+// also waits for every started helper to let go of it, not only for the indices to finish.
+struct ParallelLoop
+{
+	std::atomic<int> next;
+	std::atomic<int> remaining;
+	std::atomic<int> activeHelpers;
+	const std::function<void(int)>* body;
+	int count;
+
+	void RunIndices() {
+		int index;
+		while ((index = next.fetch_add(1)) < count) {
+			(*body)(index);
+			remaining.fetch_sub(1);
+		}
+	}
+};
+
+void ThreadPool::ParallelFor(const int count, const std::function<void(int)>& body)
+{
+	if (count <= 0)
+		return;
+	if (count == 1) {
+		body(0);
+		return;
+	}
+
+	const int numHelpers = std::min(count - 1, GetNumThreads());
+	ParallelLoop loop;
+	loop.next = 0;
+	loop.remaining = count;
+	loop.activeHelpers = numHelpers;
+	loop.body = &body;
+	loop.count = count;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		for (int i = 0; i < numHelpers; ++i)
+			PushTask(Task{nullptr, &loop}, true);
+	}
+	queueCondition.notify_all();
+
+	loop.RunIndices();
+
+	//Withdraw the Helpers No Worker Has Picked Up Yet
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		for (size_t i = 0; i < numTasks; ++i) {
+			Task& task = tasks[(taskHead + i) % tasks.size()];
+			if (task.loop == &loop) {
+				task.loop = nullptr;
+				loop.activeHelpers.fetch_sub(1);
+			}
+		}
+	}
+
+	// The started helpers are running indices of this loop (or about to find none left).
+	while (loop.remaining.load() > 0 || loop.activeHelpers.load() > 0)
+		std::this_thread::yield();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	for (;;) {
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this]() { return stopping || numTasks != 0; });
+			if (stopping && numTasks == 0)
+				return;
+			task = PopTask();
+		}
+		if (task.loop) {
+			task.loop->RunIndices();
+			task.loop->activeHelpers.fetch_sub(1);
+		}
+		else if (task.function)
+			task.function();
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+struct ParallelLoop;
+
+// ThreadPool Declarations.
+// Fixed set of worker threads fed from one FIFO task queue.
+class ThreadPool
+{
+public:
+	// ThreadPool Public Methods.
+	ThreadPool(const int numThreads);
+	~ThreadPool();
+
+	// Queue a task and return immediately.
+	void Submit(std::function<void()> task);
+	// Run body(0) ... body(count - 1) on the workers and the calling thread; returns when all are done.
+	// The calling thread only ever runs this loop's indices, never other queued tasks, and helpers
+	// still queued once it runs out of indices are withdrawn rather than waited for. So the caller
+	// is never held up by unrelated work, and calling it from inside a task cannot deadlock.
+	// Helpers go to the front of the queue, so per-frame loops get the next free worker ahead of
+	// any background backlog.
+	// Does not allocate once the queue has grown to its working size (body itself aside).
+	void ParallelFor(const int count, const std::function<void(int)>& body);
+
+	int GetNumThreads() const { return (int)workers.size(); }
+
+	// Process-wide pool sized to the hardware (hardware threads - 1 workers, at least one).
+	static ThreadPool& Shared();
+
+private:
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// A queued task: either a submitted function or a ParallelFor helper joining loop. A helper
+	// withdrawn by its ParallelFor is left in the queue with neither set.
+	struct Task
+	{
+		std::function<void()> function;
+		ParallelLoop* loop;
+	};
+
+	// ThreadPool Private Methods.
+	void WorkerLoop();
+	// Queue access; the caller holds queueMutex.
+	void PushTask(Task&& task, const bool urgent = false);
+	Task PopTask();
+
+	// ThreadPool Private Data.
+	std::vector<std::thread> workers;
+	// Pending tasks in a ring buffer that keeps its storage between submits.
+	std::vector<Task> tasks;
+	size_t taskHead;
+	size_t numTasks;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	bool stopping;
+};
+
+#endif
@@ -1,341 +1,1951 @@
-#include "trianglemesh.h"
-
-// Constructor of a triangle mesh.
-TriangleMesh::TriangleMesh()
-{
-	numVertices = 0;
-	numTriangles = 0;
-	objCenter = glm::vec3(0.0f, 0.0f, 0.0f);
-	objExtent = glm::vec3(0.0f, 0.0f, 0.0f);
-	vboId = 0;
-}
-
-// Destructor of a triangle mesh.
-TriangleMesh::~TriangleMesh()
-{
-	vertices.clear();
-	materialMap.clear();
-	vertexIdMap.clear();
-	for (auto element : subMeshes) {
-		glDeleteBuffers(1, &(element.iboId));
-		element.vertexIndices.clear();
-	}
-	glDeleteBuffers(1, &vboId);
-}
-
-// Load the geometry and material data from an OBJ file.
-bool TriangleMesh::LoadFromFile(const std::string& filePath, const bool normalized)
-{
-	//Find Object Name
-	std::stringstream ss(filePath);
-	std::string item;
-	std::vector<std::string> elements;
-	while (std::getline(ss, item, '/')) {
-		elements.push_back(item);
-	}
-	std::string objectName = elements.back();
-
-	//Some space to Store Loaded Data
-	std::vector<glm::vec3> positions = {};
-	std::vector<glm::vec2> textures = {};
-	std::vector<glm::vec3> normals = {};
-
-	//For Finding Bounded Box
-	float maxX = FLT_MIN, maxY = FLT_MIN, maxZ = FLT_MIN;
-	float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
-
-	//For Current Face Material Record
-	PhongMaterial* phongMaterial = nullptr;
-
-	//For Current SubMesh Record
-	SubMesh* subMesh = nullptr;
-
-	//Open File refer to filePath
-	std::ifstream inputFile(filePath + '/' + objectName + ".obj");
-	if (inputFile.is_open()) {
-		std::cout << "Obj File Open Successful" << std::endl;
-		std::string line;
-		std::string head;
-		//Read File Line by Line
-		std::cout << "Obj File Loading..." << std::endl;
-		while (getline(inputFile, line)) {
-			if (line.empty())continue;
-
-			std::stringstream ss(line);
-			ss >> head;
-
-			//Dealing read Information
-			if (head == "v") {
-				//Collect Vertex Position Info
-				glm::vec3 position;
-				ss >> position.x >> position.y >> position.z;
-
-				positions.push_back(position);
-
-				//Check Bouned Box Coordinates
-				//Check X
-				if (position.x > maxX) maxX = position.x;
-				if (position.x < minX) minX = position.x;
-
-				//check Y
-				if (position.y > maxY) maxY = position.y;
-				if (position.y < minY) minY = position.y;
-
-				//check Z
-				if (position.z > maxZ) maxZ = position.z;
-				if (position.z < minZ) minZ = position.z;
-
-			}
-			else if (head == "vt") {
-				//Collect Vertex Texture Coordinates Info
-				glm::vec2 texture;
-				ss >> texture.x >> texture.y;
-
-				textures.push_back(texture);
-			}
-			else if (head == "vn") {
-				//Collect Vertex Normal Info
-				glm::vec3 normal;
-				ss >> normal.x >> normal.y >> normal.z;
-
-				normals.push_back(normal);
-			}
-			else if (head == "mtllib") {
-				ss >> head;
-				LoadMtlFile(filePath + "/" + head, filePath);
-			}
-			else if (head == "usemtl") {
-				// Push SubMesh to SubMeshes
-				if (subMesh != nullptr) {
-					subMeshes.push_back(*subMesh);
-				}
-
-				// Find Material Refer to Material Map
-				std::string mtlFlag;
-				ss >> mtlFlag;
-				phongMaterial = &materialMap[mtlFlag];
-				subMesh = new SubMesh();
-				subMesh->material = phongMaterial;
-			}
-			else if (head == "f") {
-				//Dealing Face Data One by One (in one file line)
-				int forPolygonCheck = 0;
-				unsigned firstIndex, lastIndex;
-				std::string fData;
-				while (ss >> fData) {
-					std::stringstream sfData(fData);
-					int pIndex, tIndex, nIndex;
-					char slash;
-					int index;
-
-					sfData >> pIndex >> slash >> tIndex >> slash >> nIndex;
-
-					//Build Vertex Information
-					VertexPTN vertex = VertexPTN(positions[pIndex - 1],
-						normals[nIndex - 1],
-						textures[tIndex - 1]);
-
-					if (vertexIdMap[fData] != NULL) {
-						index = vertexIdMap[fData];
-					}
-					else {
-						index = numVertices;
-						vertexIdMap[fData] = numVertices;
-						//Add New Vertex to vertices
-						numVertices++;
-						vertices.push_back(vertex);
-					}
-
-					forPolygonCheck++;
-					//Add index to vertexIndices
-					switch (forPolygonCheck) {
-					case 1:
-						firstIndex = index;
-						break;
-					case 2:
-						lastIndex = index;
-						break;
-					default:
-						subMesh->vertexIndices.push_back(firstIndex);
-						subMesh->vertexIndices.push_back(lastIndex);
-						subMesh->vertexIndices.push_back(index);
-						lastIndex = index;
-						numTriangles++;
-					}
-				}
-			}
-			else continue;
-		}
-
-		// Push The Last SubMesh to SubMeshes
-		if (subMesh != nullptr) {
-			subMeshes.push_back(*subMesh);
-		}
-
-		inputFile.close();
-		std::cout << "Obj File Loaging Finished" << std::endl;
-	}
-	else std::cout << "Obj File Open Failed" << std::endl;
-
-
-	if (normalized) {
-		// Normalize the geometry data.	
-
-		std::cout << "Vertex Normalizing..." << std::endl;
-		//Translate to Center
-		glm::vec3 centerCoordinate = { (maxX + minX) / 2,
-									   (maxY + minY) / 2,
-									   (maxZ + minZ) / 2 };
-
-		for (unsigned int i = 0; i < GetNumVertices(); i++) {
-			vertices[i].position -= centerCoordinate;
-		}
-
-		//Normalize Longest Axis to One
-		float xAxis = std::abs(maxX - minX);
-		float yAxis = std::abs(maxY - minY);
-		float zAxis = std::abs(maxZ - minZ);
-		float longestAxis;
-		if (xAxis >= yAxis && xAxis >= zAxis) longestAxis = xAxis;
-		if (yAxis >= xAxis && yAxis >= zAxis) longestAxis = yAxis;
-		if (zAxis >= yAxis && zAxis >= xAxis) longestAxis = zAxis;
-
-		for (unsigned int i = 0; i < numVertices; i++)
-			vertices[i].position /= longestAxis;
-
-
-		objCenter = centerCoordinate;
-		objExtent = glm::vec3(xAxis / longestAxis, yAxis / longestAxis, zAxis / longestAxis);
-	}
-	std::cout << "Vertex Normalizing Finished" << std::endl;
-
-	return true;
-
-	return true;
-}
-
-bool TriangleMesh::LoadMtlFile(const std::string& filePath, const std::string& folderPath) {
-	//Open File refer to filePath
-	std::ifstream inputFile(filePath);
-	if (inputFile.is_open()) {
-		std::cout << "Mtl File Open Successful" << std::endl;
-		std::string line;
-		std::string head;
-		//Read File Line by Line
-		std::cout << "Mtl File Loading..." << std::endl;
-		while (getline(inputFile, line)) {
-			std::stringstream ss(line);
-			ss >> head;
-
-			if (head == "newmtl") {
-				std::string flag;
-				std::string element;
-				ss >> flag;
-
-				// Initila PhongMaterial
-				PhongMaterial newMaterial;
-				newMaterial.SetName(flag);
-
-				// Read Ns, Kd, Kd, Ks, map_Kd Line by Line
-				for (int i = 0; i < 5; i++) {
-					getline(inputFile, line);
-					std::stringstream ss(line);
-					ss >> head;
-
-					if (head == "Ns") {
-						float Ns;
-						ss >> Ns;
-						newMaterial.SetNs(Ns);
-					}
-					else if (head == "Ka") {
-						float Ka1, Ka2, Ka3;
-						ss >> Ka1 >> Ka2 >> Ka3;
-						glm::vec3 Ka(Ka1, Ka2, Ka3);
-						newMaterial.SetKa(Ka);
-					}
-					else if (head == "Kd") {
-						float Kd1, Kd2, Kd3;
-						ss >> Kd1 >> Kd2 >> Kd3;
-						glm::vec3 Kd(Kd1, Kd2, Kd3);
-						newMaterial.SetKd(Kd);
-					}
-					else if (head == "Ks") {
-						float Ks1, Ks2, Ks3;
-						ss >> Ks1 >> Ks2 >> Ks3;
-						glm::vec3 Ks(Ks1, Ks2, Ks3);
-						newMaterial.SetKs(Ks);
-					}
-					else if (head == "map_Kd") {
-						std::string imageFile;
-						ss >> imageFile;
-						newMaterial.SetMapKd(new ImageTexture(folderPath + '/' + imageFile));
-					}
-				}
-
-				// Add New Material To Material Map
-				materialMap[flag] = newMaterial;
-			}
-			else continue;
-		}
-
-		std::cout << "Mtl File Loaging Finished" << std::endl;
-		return true;
-	}
-	else {
-		std::cout << "Mtl File Open Failed" << std::endl;
-		return false;
-	}
-}
-
-// Show model information.
-void TriangleMesh::ShowInfo()
-{
-	std::cout << "# Vertices: " << numVertices << std::endl;
-	std::cout << "# Triangles: " << numTriangles << std::endl;
-	std::cout << "Total " << subMeshes.size() << " subMeshes loaded" << std::endl;
-	for (unsigned int i = 0; i < subMeshes.size(); ++i) {
-		const SubMesh& g = subMeshes[i];
-		std::cout << "SubMesh " << i << " with material: " << g.material->GetName() << std::endl;
-		std::cout << "Num. triangles in the subMesh: " << g.vertexIndices.size() / 3 << std::endl;
-	}
-	std::cout << "Model Center: " << objCenter.x << ", " << objCenter.y << ", " << objCenter.z << std::endl;
-	std::cout << "Model Extent: " << objExtent.x << " x " << objExtent.y << " x " << objExtent.z << std::endl;
-}
-
-// Create Vertex and Index Buffer
-void TriangleMesh::CreateBuffer() {
-	// Create Vertex Buffer
-	glGenBuffers(1, &vboId);
-	glBindBuffer(GL_ARRAY_BUFFER, vboId);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexPTN) * numVertices, vertices.data(), GL_STATIC_DRAW);
-
-	// Create index Buffer
-	for (auto& subMesh : subMeshes) {
-		glGenBuffers(1, &(subMesh.iboId));
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh.iboId);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * subMesh.vertexIndices.size(), subMesh.vertexIndices.data(), GL_STATIC_DRAW);
-	}
-}
-
-
-// Render SubMesh
-void TriangleMesh::Render(SubMesh subMesh) {
-	// Draw SubMesh
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-
-	glBindBuffer(GL_ARRAY_BUFFER, vboId);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexPTN), 0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VertexPTN), (const GLvoid*)12);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexPTN), (const GLvoid*)24);
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh.iboId);
-	glDrawElements(GL_TRIANGLES, (GLsizei)(subMesh.vertexIndices.size()), GL_UNSIGNED_INT, 0);
-
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-	glDisableVertexAttribArray(2);
-
-	return;
-}
\ No newline at end of file
+#include "trianglemesh.h"
+#include "mappedfile.h"
+#include "textscanner.h"
+#include "threadpool.h"
+#include "vertexwelder.h"
+#include "meshcache.h"
+#include "meshsimplifier.h"
+#include "texturecache.h"
+
+#include <gtc/matrix_transform.hpp>
+#include <gtc/packing.hpp>
+#include <tuple>
+
+// Last measured ingest throughput of each source format, seeded with single-core figures of
+// the test models. MESH_SOURCE_AUTO compares size / throughput to choose between .obj and .objm.
+std::atomic<double> TriangleMesh::sourceBytesPerSecond[3] = { 0.0, 165.0 * 1024 * 1024, 210.0 * 1024 * 1024 };
+
+// Constructor of a triangle mesh.
+TriangleMesh::TriangleMesh()
+{
+	numVertices = 0;
+	numTriangles = 0;
+	objCenter = glm::vec3(0.0f, 0.0f, 0.0f);
+	objExtent = glm::vec3(0.0f, 0.0f, 0.0f);
+	boundsCenter = glm::vec3(0.0f, 0.0f, 0.0f);
+	boundsExtent = glm::vec3(0.0f, 0.0f, 0.0f);
+	boundsRadius = 0.0f;
+	vboId = 0;
+	iboId = 0;
+	vaoId = 0;
+	indexType = GL_UNSIGNED_INT;
+	drawDataBufferId = 0;
+	textureArrayId = 0;
+	textureArrayBytes = 0;
+	multiDrawReady = false;
+	buffersPacked = false;
+	meshCacheEnabled = true;
+	meshSource = MESH_SOURCE_AUTO;
+	deferredUploads = false;
+	optimizeVertexOrder = true;
+	compactVertices = false;
+	clusterCulling = false;
+	compactBuffers = false;
+	dequantizeMatrix = glm::mat4x4(1.0f);
+	cpuResidency = CPU_RESIDENCY_RELEASE;
+	cpuCopiesReleased = false;
+	compactError = glm::vec3(0.0f, 0.0f, 0.0f);
+}
+
+// Destructor of a triangle mesh.
+TriangleMesh::~TriangleMesh()
+{
+	ReleaseBuffers();
+	vertices.clear();
+	// Each material holds its own handle on its (possibly shared) texture.
+	for (auto& element : materialMap)
+		TextureCache::Shared().Release(element.second.GetMapKd());
+	materialMap.clear();
+	subMeshes.clear();
+}
+
+// Seconds elapsed since start.
+static double SecondsSince(const std::chrono::high_resolution_clock::time_point& start)
+{
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Load the geometry and material data from an OBJ file.
+bool TriangleMesh::LoadFromFile(const std::string& filePath, const bool normalized, const int numThreads)
+{
+	//Find Object Name
+	std::stringstream ss(filePath);
+	std::string item;
+	std::vector<std::string> elements;
+	while (std::getline(ss, item, '/')) {
+		elements.push_back(item);
+	}
+	std::string objectName = elements.back();
+
+	loadStats = MeshLoadStats();
+
+	//Reopening a Model: Take the Normalized Mesh Straight from the Binary Cache
+	const std::string cachePath = filePath + '/' + objectName + ".meshbin";
+	if (meshCacheEnabled && LoadMeshCache(cachePath, filePath, normalized, numThreads)) {
+		loadStats.fromCache = true;
+		auto meshletStart = std::chrono::high_resolution_clock::now();
+		BuildMeshlets(numThreads);
+		ComputeBounds(numThreads);
+		loadStats.optimizeSeconds = SecondsSince(meshletStart);
+		return true;
+	}
+	//Pick the Source File; .objm Positions Are Already Normalized, so It Only Serves Normalized Loads
+	uint64_t objSize = 0, objmSize = 0;
+	int64_t modifiedTime;
+	const bool hasObj = MeshCache::GetFileStamp(filePath + '/' + objectName + ".obj", objSize, modifiedTime);
+	const bool hasObjm = normalized && MeshCache::GetFileStamp(filePath + '/' + objectName + ".objm", objmSize, modifiedTime);
+	bool useObjm = hasObjm && !hasObj;
+	if (hasObj && hasObjm) {
+		if (meshSource == MESH_SOURCE_AUTO) {
+			//Estimated Ingest Time = Size / Throughput Last Measured for That Format
+			const double objSeconds = (double)objSize / sourceBytesPerSecond[MESH_SOURCE_OBJ];
+			const double objmSeconds = (double)objmSize / sourceBytesPerSecond[MESH_SOURCE_OBJM];
+			useObjm = objmSeconds < objSeconds;
+		}
+		else useObjm = (meshSource == MESH_SOURCE_OBJM);
+	}
+	const std::string sourceName = objectName + (useObjm ? ".objm" : ".obj");
+	bool sourceLoaded = false;
+
+	//For Finding Bounded Box
+	float maxX = -FLT_MAX, maxY = -FLT_MAX, maxZ = -FLT_MAX;
+	float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+
+	//Map File refer to filePath and Tokenize it in Place
+	MappedFile inputFile;
+	if (inputFile.Open(filePath + '/' + sourceName)) {
+		std::cout << "Obj File Open Successful: " << sourceName << std::endl;
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		//Cut the File at Line Boundaries; Small Files Stay in One Chunk
+		int maxChunks = 1;
+		if (numThreads != 1) {
+			const int workers = (numThreads > 1) ? numThreads : ThreadPool::Shared().GetNumThreads() + 1;
+			const size_t minChunkSize = 256 * 1024;
+			maxChunks = (int)std::min((size_t)workers * 4, std::max(inputFile.GetSize() / minChunkSize, (size_t)1));
+		}
+		std::vector<std::pair<const char*, const char*>> ranges;
+		ObjParser::SplitIntoChunks(inputFile.GetData(), inputFile.GetSize(), maxChunks, ranges);
+
+		//Parse v/vt/vn/f (or vtx) Records of Every Chunk
+		std::cout << "Obj File Loading (" << ranges.size() << " chunks)..." << std::endl;
+		std::vector<ObjChunk> chunks(ranges.size());
+		auto parseChunk = [&](int i) {
+			if (useObjm) ObjParser::ParseObjmChunk(ranges[i].first, ranges[i].second, chunks[i]);
+			else ObjParser::ParseChunk(ranges[i].first, ranges[i].second, chunks[i]);
+		};
+		if (chunks.size() > 1)
+			ThreadPool::Shared().ParallelFor((int)chunks.size(), parseChunk);
+		else if (chunks.size() == 1)
+			parseChunk(0);
+
+		//Check Bouned Box Coordinates
+		for (const ObjChunk& chunk : chunks) {
+			if (chunk.positions.empty()) continue;
+			maxX = std::max(maxX, chunk.maxPosition.x);
+			minX = std::min(minX, chunk.minPosition.x);
+			maxY = std::max(maxY, chunk.maxPosition.y);
+			minY = std::min(minY, chunk.minPosition.y);
+			maxZ = std::max(maxZ, chunk.maxPosition.z);
+			minZ = std::min(minZ, chunk.minPosition.z);
+		}
+
+		loadStats.parseSeconds = SecondsSince(startTime);
+		auto weldStart = std::chrono::high_resolution_clock::now();
+		if (useObjm) MergeObjmChunks(chunks);
+		else MergeObjChunks(chunks);
+		loadStats.weldSeconds = SecondsSince(weldStart);
+
+		const double ingestSeconds = GetIngestSeconds();
+		const double bytesPerSecond = (double)inputFile.GetSize() / std::max(ingestSeconds, 1e-9);
+		sourceBytesPerSecond[useObjm ? MESH_SOURCE_OBJM : MESH_SOURCE_OBJ] = bytesPerSecond;
+		std::cout << "Obj File Loaging Finished: " << ingestSeconds * 1000.0 << " ms, "
+			<< bytesPerSecond / (1024.0 * 1024.0) << " MB/s" << std::endl;
+		loadStats.sourceBytes = inputFile.GetSize();
+		inputFile.Close();
+		sourceLoaded = true;
+
+		//Materials Are Loaded After the Geometry so Texture Decoding Stays Out of the Ingest Time
+		auto materialStart = std::chrono::high_resolution_clock::now();
+		for (const std::string& mtlLib : mtlLibs)
+			LoadMtlFile(filePath + "/" + mtlLib, filePath, numThreads);
+		loadStats.materialSeconds = SecondsSince(materialStart);
+	}
+	else std::cout << "Obj File Open Failed" << std::endl;
+
+
+	auto normalizeStart = std::chrono::high_resolution_clock::now();
+	if (normalized) {
+		// Normalize the geometry data.	
+
+		std::cout << "Vertex Normalizing..." << std::endl;
+		//Translate to Center
+		glm::vec3 centerCoordinate = { (maxX + minX) / 2,
+									   (maxY + minY) / 2,
+									   (maxZ + minZ) / 2 };
+
+		for (unsigned int i = 0; i < GetNumVertices(); i++) {
+			vertices[i].position -= centerCoordinate;
+		}
+
+		//Normalize Longest Axis to One
+		float xAxis = std::abs(maxX - minX);
+		float yAxis = std::abs(maxY - minY);
+		float zAxis = std::abs(maxZ - minZ);
+		float longestAxis;
+		if (xAxis >= yAxis && xAxis >= zAxis) longestAxis = xAxis;
+		if (yAxis >= xAxis && yAxis >= zAxis) longestAxis = yAxis;
+		if (zAxis >= yAxis && zAxis >= xAxis) longestAxis = zAxis;
+
+		for (unsigned int i = 0; i < numVertices; i++)
+			vertices[i].position /= longestAxis;
+
+
+		objCenter = centerCoordinate;
+		objExtent = glm::vec3(xAxis / longestAxis, yAxis / longestAxis, zAxis / longestAxis);
+	}
+	std::cout << "Vertex Normalizing Finished" << std::endl;
+	loadStats.normalizeSeconds = SecondsSince(normalizeStart);
+
+	if (sourceLoaded) {
+		auto optimizeStart = std::chrono::high_resolution_clock::now();
+		sourceCacheStats = AnalyzeVertexCache();
+		if (optimizeVertexOrder)
+			OptimizeVertexOrder(numThreads);
+		cacheStats = AnalyzeVertexCache();
+		BuildMeshlets(numThreads);
+		ComputeBounds(numThreads);
+		loadStats.optimizeSeconds = SecondsSince(optimizeStart);
+
+		auto lodStart = std::chrono::high_resolution_clock::now();
+		BuildLods(numThreads);
+		loadStats.lodSeconds = SecondsSince(lodStart);
+	}
+
+	if (sourceLoaded && meshCacheEnabled) {
+		auto cacheStart = std::chrono::high_resolution_clock::now();
+		SaveMeshCache(cachePath, filePath, sourceName,
+			useObjm ? MeshCacheDependency::OBJM : MeshCacheDependency::OBJ, normalized);
+		loadStats.cacheSeconds = SecondsSince(cacheStart);
+	}
+
+	// The upload tasks of a deferred load only copy; the packing is done here, off the GL thread.
+	if (sourceLoaded && deferredUploads)
+		PackBuffers();
+
+	return sourceLoaded;
+}
+
+// Concatenate the attributes of all chunks and build vertices / sub-meshes in file order.
+// Every chunk is replayed in sequence, so the result does not depend on how the file was cut.
+void TriangleMesh::MergeObjChunks(std::vector<ObjChunk>& chunks)
+{
+	//Prefix Sums of Per-Chunk Attribute Counts
+	std::vector<int> pOffsets(chunks.size()), tOffsets(chunks.size()), nOffsets(chunks.size());
+	int numPositions = 0, numTexcoords = 0, numNormals = 0;
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		pOffsets[i] = numPositions;
+		tOffsets[i] = numTexcoords;
+		nOffsets[i] = numNormals;
+		numPositions += (int)chunks[i].positions.size();
+		numTexcoords += (int)chunks[i].texcoords.size();
+		numNormals += (int)chunks[i].normals.size();
+	}
+
+	//Some space to Store Loaded Data
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> textures;
+	std::vector<glm::vec3> normals;
+	positions.reserve(numPositions);
+	textures.reserve(numTexcoords);
+	normals.reserve(numNormals);
+	for (ObjChunk& chunk : chunks) {
+		positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+		textures.insert(textures.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+		normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+		std::vector<glm::vec3>().swap(chunk.positions);
+		std::vector<glm::vec2>().swap(chunk.texcoords);
+		std::vector<glm::vec3>().swap(chunk.normals);
+	}
+
+	//Weld Each Chunk on Its Own: Resolve (p,t,n) and Number Distinct Triples in First-Use Order
+	auto weldStart = std::chrono::high_resolution_clock::now();
+	std::vector<std::vector<int>> cornerIds(chunks.size());
+	std::vector<std::vector<glm::ivec3>> chunkKeys(chunks.size());
+	std::vector<size_t> chunkTableBytes(chunks.size(), 0);
+	auto weldChunk = [&](int c) {
+		const ObjChunk& chunk = chunks[c];
+		VertexWelder welder;
+		welder.Reserve(chunk.corners.size());
+		cornerIds[c].resize(chunk.corners.size());
+		for (size_t i = 0; i < chunk.corners.size(); ++i) {
+			const ObjCorner& corner = chunk.corners[i];
+			int pIndex = corner.pIndex + ((corner.flags & ObjCorner::P_RELATIVE) ? pOffsets[c] : 0);
+			int tIndex = corner.tIndex + ((corner.flags & ObjCorner::T_RELATIVE) ? tOffsets[c] : 0);
+			int nIndex = corner.nIndex + ((corner.flags & ObjCorner::N_RELATIVE) ? nOffsets[c] : 0);
+			if (pIndex < 0 || pIndex >= numPositions) {
+				cornerIds[c][i] = -1;
+				continue;
+			}
+			if (!(corner.flags & ObjCorner::HAS_T) || tIndex < 0 || tIndex >= numTexcoords) tIndex = -1;
+			if (!(corner.flags & ObjCorner::HAS_N) || nIndex < 0 || nIndex >= numNormals) nIndex = -1;
+
+			bool inserted;
+			cornerIds[c][i] = welder.FindOrInsert(pIndex, tIndex, nIndex, inserted);
+			if (inserted)
+				chunkKeys[c].push_back(glm::ivec3(pIndex, tIndex, nIndex));
+		}
+		chunkTableBytes[c] = welder.GetMemoryBytes();
+	};
+	if (chunks.size() > 1)
+		ThreadPool::Shared().ParallelFor((int)chunks.size(), weldChunk);
+	else if (chunks.size() == 1)
+		weldChunk(0);
+
+	//Merge the Chunk Keys in File Order; Only Globally New Triples Become Vertices
+	size_t totalCorners = 0, totalChunkKeys = 0;
+	for (size_t c = 0; c < chunks.size(); ++c) {
+		totalCorners += chunks[c].corners.size();
+		totalChunkKeys += chunkKeys[c].size();
+	}
+	VertexWelder welder;
+	welder.Reserve(totalChunkKeys);
+	std::vector<std::vector<int>> localToGlobal(chunks.size());
+	for (size_t c = 0; c < chunks.size(); ++c) {
+		localToGlobal[c].resize(chunkKeys[c].size());
+		for (size_t k = 0; k < chunkKeys[c].size(); ++k) {
+			const glm::ivec3& key = chunkKeys[c][k];
+			bool inserted;
+			int index = welder.FindOrInsert(key.x, key.y, key.z, inserted);
+			if (inserted) {
+				//Build Vertex Information
+				VertexPTN vertex;
+				vertex.position = positions[key.x];
+				if (key.z >= 0) vertex.normal = normals[key.z];
+				if (key.y >= 0) vertex.texcoord = textures[key.y];
+				vertices.push_back(vertex);
+			}
+			localToGlobal[c][k] = index;
+		}
+	}
+	numVertices = (int)vertices.size();
+
+	size_t peakTableBytes = welder.GetMemoryBytes();
+	for (size_t bytes : chunkTableBytes)
+		peakTableBytes += bytes;
+	welder.Release();
+	std::vector<std::vector<glm::ivec3>>().swap(chunkKeys);
+	auto weldEnd = std::chrono::high_resolution_clock::now();
+	std::cout << "Vertex Welding: " << std::chrono::duration<double>(weldEnd - weldStart).count() * 1000.0 << " ms, "
+		<< numVertices << " unique of " << totalCorners << " corners, tables "
+		<< peakTableBytes / 1024 << " KB" << std::endl;
+
+	//For Current SubMesh Record
+	int subMeshIndex = -1;
+
+	for (size_t c = 0; c < chunks.size(); ++c) {
+		const ObjChunk& chunk = chunks[c];
+		size_t statementIndex = 0;
+		size_t cornerIndex = 0;
+		for (size_t face = 0; face <= chunk.faceSizes.size(); ++face) {
+			//Replay mtllib / usemtl Placed Before This Face
+			for (; statementIndex < chunk.statements.size() && chunk.statements[statementIndex].faceIndex == face; ++statementIndex) {
+				const ObjStatement& statement = chunk.statements[statementIndex];
+				std::string name(statement.name, statement.nameLength);
+				if (statement.type == ObjStatement::MTLLIB) {
+					mtlLibs.push_back(name);
+				}
+				else {
+					// Find Material Refer to Material Map and Start a New SubMesh
+					subMeshes.push_back(SubMesh());
+					subMeshIndex = (int)subMeshes.size() - 1;
+					subMeshes[subMeshIndex].material = &materialMap[name];
+				}
+			}
+			if (face == chunk.faceSizes.size()) break;
+
+			// Faces Before Any usemtl Go to a Default SubMesh
+			if (subMeshIndex < 0) {
+				subMeshes.push_back(SubMesh());
+				subMeshIndex = (int)subMeshes.size() - 1;
+				subMeshes[subMeshIndex].material = &materialMap["Default"];
+			}
+			std::vector<unsigned int>& vertexIndices = subMeshes[subMeshIndex].vertexIndices;
+
+			//Triangulate the Face as a Fan
+			int forPolygonCheck = 0;
+			unsigned firstIndex = 0, lastIndex = 0;
+			const size_t faceEnd = cornerIndex + chunk.faceSizes[face];
+			for (; cornerIndex < faceEnd; ++cornerIndex) {
+				if (cornerIds[c][cornerIndex] < 0) continue;
+				unsigned int index = (unsigned int)localToGlobal[c][cornerIds[c][cornerIndex]];
+
+				forPolygonCheck++;
+				//Add index to vertexIndices
+				switch (forPolygonCheck) {
+				case 1:
+					firstIndex = index;
+					break;
+				case 2:
+					lastIndex = index;
+					break;
+				default:
+					vertexIndices.push_back(firstIndex);
+					vertexIndices.push_back(lastIndex);
+					vertexIndices.push_back(index);
+					lastIndex = index;
+					numTriangles++;
+				}
+			}
+		}
+	}
+}
+
+// Build vertices / sub-meshes from parsed .objm chunks. The records carry every vertex by value,
+// so bit-identical (p, n, uv) are welded back into one indexed vertex, first use first.
+void TriangleMesh::MergeObjmChunks(std::vector<ObjChunk>& chunks)
+{
+	//Weld Each Chunk on Its Own by the Raw Bits of Its Vertices
+	auto weldStart = std::chrono::high_resolution_clock::now();
+	const size_t kVertexWords = 8;
+	std::vector<std::vector<int>> cornerIds(chunks.size());
+	std::vector<VertexBitWelder> chunkWelders(chunks.size(), VertexBitWelder(kVertexWords));
+	auto weldChunk = [&](int c) {
+		ObjChunk& chunk = chunks[c];
+		VertexBitWelder& welder = chunkWelders[c];
+		welder.Reserve(chunk.positions.size() / 4);
+		cornerIds[c].resize(chunk.positions.size());
+		for (size_t i = 0; i < chunk.positions.size(); ++i) {
+			uint32_t key[kVertexWords];
+			memcpy(key, &chunk.positions[i], sizeof(glm::vec3));
+			memcpy(key + 3, &chunk.normals[i], sizeof(glm::vec3));
+			memcpy(key + 6, &chunk.texcoords[i], sizeof(glm::vec2));
+			bool inserted;
+			cornerIds[c][i] = welder.FindOrInsert(key, inserted);
+		}
+		std::vector<glm::vec3>().swap(chunk.positions);
+		std::vector<glm::vec2>().swap(chunk.texcoords);
+		std::vector<glm::vec3>().swap(chunk.normals);
+	};
+	if (chunks.size() > 1)
+		ThreadPool::Shared().ParallelFor((int)chunks.size(), weldChunk);
+	else if (chunks.size() == 1)
+		weldChunk(0);
+
+	//Merge the Chunk Vertices in File Order; Only Globally New Ones Are Kept
+	size_t totalCorners = 0, totalChunkKeys = 0, peakTableBytes = 0;
+	for (size_t c = 0; c < chunks.size(); ++c) {
+		totalCorners += cornerIds[c].size();
+		totalChunkKeys += chunkWelders[c].GetNumKeys();
+		peakTableBytes += chunkWelders[c].GetMemoryBytes();
+	}
+	VertexBitWelder welder(kVertexWords);
+	welder.Reserve(totalChunkKeys);
+	vertices.reserve(totalChunkKeys);
+	std::vector<std::vector<int>> localToGlobal(chunks.size());
+	for (size_t c = 0; c < chunks.size(); ++c) {
+		localToGlobal[c].resize(chunkWelders[c].GetNumKeys());
+		for (size_t k = 0; k < localToGlobal[c].size(); ++k) {
+			const uint32_t* key = chunkWelders[c].GetKey((int)k);
+			bool inserted;
+			localToGlobal[c][k] = welder.FindOrInsert(key, inserted);
+			if (inserted) {
+				VertexPTN vertex;
+				memcpy(&vertex.position, key, sizeof(glm::vec3));
+				memcpy(&vertex.normal, key + 3, sizeof(glm::vec3));
+				memcpy(&vertex.texcoord, key + 6, sizeof(glm::vec2));
+				vertices.push_back(vertex);
+			}
+		}
+		chunkWelders[c].Release();
+	}
+	numVertices = (int)vertices.size();
+	peakTableBytes += welder.GetMemoryBytes();
+	welder.Release();
+	auto weldEnd = std::chrono::high_resolution_clock::now();
+	std::cout << "Vertex Welding: " << std::chrono::duration<double>(weldEnd - weldStart).count() * 1000.0 << " ms, "
+		<< numVertices << " unique of " << totalCorners << " corners, tables "
+		<< peakTableBytes / 1024 << " KB" << std::endl;
+
+	//For Current SubMesh Record
+	int subMeshIndex = -1;
+	unsigned int triangle[3];
+	int numCorners = 0;
+
+	for (size_t c = 0; c < chunks.size(); ++c) {
+		const ObjChunk& chunk = chunks[c];
+		size_t statementIndex = 0;
+		for (size_t corner = 0; corner <= cornerIds[c].size(); ++corner) {
+			//Replay mtllib / usemtl Placed Before This Record
+			for (; statementIndex < chunk.statements.size() && chunk.statements[statementIndex].faceIndex == corner; ++statementIndex) {
+				const ObjStatement& statement = chunk.statements[statementIndex];
+				std::string name(statement.name, statement.nameLength);
+				if (statement.type == ObjStatement::MTLLIB) {
+					mtlLibs.push_back(name);
+				}
+				else {
+					// Find Material Refer to Material Map and Start a New SubMesh
+					subMeshes.push_back(SubMesh());
+					subMeshIndex = (int)subMeshes.size() - 1;
+					subMeshes[subMeshIndex].material = &materialMap[name];
+					numCorners = 0;
+				}
+			}
+			if (corner == cornerIds[c].size()) break;
+
+			// Records Before Any usemtl Go to a Default SubMesh
+			if (subMeshIndex < 0) {
+				subMeshes.push_back(SubMesh());
+				subMeshIndex = (int)subMeshes.size() - 1;
+				subMeshes[subMeshIndex].material = &materialMap["Default"];
+			}
+
+			//Every Three Records Form a Triangle, Even Across Chunk Boundaries
+			triangle[numCorners++] = (unsigned int)localToGlobal[c][cornerIds[c][corner]];
+			if (numCorners == 3) {
+				std::vector<unsigned int>& vertexIndices = subMeshes[subMeshIndex].vertexIndices;
+				vertexIndices.insert(vertexIndices.end(), triangle, triangle + 3);
+				numTriangles++;
+				numCorners = 0;
+			}
+		}
+	}
+}
+
+// Reorder every SubMesh's triangles for the post-transform cache, then renumber the vertices
+// in the order the reordered index lists first use them.
+void TriangleMesh::OptimizeVertexOrder(const int numThreads)
+{
+	std::cout << "Vertex Cache Optimizing..." << std::endl;
+	auto optimizeSubMesh = [this](int i) {
+		VertexCacheOptimizer::OptimizeTriangleOrder(subMeshes[i].vertexIndices, vertices.size());
+	};
+	if (numThreads != 1 && subMeshes.size() > 1)
+		ThreadPool::Shared().ParallelFor((int)subMeshes.size(), optimizeSubMesh);
+	else {
+		for (int i = 0; i < (int)subMeshes.size(); ++i)
+			optimizeSubMesh(i);
+	}
+
+	//First-Use Renumbering; Vertices No Face Uses Keep Their Relative Order at the End
+	std::vector<int> remap(vertices.size(), -1);
+	std::vector<VertexPTN> reordered;
+	reordered.reserve(vertices.size());
+	for (SubMesh& subMesh : subMeshes) {
+		for (unsigned int& index : subMesh.vertexIndices) {
+			if (remap[index] < 0) {
+				remap[index] = (int)reordered.size();
+				reordered.push_back(vertices[index]);
+			}
+			index = (unsigned int)remap[index];
+		}
+	}
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		if (remap[i] < 0)
+			reordered.push_back(vertices[i]);
+	}
+	vertices.swap(reordered);
+	std::cout << "Vertex Cache Optimizing Finished" << std::endl;
+}
+
+// Simplify every SubMesh into up to MESH_CACHE_MAX_LODS coarser index lists, each from the
+// previous one at half its triangles. Vertices whose position is shared with another vertex
+// (UV and normal seams) are locked, and so are SubMesh borders (material seams) by the
+// simplifier itself, so neighbouring parts and LODs still meet without cracks.
+void TriangleMesh::BuildLods(const int numThreads)
+{
+	std::cout << "LOD Building..." << std::endl;
+	VertexBitWelder positionWelder(3);
+	positionWelder.Reserve(vertices.size());
+	std::vector<int> positionIds(vertices.size());
+	std::vector<int> positionUses;
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		bool inserted;
+		positionIds[i] = positionWelder.FindOrInsert((const uint32_t*)&vertices[i].position, inserted);
+		if (inserted)
+			positionUses.push_back(0);
+		positionUses[positionIds[i]]++;
+	}
+	std::vector<unsigned char> locked(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i)
+		locked[i] = positionUses[positionIds[i]] > 1 ? 1 : 0;
+
+	glm::vec3 center, halfExtent;
+	GetPositionBounds(center, halfExtent);
+	// Beyond this a LOD would only ever be picked for a model a few pixels tall.
+	const float maxError = 0.05f * 2.0f * std::max(halfExtent.x, std::max(halfExtent.y, halfExtent.z));
+
+	auto buildSubMesh = [&](int i) {
+		SubMesh& subMesh = subMeshes[i];
+		subMesh.lods.clear();
+		subMesh.lodIndices.clear();
+		const unsigned char* positions = vertices.empty() ? nullptr : (const unsigned char*)&vertices[0].position;
+		std::vector<unsigned int> previous = subMesh.vertexIndices, simplified;
+		float error = 0.0f;
+		for (int level = 0; level < MESH_CACHE_MAX_LODS; ++level) {
+			const size_t target = previous.size() / 6 * 3;
+			error += MeshSimplifier::Simplify(previous, positions, sizeof(VertexPTN), vertices.size(), locked, target, maxError, simplified);
+			// Stop once the locks leave too little to remove for another level to pay off.
+			if (simplified.empty() || simplified.size() * 5 > previous.size() * 4)
+				break;
+			VertexCacheOptimizer::OptimizeTriangleOrder(simplified, vertices.size());
+			SubMeshLod lod;
+			lod.firstIndex = (unsigned int)subMesh.lodIndices.size();
+			lod.numIndices = (unsigned int)simplified.size();
+			lod.error = error;
+			subMesh.lods.push_back(lod);
+			subMesh.lodIndices.insert(subMesh.lodIndices.end(), simplified.begin(), simplified.end());
+			previous.swap(simplified);
+		}
+	};
+	if (numThreads != 1 && subMeshes.size() > 1)
+		ThreadPool::Shared().ParallelFor((int)subMeshes.size(), buildSubMesh);
+	else {
+		for (int i = 0; i < (int)subMeshes.size(); ++i)
+			buildSubMesh(i);
+	}
+	std::cout << "LOD Building Finished" << std::endl;
+}
+
+// Split every SubMesh into meshlets along its (cache-optimized) index order.
+void TriangleMesh::BuildMeshlets(const int numThreads)
+{
+	auto buildSubMesh = [this](int i) {
+		const unsigned char* positions = vertices.empty() ? nullptr : (const unsigned char*)&vertices[0].position;
+		MeshletBuilder::Build(subMeshes[i].vertexIndices, positions, sizeof(VertexPTN), vertices.size(), subMeshes[i].meshlets);
+	};
+	if (numThreads != 1 && subMeshes.size() > 1)
+		ThreadPool::Shared().ParallelFor((int)subMeshes.size(), buildSubMesh);
+	else {
+		for (int i = 0; i < (int)subMeshes.size(); ++i)
+			buildSubMesh(i);
+	}
+}
+
+// Box and sphere of every SubMesh, then of the whole mesh. LODs reuse LOD 0's vertices,
+// so the LOD 0 triangles bound them as well.
+void TriangleMesh::ComputeBounds(const int numThreads)
+{
+	auto boundSubMesh = [this](int i) {
+		SubMesh& subMesh = subMeshes[i];
+		if (subMesh.vertexIndices.empty()) {
+			subMesh.boundsCenter = subMesh.boundsExtent = glm::vec3(0.0f, 0.0f, 0.0f);
+			subMesh.boundsRadius = 0.0f;
+			return;
+		}
+		glm::vec3 minPos = vertices[subMesh.vertexIndices[0]].position;
+		glm::vec3 maxPos = minPos;
+		for (unsigned int index : subMesh.vertexIndices) {
+			minPos = glm::min(minPos, vertices[index].position);
+			maxPos = glm::max(maxPos, vertices[index].position);
+		}
+		subMesh.boundsCenter = 0.5f * (minPos + maxPos);
+		subMesh.boundsExtent = 0.5f * (maxPos - minPos);
+		float radiusSquared = 0.0f;
+		for (unsigned int index : subMesh.vertexIndices) {
+			glm::vec3 offset = vertices[index].position - subMesh.boundsCenter;
+			radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+		}
+		subMesh.boundsRadius = std::sqrt(radiusSquared);
+	};
+	if (numThreads != 1 && subMeshes.size() > 1)
+		ThreadPool::Shared().ParallelFor((int)subMeshes.size(), boundSubMesh);
+	else {
+		for (int i = 0; i < (int)subMeshes.size(); ++i)
+			boundSubMesh(i);
+	}
+
+	//Mesh Bounds: Union of the Boxes, Smallest Sphere Around Its Center Holding Every SubMesh Sphere
+	bool first = true;
+	glm::vec3 minPos = glm::vec3(0.0f, 0.0f, 0.0f);
+	glm::vec3 maxPos = glm::vec3(0.0f, 0.0f, 0.0f);
+	for (const SubMesh& subMesh : subMeshes) {
+		if (subMesh.vertexIndices.empty())
+			continue;
+		minPos = first ? subMesh.boundsCenter - subMesh.boundsExtent : glm::min(minPos, subMesh.boundsCenter - subMesh.boundsExtent);
+		maxPos = first ? subMesh.boundsCenter + subMesh.boundsExtent : glm::max(maxPos, subMesh.boundsCenter + subMesh.boundsExtent);
+		first = false;
+	}
+	boundsCenter = 0.5f * (minPos + maxPos);
+	boundsExtent = 0.5f * (maxPos - minPos);
+	boundsRadius = 0.0f;
+	for (const SubMesh& subMesh : subMeshes) {
+		if (!subMesh.vertexIndices.empty())
+			boundsRadius = std::max(boundsRadius, glm::length(subMesh.boundsCenter - boundsCenter) + subMesh.boundsRadius);
+	}
+
+	//Occluder Candidates: the Largest SubMeshes Hide the Most
+	occluderOrder.clear();
+	for (int i = 0; i < (int)subMeshes.size(); ++i) {
+		if (!subMeshes[i].vertexIndices.empty())
+			occluderOrder.push_back(i);
+	}
+	std::sort(occluderOrder.begin(), occluderOrder.end(),
+		[this](int a, int b) { return subMeshes[a].boundsRadius > subMeshes[b].boundsRadius; });
+}
+
+int TriangleMesh::GetNumMeshlets() const
+{
+	size_t numMeshlets = 0;
+	for (const SubMesh& subMesh : subMeshes)
+		numMeshlets += subMesh.meshlets.size();
+	return (int)numMeshlets;
+}
+
+// Cache statistics summed over the SubMeshes, each drawn with a cold cache.
+VertexCacheStats TriangleMesh::AnalyzeVertexCache() const
+{
+	VertexCacheStats stats;
+	for (const SubMesh& subMesh : subMeshes)
+		stats.Add(VertexCacheOptimizer::Analyze(subMesh.vertexIndices, vertices.size()));
+	return stats;
+}
+
+// Whether count elements of elementSize bytes at offset lie inside a file of fileSize bytes.
+static bool FitsInFile(const uint64_t offset, const uint64_t count, const uint64_t elementSize, const uint64_t fileSize)
+{
+	return offset <= fileSize && count <= (fileSize - offset) / elementSize;
+}
+
+// Check every offset, count and range of a *.meshbin against its size, so a truncated or
+// corrupt cache is rejected instead of read out of bounds.
+static bool IsMeshCacheInBounds(const char* data, const uint64_t fileSize)
+{
+	const MeshCacheHeader* header = (const MeshCacheHeader*)data;
+	if (!FitsInFile(header->dependencyOffset, header->numDependencies, sizeof(MeshCacheDependency), fileSize)
+		|| !FitsInFile(header->subMeshOffset, header->numSubMeshes, sizeof(MeshCacheSubMesh), fileSize)
+		|| !FitsInFile(header->vertexOffset, header->numVertices, sizeof(VertexPTN), fileSize)
+		|| !FitsInFile(header->indexOffset, header->numIndices, sizeof(unsigned int), fileSize)
+		|| header->stringOffset > fileSize)
+		return false;
+
+	//Names Inside the String Table
+	const uint64_t stringsSize = fileSize - header->stringOffset;
+	const MeshCacheDependency* dependencies = (const MeshCacheDependency*)(data + header->dependencyOffset);
+	for (uint32_t i = 0; i < header->numDependencies; ++i) {
+		if (!FitsInFile(dependencies[i].nameOffset, dependencies[i].nameLength, 1, stringsSize))
+			return false;
+	}
+
+	//Sub-Mesh and LOD Ranges Inside the Index Array, Indices Inside the Vertex Array
+	const MeshCacheSubMesh* subMeshes = (const MeshCacheSubMesh*)(data + header->subMeshOffset);
+	const unsigned int* indices = (const unsigned int*)(data + header->indexOffset);
+	for (uint32_t i = 0; i < header->numSubMeshes; ++i) {
+		const MeshCacheSubMesh& subMesh = subMeshes[i];
+		if (!FitsInFile(subMesh.materialNameOffset, subMesh.materialNameLength, 1, stringsSize)
+			|| subMesh.numLods > MESH_CACHE_MAX_LODS)
+			return false;
+		uint64_t rangeSize = subMesh.numIndices;
+		for (uint32_t level = 0; level < subMesh.numLods; ++level)
+			rangeSize += subMesh.lodNumIndices[level];
+		if (!FitsInFile(subMesh.firstIndex, rangeSize, 1, header->numIndices))
+			return false;
+	}
+	for (uint32_t i = 0; i < header->numIndices; ++i) {
+		if (indices[i] >= header->numVertices)
+			return false;
+	}
+	return true;
+}
+
+// Load vertices, sub-meshes and bounds from a *.meshbin written by SaveMeshCache.
+// Fails (and the caller falls back to the OBJ) if the cache is missing, from another
+// version or layout, corrupt, or older than any of the files it was built from.
+bool TriangleMesh::LoadMeshCache(const std::string& cachePath, const std::string& folderPath, const bool normalized, const int numThreads)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+	MappedFile cacheFile;
+	if (!cacheFile.Open(cachePath) || cacheFile.GetSize() < sizeof(MeshCacheHeader))
+		return false;
+
+	const char* data = cacheFile.GetData();
+	const MeshCacheHeader* header = (const MeshCacheHeader*)data;
+	if (memcmp(header->magic, "MESHBIN", 8) != 0 || header->version != MESH_CACHE_VERSION
+		|| header->vertexSize != sizeof(VertexPTN) || header->normalized != (uint32_t)normalized
+		|| header->vertexOrderOptimized != (uint32_t)optimizeVertexOrder
+		|| header->fileSize != cacheFile.GetSize()) {
+		std::cout << "Mesh Cache Outdated: " << cachePath << std::endl;
+		return false;
+	}
+	if (!IsMeshCacheInBounds(data, cacheFile.GetSize())) {
+		std::cout << "Mesh Cache Corrupt: " << cachePath << std::endl;
+		return false;
+	}
+
+	//Any Changed Source Invalidates the Cache
+	const MeshCacheDependency* dependencies = (const MeshCacheDependency*)(data + header->dependencyOffset);
+	const char* strings = data + header->stringOffset;
+	for (uint32_t i = 0; i < header->numDependencies; ++i) {
+		std::string name(strings + dependencies[i].nameOffset, dependencies[i].nameLength);
+		uint64_t fileSize;
+		int64_t modifiedTime;
+		if (!MeshCache::GetFileStamp(folderPath + '/' + name, fileSize, modifiedTime)
+			|| fileSize != dependencies[i].fileSize || modifiedTime != dependencies[i].modifiedTime) {
+			std::cout << "Mesh Cache Stale (" << name << " changed): " << cachePath << std::endl;
+			return false;
+		}
+	}
+
+	//Materials Still Come from the MTL, It Owns the Textures
+	auto materialStart = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < header->numDependencies; ++i) {
+		if (dependencies[i].type != MeshCacheDependency::MTLLIB) continue;
+		std::string name(strings + dependencies[i].nameOffset, dependencies[i].nameLength);
+		mtlLibs.push_back(name);
+		LoadMtlFile(folderPath + '/' + name, folderPath, numThreads);
+	}
+	loadStats.materialSeconds = SecondsSince(materialStart);
+
+	//Bulk Copy of the Mapped Arrays, no Parsing
+	const VertexPTN* cachedVertices = (const VertexPTN*)(data + header->vertexOffset);
+	const unsigned int* cachedIndices = (const unsigned int*)(data + header->indexOffset);
+	vertices.assign(cachedVertices, cachedVertices + header->numVertices);
+	const MeshCacheSubMesh* cachedSubMeshes = (const MeshCacheSubMesh*)(data + header->subMeshOffset);
+	for (uint32_t i = 0; i < header->numSubMeshes; ++i) {
+		const MeshCacheSubMesh& cached = cachedSubMeshes[i];
+		SubMesh subMesh;
+		subMesh.material = &materialMap[std::string(strings + cached.materialNameOffset, cached.materialNameLength)];
+		subMesh.vertexIndices.assign(cachedIndices + cached.firstIndex, cachedIndices + cached.firstIndex + cached.numIndices);
+		const unsigned int* lodIndices = cachedIndices + cached.firstIndex + cached.numIndices;
+		for (uint32_t level = 0; level < cached.numLods && level < MESH_CACHE_MAX_LODS; ++level) {
+			SubMeshLod lod;
+			lod.firstIndex = (unsigned int)subMesh.lodIndices.size();
+			lod.numIndices = cached.lodNumIndices[level];
+			lod.error = cached.lodErrors[level];
+			subMesh.lods.push_back(lod);
+			subMesh.lodIndices.insert(subMesh.lodIndices.end(), lodIndices, lodIndices + lod.numIndices);
+			lodIndices += lod.numIndices;
+		}
+		subMeshes.push_back(std::move(subMesh));
+	}
+	numVertices = (int)header->numVertices;
+	numTriangles = (int)header->numTriangles;
+	objCenter = glm::vec3(header->objCenter[0], header->objCenter[1], header->objCenter[2]);
+	objExtent = glm::vec3(header->objExtent[0], header->objExtent[1], header->objExtent[2]);
+	cacheStats = AnalyzeVertexCache();
+	sourceCacheStats = cacheStats;
+	sourceCacheStats.numTransforms = header->sourceCacheTransforms;
+
+	loadStats.cacheSeconds = SecondsSince(startTime) - loadStats.materialSeconds;
+	std::cout << "Mesh Cache Loaded: " << cachePath << " (" << loadStats.cacheSeconds * 1000.0 << " ms)" << std::endl;
+	return true;
+}
+
+// Write the loaded mesh to a *.meshbin next to the model for LoadMeshCache.
+void TriangleMesh::SaveMeshCache(const std::string& cachePath, const std::string& folderPath,
+	const std::string& sourceFileName, const int sourceType, const bool normalized)
+{
+	//Source Files the Cache Depends On
+	std::vector<std::pair<uint32_t, std::string>> sources;
+	sources.push_back(std::make_pair((uint32_t)sourceType, sourceFileName));
+	for (const std::string& mtlLib : mtlLibs)
+		sources.push_back(std::make_pair((uint32_t)MeshCacheDependency::MTLLIB, mtlLib));
+
+	std::string strings;
+	std::vector<MeshCacheDependency> dependencies;
+	for (const auto& source : sources) {
+		MeshCacheDependency dependency;
+		dependency.type = source.first;
+		dependency.nameOffset = (uint32_t)strings.size();
+		dependency.nameLength = (uint32_t)source.second.size();
+		dependency.reserved = 0;
+		dependency.fileSize = 0;
+		dependency.modifiedTime = 0;
+		MeshCache::GetFileStamp(folderPath + '/' + source.second, dependency.fileSize, dependency.modifiedTime);
+		strings += source.second;
+		dependencies.push_back(dependency);
+	}
+
+	std::vector<MeshCacheSubMesh> cachedSubMeshes;
+	uint32_t numIndices = 0;
+	for (const SubMesh& subMesh : subMeshes) {
+		MeshCacheSubMesh cached;
+		cached.firstIndex = numIndices;
+		cached.numIndices = (uint32_t)subMesh.vertexIndices.size();
+		cached.numLods = (uint32_t)std::min(subMesh.lods.size(), (size_t)MESH_CACHE_MAX_LODS);
+		for (uint32_t level = 0; level < MESH_CACHE_MAX_LODS; ++level) {
+			cached.lodNumIndices[level] = (level < cached.numLods) ? subMesh.lods[level].numIndices : 0;
+			cached.lodErrors[level] = (level < cached.numLods) ? subMesh.lods[level].error : 0.0f;
+		}
+		cached.materialNameOffset = (uint32_t)strings.size();
+		const std::string materialName = subMesh.material->GetName();
+		cached.materialNameLength = (uint32_t)materialName.size();
+		strings += materialName;
+		numIndices += cached.numIndices + (uint32_t)subMesh.lodIndices.size();
+		cachedSubMeshes.push_back(cached);
+	}
+
+	auto alignUp = [](uint64_t offset) { return (offset + 15) & ~(uint64_t)15; };
+	MeshCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "MESHBIN", 8);
+	header.version = MESH_CACHE_VERSION;
+	header.vertexSize = sizeof(VertexPTN);
+	header.normalized = normalized ? 1 : 0;
+	header.numVertices = (uint32_t)vertices.size();
+	header.numIndices = numIndices;
+	header.numTriangles = (uint32_t)numTriangles;
+	header.numSubMeshes = (uint32_t)cachedSubMeshes.size();
+	header.numDependencies = (uint32_t)dependencies.size();
+	header.vertexOrderOptimized = optimizeVertexOrder ? 1 : 0;
+	header.sourceCacheTransforms = (uint32_t)sourceCacheStats.numTransforms;
+	for (int i = 0; i < 3; ++i) {
+		header.objCenter[i] = objCenter[i];
+		header.objExtent[i] = objExtent[i];
+	}
+	header.dependencyOffset = alignUp(sizeof(MeshCacheHeader));
+	header.subMeshOffset = alignUp(header.dependencyOffset + sizeof(MeshCacheDependency) * dependencies.size());
+	header.vertexOffset = alignUp(header.subMeshOffset + sizeof(MeshCacheSubMesh) * cachedSubMeshes.size());
+	header.indexOffset = alignUp(header.vertexOffset + sizeof(VertexPTN) * vertices.size());
+	header.stringOffset = alignUp(header.indexOffset + sizeof(unsigned int) * numIndices);
+	header.fileSize = header.stringOffset + strings.size();
+
+	std::string contents((size_t)header.fileSize, '\0');
+	memcpy(&contents[0], &header, sizeof(header));
+	if (!dependencies.empty())
+		memcpy(&contents[(size_t)header.dependencyOffset], dependencies.data(), sizeof(MeshCacheDependency) * dependencies.size());
+	if (!cachedSubMeshes.empty())
+		memcpy(&contents[(size_t)header.subMeshOffset], cachedSubMeshes.data(), sizeof(MeshCacheSubMesh) * cachedSubMeshes.size());
+	if (!vertices.empty())
+		memcpy(&contents[(size_t)header.vertexOffset], vertices.data(), sizeof(VertexPTN) * vertices.size());
+	size_t indexOffset = (size_t)header.indexOffset;
+	for (const SubMesh& subMesh : subMeshes) {
+		if (!subMesh.vertexIndices.empty())
+			memcpy(&contents[indexOffset], subMesh.vertexIndices.data(), sizeof(unsigned int) * subMesh.vertexIndices.size());
+		indexOffset += sizeof(unsigned int) * subMesh.vertexIndices.size();
+		if (!subMesh.lodIndices.empty())
+			memcpy(&contents[indexOffset], subMesh.lodIndices.data(), sizeof(unsigned int) * subMesh.lodIndices.size());
+		indexOffset += sizeof(unsigned int) * subMesh.lodIndices.size();
+	}
+	if (!strings.empty())
+		memcpy(&contents[(size_t)header.stringOffset], strings.data(), strings.size());
+
+	if (MeshCache::WriteAtomically(cachePath, contents))
+		std::cout << "Mesh Cache Written: " << cachePath << std::endl;
+	else
+		std::cout << "Mesh Cache Write Failed: " << cachePath << std::endl;
+}
+
+bool TriangleMesh::LoadMtlFile(const std::string& filePath, const std::string& folderPath, const int numThreads) {
+	//Open File refer to filePath
+	std::ifstream inputFile(filePath);
+	if (inputFile.is_open()) {
+		// Material name and image path of every map_Kd, decoded once the whole file is read.
+		std::vector<std::pair<std::string, std::string>> textureMaps;
+		std::cout << "Mtl File Open Successful" << std::endl;
+		std::string line;
+		std::string head;
+		//Read File Line by Line
+		std::cout << "Mtl File Loading..." << std::endl;
+		while (getline(inputFile, line)) {
+			std::stringstream ss(line);
+			ss >> head;
+
+			if (head == "newmtl") {
+				std::string flag;
+				std::string element;
+				ss >> flag;
+
+				// Initila PhongMaterial
+				PhongMaterial newMaterial;
+				newMaterial.SetName(flag);
+
+				// Read Ns, Kd, Kd, Ks, map_Kd Line by Line
+				for (int i = 0; i < 5; i++) {
+					getline(inputFile, line);
+					std::stringstream ss(line);
+					ss >> head;
+
+					if (head == "Ns") {
+						float Ns;
+						ss >> Ns;
+						newMaterial.SetNs(Ns);
+					}
+					else if (head == "Ka") {
+						float Ka1, Ka2, Ka3;
+						ss >> Ka1 >> Ka2 >> Ka3;
+						glm::vec3 Ka(Ka1, Ka2, Ka3);
+						newMaterial.SetKa(Ka);
+					}
+					else if (head == "Kd") {
+						float Kd1, Kd2, Kd3;
+						ss >> Kd1 >> Kd2 >> Kd3;
+						glm::vec3 Kd(Kd1, Kd2, Kd3);
+						newMaterial.SetKd(Kd);
+					}
+					else if (head == "Ks") {
+						float Ks1, Ks2, Ks3;
+						ss >> Ks1 >> Ks2 >> Ks3;
+						glm::vec3 Ks(Ks1, Ks2, Ks3);
+						newMaterial.SetKs(Ks);
+					}
+					else if (head == "map_Kd") {
+						std::string imageFile;
+						ss >> imageFile;
+						textureMaps.push_back(std::make_pair(flag, folderPath + '/' + imageFile));
+					}
+				}
+
+				// Add New Material To Material Map
+				materialMap[flag] = newMaterial;
+			}
+			else continue;
+		}
+
+		//One Request per Distinct Image, Holding a Handle for Each Material That Names It
+		auto textureStart = std::chrono::high_resolution_clock::now();
+		TextureCache& textureCache = TextureCache::Shared();
+		std::vector<TextureRequest> requests;
+		std::vector<int> requestIndices(textureMaps.size());
+		std::map<std::string, int> keyRequests;
+		for (size_t i = 0; i < textureMaps.size(); ++i) {
+			const std::string key = TextureCache::MakeKey(textureMaps[i].second);
+			auto inserted = keyRequests.insert(std::make_pair(key, (int)requests.size()));
+			if (inserted.second)
+				requests.push_back(TextureRequest(textureMaps[i].second, key, 0));
+			requestIndices[i] = inserted.first->second;
+			requests[requestIndices[i]].numHandles++;
+		}
+		for (TextureRequest& request : requests)
+			textureCache.Request(request);
+
+		//Decode the Missing Images at Once, Then Wait for Any Another Load Is Decoding
+		auto decodeTexture = [&](int i) {
+			textureCache.Decode(requests[i]);
+		};
+		if (numThreads != 1 && requests.size() > 1)
+			ThreadPool::Shared().ParallelFor((int)requests.size(), decodeTexture);
+		else {
+			for (int i = 0; i < (int)requests.size(); ++i)
+				decodeTexture(i);
+		}
+		for (TextureRequest& request : requests) {
+			textureCache.Resolve(request);
+			if (!deferredUploads)
+				request.texture->Upload();
+		}
+		for (size_t i = 0; i < textureMaps.size(); ++i)
+			materialMap[textureMaps[i].first].SetMapKd(requests[requestIndices[i]].texture);
+		loadStats.textureSeconds += SecondsSince(textureStart);
+
+		std::cout << "Mtl File Loaging Finished" << std::endl;
+		return true;
+	}
+	else {
+		std::cout << "Mtl File Open Failed" << std::endl;
+		return false;
+	}
+}
+
+// Octahedral encoding of a unit vector: fold the lower hemisphere of the octahedron over the upper one.
+static glm::vec2 OctEncode(const glm::vec3& n)
+{
+	float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+	if (sum == 0.0f)
+		return glm::vec2(0.0f, 0.0f);
+	glm::vec2 e = glm::vec2(n.x, n.y) / sum;
+	if (n.z < 0.0f) {
+		e = glm::vec2((1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f),
+			(1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f));
+	}
+	return e;
+}
+
+// Inverse of OctEncode, as done in phong_shading_demo.vs.
+static glm::vec3 OctDecode(const glm::vec2& e)
+{
+	glm::vec3 n = glm::vec3(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+	if (n.z < 0.0f) {
+		n.x = (1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f);
+		n.y = (1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return glm::normalize(n);
+}
+
+static VertexCompact EncodeCompactVertex(const VertexPTN& v, const glm::vec3& center, const glm::vec3& halfExtent)
+{
+	VertexCompact c;
+	glm::vec3 p = (v.position - center) / halfExtent;
+	glm::vec2 e = OctEncode(v.normal);
+	for (int i = 0; i < 3; ++i)
+		c.position[i] = (short)glm::packSnorm1x16(p[i]);
+	c.position[3] = 0;
+	c.normal[0] = (short)glm::packSnorm1x16(e.x);
+	c.normal[1] = (short)glm::packSnorm1x16(e.y);
+	c.texcoord[0] = glm::packHalf1x16(v.texcoord.x);
+	c.texcoord[1] = glm::packHalf1x16(v.texcoord.y);
+	return c;
+}
+
+// Inverse of EncodeCompactVertex, with the quantization loss.
+static VertexPTN DecodeCompactVertex(const VertexCompact& c, const glm::mat4x4& dequantize)
+{
+	VertexPTN v;
+	glm::vec3 q = glm::vec3(glm::unpackSnorm1x16(c.position[0]), glm::unpackSnorm1x16(c.position[1]), glm::unpackSnorm1x16(c.position[2]));
+	v.position = glm::vec3(dequantize * glm::vec4(q, 1.0f));
+	v.normal = OctDecode(glm::vec2(glm::unpackSnorm1x16(c.normal[0]), glm::unpackSnorm1x16(c.normal[1])));
+	v.texcoord = glm::vec2(glm::unpackHalf1x16(c.texcoord[0]), glm::unpackHalf1x16(c.texcoord[1]));
+	return v;
+}
+
+// LOD 0 indices of a SubMesh, before or after CreateBuffer.
+static size_t GetNumIndices(const SubMesh& subMesh)
+{
+	return subMesh.vertexIndices.empty() ? subMesh.numIndices : subMesh.vertexIndices.size();
+}
+
+// Indices of the whole LOD chain (SubMesh::lodIndices, released or not).
+static size_t GetNumLodIndices(const SubMesh& subMesh)
+{
+	return subMesh.lods.empty() ? 0 : subMesh.lods.back().firstIndex + subMesh.lods.back().numIndices;
+}
+
+// Smallest and largest vertex a SubMesh references; a span below 65536 fits 16-bit indices.
+static void GetIndexRange(const SubMesh& subMesh, unsigned int& minIndex, unsigned int& maxIndex)
+{
+	minIndex = 0;
+	maxIndex = 0;
+	if (subMesh.vertexIndices.empty())
+		return;
+	auto range = std::minmax_element(subMesh.vertexIndices.begin(), subMesh.vertexIndices.end());
+	minIndex = *range.first;
+	maxIndex = *range.second;
+}
+
+// Box around a model-space box after worldMatrix: the center moves, the extent is
+// projected onto the world axes through the absolute rotation / scale part.
+static void TransformBox(const glm::mat4x4& worldMatrix, const glm::vec3& center, const glm::vec3& extent,
+	glm::vec3& worldCenter, glm::vec3& worldExtent)
+{
+	worldCenter = glm::vec3(worldMatrix * glm::vec4(center, 1.0f));
+	worldExtent = glm::abs(glm::vec3(worldMatrix[0])) * extent.x
+		+ glm::abs(glm::vec3(worldMatrix[1])) * extent.y
+		+ glm::abs(glm::vec3(worldMatrix[2])) * extent.z;
+}
+
+int TriangleMesh::CullSubMeshes(const Frustum& frustum, const glm::mat4x4& worldMatrix)
+{
+	//Whole Mesh First; an Object Outside the View Costs One Box Test
+	glm::vec3 worldCenter, worldExtent;
+	TransformBox(worldMatrix, boundsCenter, boundsExtent, worldCenter, worldExtent);
+	cullBoxes.Clear();
+	cullResults.assign(subMeshes.size(), 0);
+	if (!frustum.IntersectsBox(worldCenter, worldExtent)) {
+		for (SubMesh& subMesh : subMeshes)
+			subMesh.visible = false;
+		return 0;
+	}
+
+	//SubMesh Boxes in One Batch, Kept for CullOccludedSubMeshes
+	for (const SubMesh& subMesh : subMeshes) {
+		TransformBox(worldMatrix, subMesh.boundsCenter, subMesh.boundsExtent, worldCenter, worldExtent);
+		cullBoxes.Add(worldCenter, worldExtent);
+	}
+	if (subMeshes.size() == 1)
+		cullResults[0] = 1;
+	else frustum.CullBoxes(cullBoxes, cullResults.data());
+	int numVisible = 0;
+	for (size_t i = 0; i < subMeshes.size(); ++i) {
+		subMeshes[i].visible = (cullResults[i] != 0);
+		numVisible += cullResults[i];
+	}
+	return numVisible;
+}
+
+// Largest visible SubMeshes first, each at its selected LOD or, to stay within maxTriangles, a coarser one.
+void TriangleMesh::AddOccluders(OcclusionCuller& culler, const glm::mat4x4& worldMatrix, const int maxTriangles)
+{
+	size_t budget = (size_t)std::max(maxTriangles, 0) * 3;
+
+	//Released Copies: Only the Proxy Kept for Each SubMesh
+	if (cpuCopiesReleased) {
+		for (int i : occluderOrder) {
+			const SubMesh& subMesh = subMeshes[i];
+			const size_t numIndices = subMesh.occluderIndices.size();
+			if (!subMesh.visible || numIndices == 0 || numIndices > budget)
+				continue;
+			culler.AddOccluder((const unsigned char*)occluderPositions.data(), sizeof(glm::vec3),
+				subMesh.occluderIndices.data(), numIndices, worldMatrix);
+			budget -= numIndices;
+		}
+		return;
+	}
+	if (vertices.empty())
+		return;
+	const unsigned char* positions = (const unsigned char*)&vertices[0].position;
+	const size_t positionStride = sizeof(VertexPTN);
+	for (int i : occluderOrder) {
+		const SubMesh& subMesh = subMeshes[i];
+		if (!subMesh.visible)
+			continue;
+		for (int level = subMesh.lod; level <= (int)subMesh.lods.size(); ++level) {
+			const unsigned int* indices = (level == 0) ? subMesh.vertexIndices.data() : &subMesh.lodIndices[subMesh.lods[level - 1].firstIndex];
+			const size_t numIndices = (level == 0) ? subMesh.vertexIndices.size() : subMesh.lods[level - 1].numIndices;
+			if (numIndices <= budget) {
+				culler.AddOccluder(positions, positionStride, indices, numIndices, worldMatrix);
+				budget -= numIndices;
+				break;
+			}
+		}
+	}
+}
+
+int TriangleMesh::CullOccludedSubMeshes(OcclusionCuller& culler)
+{
+	if (cullBoxes.GetSize() != subMeshes.size())
+		return 0;
+	for (size_t i = 0; i < subMeshes.size(); ++i)
+		cullResults[i] = subMeshes[i].visible ? 1 : 0;
+	const int numCulled = culler.CullBoxes(cullBoxes, cullResults.data());
+	for (size_t i = 0; i < subMeshes.size(); ++i)
+		subMeshes[i].visible = (cullResults[i] != 0);
+	return numCulled;
+}
+
+int TriangleMesh::GetNumVisibleSubMeshes() const
+{
+	int numVisible = 0;
+	for (const SubMesh& subMesh : subMeshes)
+		numVisible += subMesh.visible ? 1 : 0;
+	return numVisible;
+}
+
+// Build the draw ranges of every SubMesh from the meshlets that can be visible.
+void TriangleMesh::CullClusters(const glm::mat4x4& modelViewProj, const glm::vec3& cameraPos)
+{
+	const Frustum frustum(modelViewProj);
+	for (SubMesh& subMesh : subMeshes) {
+		subMesh.drawCounts.clear();
+		subMesh.drawOffsets.clear();
+		subMesh.drawBaseVertices.clear();
+		if (subMesh.lod > 0 || !subMesh.visible)
+			continue;
+		const size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int);
+		unsigned int rangeEnd = ~0u;
+		for (const Meshlet& meshlet : subMesh.meshlets) {
+			if (!frustum.IntersectsSphere(meshlet.center, meshlet.radius) || meshlet.IsBackfacing(cameraPos))
+				continue;
+			//Meshlets Are Consecutive in the Index Buffer, so Neighbours Share One Draw
+			if (meshlet.firstIndex == rangeEnd)
+				subMesh.drawCounts.back() += (GLsizei)meshlet.numIndices;
+			else {
+				subMesh.drawCounts.push_back((GLsizei)meshlet.numIndices);
+				subMesh.drawOffsets.push_back((const GLvoid*)((subMesh.firstIndex + meshlet.firstIndex) * indexSize));
+				subMesh.drawBaseVertices.push_back(subMesh.baseVertex);
+			}
+			rangeEnd = meshlet.firstIndex + meshlet.numIndices;
+		}
+	}
+}
+
+void TriangleMesh::SelectLod(const float pixelsPerUnit, const float maxPixelError)
+{
+	for (SubMesh& subMesh : subMeshes)
+		subMesh.lod = GetLodLevel(subMesh, pixelsPerUnit, maxPixelError);
+}
+
+int TriangleMesh::GetLodLevel(const SubMesh& subMesh, const float pixelsPerUnit, const float maxPixelError) const
+{
+	int lod = 0;
+	for (size_t i = 0; i < subMesh.lods.size(); ++i) {
+		if (subMesh.lods[i].error * pixelsPerUnit <= maxPixelError)
+			lod = (int)i + 1;
+	}
+	return lod;
+}
+
+int TriangleMesh::GetNumSubmittedTriangles() const
+{
+	size_t numIndices = 0;
+	for (const SubMesh& subMesh : subMeshes) {
+		if (!subMesh.visible)
+			continue;
+		if (subMesh.lod > 0)
+			numIndices += subMesh.lods[subMesh.lod - 1].numIndices;
+		else if (clusterCulling) {
+			for (GLsizei count : subMesh.drawCounts)
+				numIndices += (size_t)count;
+		}
+		else numIndices += subMesh.numIndices;
+	}
+	return (int)(numIndices / 3);
+}
+
+// Show model information.
+void TriangleMesh::ShowInfo()
+{
+	std::cout << "# Vertices: " << numVertices << std::endl;
+	std::cout << "# Triangles: " << numTriangles << std::endl;
+	std::cout << "Total " << subMeshes.size() << " subMeshes loaded" << std::endl;
+	for (unsigned int i = 0; i < subMeshes.size(); ++i) {
+		const SubMesh& g = subMeshes[i];
+		std::cout << "SubMesh " << i << " with material: " << g.material->GetName() << std::endl;
+		std::cout << "Num. triangles in the subMesh: " << GetNumIndices(g) / 3 << std::endl;
+	}
+	std::cout << "Model Center: " << objCenter.x << ", " << objCenter.y << ", " << objCenter.z << std::endl;
+	std::cout << "Model Extent: " << objExtent.x << " x " << objExtent.y << " x " << objExtent.z << std::endl;
+	std::cout << "Bounding Sphere Radius: " << boundsRadius << std::endl;
+	//Triangles of Each Level Summed over the SubMeshes; a SubMesh with a Shorter Chain Adds Its Coarsest
+	std::cout << "LOD Triangles:";
+	for (int level = 0; level <= MESH_CACHE_MAX_LODS; ++level) {
+		size_t levelTriangles = 0;
+		float levelError = 0.0f;
+		for (const SubMesh& subMesh : subMeshes) {
+			const int used = std::min(level, (int)subMesh.lods.size());
+			levelTriangles += (used == 0 ? GetNumIndices(subMesh) : subMesh.lods[used - 1].numIndices) / 3;
+			levelError = std::max(levelError, used == 0 ? 0.0f : subMesh.lods[used - 1].error);
+		}
+		std::cout << (level ? ", " : " ") << levelTriangles << " (error " << levelError << ")";
+	}
+	std::cout << std::endl;
+	std::cout << "Meshlets: " << GetNumMeshlets() << " (max " << MeshletBuilder::kMaxVertices << " vertices, "
+		<< MeshletBuilder::kMaxTriangles << " triangles)" << std::endl;
+	std::cout << "Vertex Cache (FIFO 16): ACMR " << sourceCacheStats.GetACMR() << " -> " << cacheStats.GetACMR()
+		<< ", ATVR " << sourceCacheStats.GetATVR() << " -> " << cacheStats.GetATVR() << std::endl;
+}
+
+// Decode the encoded vertices to measure what the compact layout loses (position, normal degrees, texcoord).
+static glm::vec3 MeasureCompactError(const std::vector<VertexPTN>& vertices, const std::vector<VertexCompact>& compact,
+	const glm::mat4x4& dequantize)
+{
+	float maxPositionError = 0.0f, maxNormalDegrees = 0.0f, maxTexcoordError = 0.0f;
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		const VertexPTN& v = vertices[i];
+		const VertexPTN d = DecodeCompactVertex(compact[i], dequantize);
+		maxPositionError = std::max(maxPositionError, glm::length(d.position - v.position));
+		if (glm::length(v.normal) > 0.0f) {
+			// Angle from the chord length; acos of a dot product near 1 is all float noise.
+			float chord = glm::length(d.normal - glm::normalize(v.normal));
+			maxNormalDegrees = std::max(maxNormalDegrees, glm::degrees(2.0f * std::asin(std::min(0.5f * chord, 1.0f))));
+		}
+		maxTexcoordError = std::max(maxTexcoordError, std::max(std::abs(d.texcoord.x - v.texcoord.x), std::abs(d.texcoord.y - v.texcoord.y)));
+	}
+	return glm::vec3(maxPositionError, maxNormalDegrees, maxTexcoordError);
+}
+
+// Show the GPU memory of the float and compact layouts, then the CPU copies.
+void TriangleMesh::ShowMemoryReport()
+{
+	size_t numIndices = 0, compactIndexBytes = 0;
+	for (const SubMesh& subMesh : subMeshes) {
+		const size_t subMeshIndices = subMesh.numIndices + GetNumLodIndices(subMesh);
+		numIndices += subMeshIndices;
+		compactIndexBytes += subMeshIndices * (subMesh.maxIndex - subMesh.minIndex < 65536 ? sizeof(unsigned short) : sizeof(unsigned int));
+	}
+	const size_t fullVertexBytes = sizeof(VertexPTN) * numVertices;
+	const size_t fullIndexBytes = sizeof(unsigned int) * numIndices;
+	const size_t compactVertexBytes = sizeof(VertexCompact) * numVertices;
+
+	//CPU Copies Next to the Buffers, Against Keeping Everything
+	size_t cpuGeometryBytes = sizeof(VertexPTN) * vertices.capacity() + sizeof(glm::vec3) * occluderPositions.capacity();
+	for (const SubMesh& subMesh : subMeshes) {
+		cpuGeometryBytes += sizeof(unsigned int) * (subMesh.vertexIndices.capacity() + subMesh.lodIndices.capacity()
+			+ subMesh.occluderIndices.capacity());
+	}
+	size_t cpuTextureBytes = 0, decodedTextureBytes = 0, gpuTextureBytes = 0, uncompressedTextureBytes = 0;
+	int numCompressedTextures = 0;
+	std::vector<const ImageTexture*> textures;
+	for (const auto& element : materialMap) {
+		const ImageTexture* texture = element.second.GetMapKd();
+		if (texture == nullptr || std::find(textures.begin(), textures.end(), texture) != textures.end())
+			continue;
+		textures.push_back(texture);
+		cpuTextureBytes += texture->GetCpuBytes();
+		decodedTextureBytes += texture->GetDecodedBytes();
+		gpuTextureBytes += texture->GetGpuBytes();
+		uncompressedTextureBytes += texture->GetUncompressedGpuBytes();
+		numCompressedTextures += texture->IsCompressed() ? 1 : 0;
+	}
+	const size_t keptBytes = fullVertexBytes + fullIndexBytes + decodedTextureBytes;
+	const size_t cpuBytes = cpuGeometryBytes + cpuTextureBytes;
+
+	std::cout << "Vertex Memory (" << (compactBuffers ? "compact" : "float") << " in use):" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "  Float:   " << sizeof(VertexPTN) << " B/vertex, " << fullVertexBytes / 1024.0 << " KB vertices + "
+		<< fullIndexBytes / 1024.0 << " KB indices = " << (fullVertexBytes + fullIndexBytes) / 1024.0 << " KB" << std::endl;
+	std::cout << "  Compact: " << sizeof(VertexCompact) << " B/vertex, " << compactVertexBytes / 1024.0 << " KB vertices + "
+		<< compactIndexBytes / 1024.0 << " KB indices = " << (compactVertexBytes + compactIndexBytes) / 1024.0 << " KB" << std::endl;
+	std::cout << std::defaultfloat << std::setprecision(3);
+	if (compactBuffers) {
+		std::cout << "  Compact error: position " << compactError.x << ", normal " << compactError.y
+			<< " deg, texcoord " << compactError.z << std::endl;
+	}
+	else std::cout << "  Compact error: measured while the compact layout is in use" << std::endl;
+	std::cout << "CPU Memory (" << (cpuResidency == CPU_RESIDENCY_KEEP ? "kept" : "released after upload") << "):" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "  Geometry: " << cpuGeometryBytes / 1024.0 << " KB, textures: " << cpuTextureBytes / 1024.0
+		<< " KB (" << textures.size() << " images), saved " << (keptBytes - std::min(cpuBytes, keptBytes)) / 1024.0
+		<< " KB of " << keptBytes / 1024.0 << " KB" << std::endl;
+	std::cout << "Texture Memory (" << numCompressedTextures << " of " << textures.size() << " block compressed):" << std::endl;
+	std::cout << "  GPU: " << gpuTextureBytes / 1024.0 << " KB with mipmaps, uncompressed " << uncompressedTextureBytes / 1024.0
+		<< " KB (" << (gpuTextureBytes > 0 ? (double)uncompressedTextureBytes / gpuTextureBytes : 1.0) << "x)" << std::endl;
+	if (textureArrayBytes > 0)
+		std::cout << "  Multi-draw texture array: " << textureArrayBytes / 1024.0 << " KB, copied in the maps' own format" << std::endl;
+	std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+void TriangleMesh::AppendUploadTasks(std::vector<std::function<void()>>& tasks)
+{
+	// Materials may share a texture; upload it once.
+	std::vector<ImageTexture*> textures;
+	for (auto& element : materialMap) {
+		ImageTexture* texture = element.second.GetMapKd();
+		if (texture != nullptr && std::find(textures.begin(), textures.end(), texture) == textures.end()) {
+			texture->AppendUploadTasks(tasks);
+			textures.push_back(texture);
+		}
+	}
+
+	//Split the Buffer Contents into Ranged Uploads; the Packing Was Done by the Loading Thread
+	if (!buffersPacked || compactBuffers != compactVertices)
+		PackBuffers();
+	// 1 MB, the size of a texture band: a fraction of a millisecond to copy.
+	const size_t rangeBytes = (size_t)1 << 20;
+	tasks.push_back([this]() { AllocateBuffers(); });
+	const size_t vertexBytes = GetVertexBufferBytes();
+	for (size_t offset = 0; offset < vertexBytes; offset += rangeBytes) {
+		const size_t size = std::min(rangeBytes, vertexBytes - offset);
+		tasks.push_back([this, offset, size]() { UploadBufferRange(GL_ARRAY_BUFFER, offset, size); });
+	}
+	for (size_t offset = 0; offset < packedIndices.size(); offset += rangeBytes) {
+		const size_t size = std::min(rangeBytes, packedIndices.size() - offset);
+		tasks.push_back([this, offset, size]() { UploadBufferRange(GL_ELEMENT_ARRAY_BUFFER, offset, size); });
+	}
+	tasks.push_back([this]() { FinishBuffers(); });
+	if (cpuResidency == CPU_RESIDENCY_RELEASE)
+		tasks.push_back([this]() { ReleaseCpuCopies(); });
+}
+
+// Box the compact positions are quantized in; flat axes get a unit extent so they stay finite.
+void TriangleMesh::GetPositionBounds(glm::vec3& center, glm::vec3& halfExtent) const
+{
+	glm::vec3 minPos = glm::vec3(0.0f, 0.0f, 0.0f);
+	glm::vec3 maxPos = glm::vec3(0.0f, 0.0f, 0.0f);
+	if (!vertices.empty()) {
+		minPos = maxPos = vertices[0].position;
+		for (const VertexPTN& v : vertices) {
+			minPos = glm::min(minPos, v.position);
+			maxPos = glm::max(maxPos, v.position);
+		}
+	}
+	center = 0.5f * (minPos + maxPos);
+	halfExtent = 0.5f * (maxPos - minPos);
+	for (int i = 0; i < 3; ++i) {
+		if (halfExtent[i] <= 0.0f)
+			halfExtent[i] = 1.0f;
+	}
+}
+
+// Create Vertex and Index Buffer
+void TriangleMesh::CreateBuffer() {
+	if (cpuCopiesReleased) {
+		std::cerr << "[ERROR] CreateBuffer: the CPU copies are released; RestoreCpuCopies before ReleaseBuffers" << std::endl;
+		return;
+	}
+	// Packed by a deferred load already, unless the layout setting changed since.
+	if (!buffersPacked || compactBuffers != compactVertices)
+		PackBuffers();
+	AllocateBuffers();
+	UploadBufferRange(GL_ARRAY_BUFFER, 0, GetVertexBufferBytes());
+	UploadBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, packedIndices.size());
+	FinishBuffers();
+	if (cpuResidency == CPU_RESIDENCY_RELEASE)
+		ReleaseCpuCopies();
+}
+
+// Everything CreateBuffer computes before touching GL: the encoded vertices, the index buffer
+// contents and the material buffer contents.
+void TriangleMesh::PackBuffers()
+{
+	compactBuffers = compactVertices;
+	dequantizeMatrix = glm::mat4x4(1.0f);
+	compactError = glm::vec3(0.0f, 0.0f, 0.0f);
+
+	// Pack Vertices; the Float Layout Uploads vertices As They Are
+	std::vector<VertexCompact>().swap(packedVertices);
+	if (compactBuffers) {
+		glm::vec3 center, halfExtent;
+		GetPositionBounds(center, halfExtent);
+		dequantizeMatrix = glm::scale(glm::translate(glm::mat4x4(1.0f), center), halfExtent);
+		packedVertices.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+			packedVertices[i] = EncodeCompactVertex(vertices[i], center, halfExtent);
+		// Measured here, where the encoded vertices already exist, for ShowMemoryReport.
+		compactError = MeasureCompactError(vertices, packedVertices, dequantizeMatrix);
+	}
+
+	// Pack Indices
+	// One buffer for all SubMeshes: 16-bit only if every SubMesh's range fits, so one index type
+	// serves every draw.
+	bool shortIndices = compactBuffers;
+	size_t numIndices = 0;
+	for (auto& subMesh : subMeshes) {
+		unsigned int minIndex, maxIndex;
+		GetIndexRange(subMesh, minIndex, maxIndex);
+		shortIndices = shortIndices && (maxIndex - minIndex < 65536);
+		subMesh.numIndices = (unsigned int)subMesh.vertexIndices.size();
+		subMesh.minIndex = minIndex;
+		subMesh.maxIndex = maxIndex;
+		subMesh.firstIndex = (unsigned int)numIndices;
+		subMesh.baseVertex = (GLint)minIndex;
+		// LOD 0 followed by the LOD chain; LODs only use vertices LOD 0 already does.
+		numIndices += subMesh.vertexIndices.size() + subMesh.lodIndices.size();
+	}
+	indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	if (shortIndices) {
+		packedIndices.resize(sizeof(unsigned short) * numIndices);
+		unsigned short* packed = (unsigned short*)packedIndices.data();
+		for (const auto& subMesh : subMeshes) {
+			for (unsigned int index : subMesh.vertexIndices)
+				*packed++ = (unsigned short)(index - subMesh.baseVertex);
+			for (unsigned int index : subMesh.lodIndices)
+				*packed++ = (unsigned short)(index - subMesh.baseVertex);
+		}
+	}
+	else {
+		packedIndices.resize(sizeof(unsigned int) * numIndices);
+		unsigned int* packed = (unsigned int*)packedIndices.data();
+		for (auto& subMesh : subMeshes) {
+			subMesh.baseVertex = 0;
+			packed = std::copy(subMesh.vertexIndices.begin(), subMesh.vertexIndices.end(), packed);
+			packed = std::copy(subMesh.lodIndices.begin(), subMesh.lodIndices.end(), packed);
+		}
+	}
+
+	// Pack Materials
+	std::map<const PhongMaterial*, int> materialIndices;
+	packedMaterials.clear();
+	for (const auto& element : materialMap) {
+		const PhongMaterial& material = element.second;
+		MaterialUniforms data;
+		data.Ka = glm::vec4(material.GetKa(), 0.0f);
+		data.Kd = glm::vec4(material.GetKd(), material.GetMapKd() != nullptr ? 1.0f : 0.0f);
+		data.Ks = glm::vec4(material.GetKs(), material.GetNs());
+		materialIndices[&material] = (int)packedMaterials.size();
+		packedMaterials.push_back(data);
+	}
+	for (auto& subMesh : subMeshes)
+		subMesh.materialIndex = materialIndices[subMesh.material];
+	// A bound window must cover the whole array the shader declares.
+	const size_t numBlocks = std::max((size_t)1, (packedMaterials.size() + MATERIALS_PER_BLOCK - 1) / MATERIALS_PER_BLOCK);
+	packedMaterials.resize(numBlocks * MATERIALS_PER_BLOCK);
+	buffersPacked = true;
+}
+
+size_t TriangleMesh::GetVertexBufferBytes() const
+{
+	return compactBuffers ? sizeof(VertexCompact) * packedVertices.size() : sizeof(VertexPTN) * vertices.size();
+}
+
+// Vertex and index buffers at their packed sizes, contents left to UploadBufferRange.
+void TriangleMesh::AllocateBuffers()
+{
+	glGenBuffers(1, &vboId);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vboId);
+	glBufferData(GL_COPY_WRITE_BUFFER, GetVertexBufferBytes(), nullptr, GL_STATIC_DRAW);
+	glGenBuffers(1, &iboId);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, iboId);
+	glBufferData(GL_COPY_WRITE_BUFFER, packedIndices.size(), nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// Bound as the copy target, so whichever vertex array is bound keeps its index buffer.
+void TriangleMesh::UploadBufferRange(const GLenum target, const size_t offset, const size_t size)
+{
+	const unsigned char* data = packedIndices.data();
+	GLuint buffer = iboId;
+	if (target == GL_ARRAY_BUFFER) {
+		data = compactBuffers ? (const unsigned char*)packedVertices.data() : (const unsigned char*)vertices.data();
+		buffer = vboId;
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)size, data + offset);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// Material buffer, multi-draw data and the vertex array, once the vertex and index buffers hold
+// their contents; frees the packed copies.
+void TriangleMesh::FinishBuffers()
+{
+	// Index buffer bindings below must not land in whichever vertex array was drawn last.
+	glBindVertexArray(0);
+
+	// Create Material Buffer
+	materialBuffer.Create(sizeof(MaterialUniforms) * packedMaterials.size(), packedMaterials.data());
+
+	// Create Texture Array and Draw Data for Multi-Draw
+	multiDrawReady = IsMultiDrawSupported() && packedMaterials.size() == MATERIALS_PER_BLOCK;
+	if (multiDrawReady)
+		CreateTextureArray();
+	std::vector<GLint> drawData;
+	drawData.reserve(2 * subMeshes.size());
+	for (const auto& subMesh : subMeshes) {
+		drawData.push_back(subMesh.materialIndex);
+		drawData.push_back(subMesh.textureLayer);
+	}
+	glGenBuffers(1, &drawDataBufferId);
+	glBindBuffer(GL_ARRAY_BUFFER, drawDataBufferId);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLint) * drawData.size(), drawData.data(), GL_STATIC_DRAW);
+
+	// Record the Input Layout Once; Drawing Only Binds the Vertex Array
+	glGenVertexArrays(1, &vaoId);
+	glBindVertexArray(vaoId);
+	glBindBuffer(GL_ARRAY_BUFFER, vboId);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	if (compactBuffers) {
+		glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(VertexCompact), 0);
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(VertexCompact), (const GLvoid*)8);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(VertexCompact), (const GLvoid*)12);
+	}
+	else {
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexPTN), 0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VertexPTN), (const GLvoid*)12);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexPTN), (const GLvoid*)24);
+	}
+	// One element per draw: a command's base instance picks its SubMesh's entry.
+	glBindBuffer(GL_ARRAY_BUFFER, drawDataBufferId);
+	glEnableVertexAttribArray(3);
+	glVertexAttribIPointer(3, 2, GL_INT, 2 * sizeof(GLint), 0);
+	glVertexAttribDivisor(3, 1);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboId);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	std::vector<VertexCompact>().swap(packedVertices);
+	std::vector<unsigned char>().swap(packedIndices);
+	std::vector<MaterialUniforms>().swap(packedMaterials);
+	buffersPacked = false;
+}
+
+// Drop the vertices and index lists the buffers now hold; the meshlets, counts and a small
+// occluder proxy stay.
+void TriangleMesh::ReleaseCpuCopies()
+{
+	BuildOccluderProxy();
+	std::vector<VertexPTN>().swap(vertices);
+	for (auto& subMesh : subMeshes) {
+		std::vector<unsigned int>().swap(subMesh.vertexIndices);
+		std::vector<unsigned int>().swap(subMesh.lodIndices);
+	}
+	cpuCopiesReleased = true;
+}
+
+void TriangleMesh::RestoreCpuCopies()
+{
+	if (!cpuCopiesReleased || vboId == 0)
+		return;
+	ReadBackIndices();
+	ReadBackVertices(vertices);
+	std::vector<glm::vec3>().swap(occluderPositions);
+	for (auto& subMesh : subMeshes)
+		std::vector<unsigned int>().swap(subMesh.occluderIndices);
+	cpuCopiesReleased = false;
+}
+
+// Copy the coarsest LOD of every occluder candidate, and only the positions it uses, so
+// occlusion culling needs neither the full copies nor a read back from the buffers.
+void TriangleMesh::BuildOccluderProxy()
+{
+	std::vector<glm::vec3>().swap(occluderPositions);
+	std::vector<unsigned int> remap(vertices.size(), ~0u);
+	for (int i : occluderOrder) {
+		SubMesh& subMesh = subMeshes[i];
+		const bool hasLods = !subMesh.lods.empty();
+		const unsigned int* indices = hasLods ? &subMesh.lodIndices[subMesh.lods.back().firstIndex] : subMesh.vertexIndices.data();
+		const size_t numIndices = hasLods ? subMesh.lods.back().numIndices : subMesh.vertexIndices.size();
+		subMesh.occluderIndices.resize(numIndices);
+		for (size_t k = 0; k < numIndices; ++k) {
+			const unsigned int v = indices[k];
+			if (remap[v] == ~0u) {
+				remap[v] = (unsigned int)occluderPositions.size();
+				occluderPositions.push_back(vertices[v].position);
+			}
+			subMesh.occluderIndices[k] = remap[v];
+		}
+	}
+	occluderPositions.shrink_to_fit();
+}
+
+// Rebuild every SubMesh's vertexIndices and lodIndices from the index buffer.
+void TriangleMesh::ReadBackIndices()
+{
+	// Unbound first, so the index buffer binding does not land in a vertex array.
+	glBindVertexArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboId);
+	std::vector<unsigned short> packedIndices;
+	for (auto& subMesh : subMeshes) {
+		const size_t numLodIndices = GetNumLodIndices(subMesh);
+		subMesh.vertexIndices.resize(subMesh.numIndices);
+		subMesh.lodIndices.resize(numLodIndices);
+		if (indexType == GL_UNSIGNED_SHORT) {
+			packedIndices.resize(subMesh.numIndices + numLodIndices);
+			glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned short) * subMesh.firstIndex,
+				sizeof(unsigned short) * packedIndices.size(), packedIndices.data());
+			for (size_t i = 0; i < subMesh.numIndices; ++i)
+				subMesh.vertexIndices[i] = packedIndices[i] + (unsigned int)subMesh.baseVertex;
+			for (size_t i = 0; i < numLodIndices; ++i)
+				subMesh.lodIndices[i] = packedIndices[subMesh.numIndices + i] + (unsigned int)subMesh.baseVertex;
+		}
+		else {
+			glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * subMesh.firstIndex,
+				sizeof(unsigned int) * subMesh.numIndices, subMesh.vertexIndices.data());
+			glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * (subMesh.firstIndex + subMesh.numIndices),
+				sizeof(unsigned int) * numLodIndices, subMesh.lodIndices.data());
+		}
+	}
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// Vertices as the vertex buffer holds them, decoded to VertexPTN.
+void TriangleMesh::ReadBackVertices(std::vector<VertexPTN>& readVertices) const
+{
+	readVertices.resize(numVertices);
+	glBindBuffer(GL_ARRAY_BUFFER, vboId);
+	if (compactBuffers) {
+		std::vector<VertexCompact> compact(numVertices);
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(VertexCompact) * compact.size(), compact.data());
+		for (size_t i = 0; i < compact.size(); ++i)
+			readVertices[i] = DecodeCompactVertex(compact[i], dequantizeMatrix);
+	}
+	else glGetBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(VertexPTN) * readVertices.size(), readVertices.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Copy the distinct diffuse maps of the largest (internal format, size, levels) group into the layers
+// of a texture array of that format, level by level as stored. Maps of other groups stay 2D and their
+// SubMeshes are marked to be drawn on their own.
+void TriangleMesh::CreateTextureArray()
+{
+	struct LayerFormat
+	{
+		GLint internalFormat;
+		GLint width;
+		GLint height;
+		int numLevels;
+		bool operator<(const LayerFormat& other) const {
+			return std::tie(internalFormat, width, height, numLevels)
+				< std::tie(other.internalFormat, other.width, other.height, other.numLevels);
+		}
+	};
+	//Group the Maps by What glCopyImageSubData Needs to Match, in materialMap Order
+	std::map<LayerFormat, std::vector<ImageTexture*>> groups;
+	std::map<ImageTexture*, LayerFormat> formats;
+	for (auto& element : materialMap) {
+		ImageTexture* texture = element.second.GetMapKd();
+		if (texture == nullptr || texture->GetTextureId() == 0 || formats.count(texture) != 0)
+			continue;
+		LayerFormat format = { 0, 0, 0, 0 };
+		glBindTexture(GL_TEXTURE_2D, texture->GetTextureId());
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format.internalFormat);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &format.width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &format.height);
+		// Levels down to the first one GL does not hold.
+		GLint levelWidth = format.width;
+		while (levelWidth > 0 && (std::max(format.width, format.height) >> format.numLevels) > 0) {
+			format.numLevels++;
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, format.numLevels, GL_TEXTURE_WIDTH, &levelWidth);
+		}
+		if (format.numLevels == 0)
+			continue;
+		formats[texture] = format;
+		groups[format].push_back(texture);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// The array takes the group most SubMeshes sample.
+	std::map<LayerFormat, int> numUsers;
+	for (const auto& subMesh : subMeshes) {
+		auto it = formats.find(subMesh.material->GetMapKd());
+		if (it != formats.end())
+			numUsers[it->second]++;
+	}
+	const std::vector<ImageTexture*>* layerTextures = nullptr;
+	LayerFormat layerFormat = { GL_RGBA8, 1, 1, 1 };
+	int mostUsers = 0;
+	for (const auto& group : groups) {
+		if (numUsers[group.first] > mostUsers) {
+			mostUsers = numUsers[group.first];
+			layerFormat = group.first;
+			layerTextures = &group.second;
+		}
+	}
+	std::map<ImageTexture*, int> layers;
+	if (layerTextures != nullptr) {
+		for (ImageTexture* texture : *layerTextures)
+			layers[texture] = (int)layers.size();
+	}
+	for (auto& subMesh : subMeshes) {
+		ImageTexture* texture = subMesh.material->GetMapKd();
+		auto it = layers.find(texture);
+		subMesh.textureLayer = (it != layers.end()) ? it->second : -1;
+		subMesh.multiDraw = (it != layers.end()) || formats.count(texture) == 0;
+	}
+
+	// Keep a 1x1 layer so the sampler is complete for untextured meshes.
+	const int numLayers = std::max(1, (int)layers.size());
+	glGenTextures(1, &textureArrayId);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArrayId);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, layerFormat.numLevels, layerFormat.internalFormat,
+		layerFormat.width, layerFormat.height, numLayers);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	//Copy Every Level of Each Map into Its Layer; Compressed Blocks and Filtered Mips Are Kept As They Are
+	textureArrayBytes = 0;
+	for (const auto& element : layers) {
+		for (int level = 0; level < layerFormat.numLevels; ++level) {
+			const GLsizei width = std::max(1, layerFormat.width >> level);
+			const GLsizei height = std::max(1, layerFormat.height >> level);
+			glCopyImageSubData(element.first->GetTextureId(), GL_TEXTURE_2D, level, 0, 0, 0,
+				textureArrayId, GL_TEXTURE_2D_ARRAY, level, 0, 0, element.second, width, height, 1);
+		}
+		textureArrayBytes += element.first->GetGpuBytes();
+	}
+}
+
+// Delete Vertex and Index Buffer
+void TriangleMesh::ReleaseBuffers()
+{
+	// Buffers only exist once CreateBuffer ran; a mesh loaded without GL must not call into it.
+	if (vaoId != 0)
+		glDeleteVertexArrays(1, &vaoId);
+	vaoId = 0;
+	if (iboId != 0)
+		glDeleteBuffers(1, &iboId);
+	iboId = 0;
+	if (vboId != 0)
+		glDeleteBuffers(1, &vboId);
+	vboId = 0;
+	if (drawDataBufferId != 0)
+		glDeleteBuffers(1, &drawDataBufferId);
+	drawDataBufferId = 0;
+	if (textureArrayId != 0)
+		glDeleteTextures(1, &textureArrayId);
+	textureArrayId = 0;
+	textureArrayBytes = 0;
+	multiDrawReady = false;
+	for (auto& subMesh : subMeshes) {
+		subMesh.textureLayer = -1;
+		subMesh.multiDraw = true;
+	}
+	materialBuffer.Release();
+}
+
+
+// Render SubMesh
+void TriangleMesh::Render(const SubMesh& subMesh) {
+	// Draw SubMesh; the vertex array carries the layout and the index buffer.
+	glBindVertexArray(vaoId);
+	const size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int);
+	if (subMesh.lod > 0) {
+		const SubMeshLod& lod = subMesh.lods[subMesh.lod - 1];
+		glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)lod.numIndices, indexType,
+			(GLvoid*)((subMesh.firstIndex + subMesh.numIndices + lod.firstIndex) * indexSize), subMesh.baseVertex);
+	}
+	else if (clusterCulling) {
+		if (!subMesh.drawCounts.empty())
+			glMultiDrawElementsBaseVertex(GL_TRIANGLES, const_cast<GLsizei*>(subMesh.drawCounts.data()), indexType,
+				const_cast<GLvoid**>(subMesh.drawOffsets.data()), (GLsizei)subMesh.drawCounts.size(), const_cast<GLint*>(subMesh.drawBaseVertices.data()));
+	}
+	else glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)subMesh.numIndices, indexType,
+		(GLvoid*)(subMesh.firstIndex * indexSize), subMesh.baseVertex);
+}
+
+void TriangleMesh::SetInstanceBuffer(const GLuint buffer, const size_t offset)
+{
+	glBindVertexArray(vaoId);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (GLuint column = 0; column < 8; ++column) {
+		const GLuint location = 4 + column;
+		if (buffer == 0) {
+			glDisableVertexAttribArray(location);
+			continue;
+		}
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const GLvoid*)(offset + column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(location, 1);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TriangleMesh::RenderInstanced(const SubMesh& subMesh, const int lod, const int numInstances)
+{
+	glBindVertexArray(vaoId);
+	const size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int);
+	if (lod > 0) {
+		const SubMeshLod& level = subMesh.lods[lod - 1];
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)level.numIndices, indexType,
+			(GLvoid*)((subMesh.firstIndex + subMesh.numIndices + level.firstIndex) * indexSize), numInstances, subMesh.baseVertex);
+	}
+	else glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)subMesh.numIndices, indexType,
+		(GLvoid*)(subMesh.firstIndex * indexSize), numInstances, subMesh.baseVertex);
+}
+
+bool TriangleMesh::IsMultiDrawSupported()
+{
+	return GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance && GLEW_ARB_texture_storage
+		&& GLEW_ARB_copy_image);
+}
+
+int TriangleMesh::GetMaxDrawCommands() const
+{
+	int numCommands = 0;
+	for (const SubMesh& subMesh : subMeshes) {
+		if (!subMesh.visible || !subMesh.multiDraw)
+			continue;
+		numCommands += (subMesh.lod == 0 && clusterCulling) ? (int)subMesh.drawCounts.size() : 1;
+	}
+	return numCommands;
+}
+
+// Same ranges Render draws, as one command each.
+int TriangleMesh::WriteDrawCommands(DrawElementsIndirectCommand* commands) const
+{
+	const size_t indexSize = (indexType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int);
+	int numCommands = 0;
+	for (size_t i = 0; i < subMeshes.size(); ++i) {
+		const SubMesh& subMesh = subMeshes[i];
+		if (!subMesh.visible || !subMesh.multiDraw)
+			continue;
+		DrawElementsIndirectCommand command;
+		command.instanceCount = 1;
+		command.baseVertex = subMesh.baseVertex;
+		command.baseInstance = (GLuint)i;
+		if (subMesh.lod > 0) {
+			const SubMeshLod& lod = subMesh.lods[subMesh.lod - 1];
+			command.count = lod.numIndices;
+			command.firstIndex = subMesh.firstIndex + subMesh.numIndices + lod.firstIndex;
+			commands[numCommands++] = command;
+		}
+		else if (clusterCulling) {
+			for (size_t range = 0; range < subMesh.drawCounts.size(); ++range) {
+				command.count = (GLuint)subMesh.drawCounts[range];
+				command.firstIndex = (GLuint)((size_t)subMesh.drawOffsets[range] / indexSize);
+				commands[numCommands++] = command;
+			}
+		}
+		else {
+			command.count = (GLuint)subMesh.numIndices;
+			command.firstIndex = subMesh.firstIndex;
+			commands[numCommands++] = command;
+		}
+	}
+	return numCommands;
+}
+
+void TriangleMesh::RenderMultiDraw(const GLuint indirectBuffer, const size_t offset, const int numCommands)
+{
+	// Unit 0's 2D binding is untouched, so callers tracking it stay in sync.
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArrayId);
+	glBindVertexArray(vaoId);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, (const GLvoid*)offset, numCommands, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
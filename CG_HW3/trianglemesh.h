@@ -1,91 +1,372 @@
-#ifndef TRIANGLEMESH_H
-#define TRIANGLEMESH_H
-
-#include "headers.h"
-#include "material.h"
-
-// VertexPTN Declarations.
-struct VertexPTN
-{
-	VertexPTN() {
-		position = glm::vec3(0.0f, 0.0f, 0.0f);
-		normal = glm::vec3(0.0f, 1.0f, 0.0f);
-		texcoord = glm::vec2(0.0f, 0.0f);
-	}
-	VertexPTN(glm::vec3 p, glm::vec3 n, glm::vec2 uv) {
-		position = p;
-		normal = n;
-		texcoord = uv;
-	}
-	glm::vec3 position;
-	glm::vec3 normal;
-	glm::vec2 texcoord;
-};
-
-// SubMesh Declarations.
-struct SubMesh
-{
-	SubMesh() {
-		material = nullptr;
-		iboId = 0;
-	}
-	PhongMaterial* material;
-	GLuint iboId;
-	std::vector<unsigned int> vertexIndices;
-};
-
-
-// TriangleMesh Declarations.
-class TriangleMesh
-{
-public:
-	// TriangleMesh Public Methods.
-	TriangleMesh();
-	~TriangleMesh();
-	
-	// Load the model from an *.OBJ file.
-	bool LoadFromFile(const std::string& filePath, const bool normalized = true);
-	bool LoadMtlFile(const std::string& filePath, const std::string& folderPath);
-
-	// Show model information.
-	void ShowInfo();
-
-	int GetNumVertices() const { return numVertices; }
-	int GetNumTriangles() const { return numTriangles; }
-	int GetNumSubMeshes() const { return (int)subMeshes.size(); }
-
-	glm::vec3 GetObjCenter() const { return objCenter; }
-	glm::vec3 GetObjExtent() const { return objExtent; }
-
-	// Get SubMeshes
-	const std::vector<SubMesh>& GetSubMeshes() const { return subMeshes; }
-
-	// Create Vertex and Index Buffer
-	void CreateBuffer();
-
-	void Render(SubMesh subMesh);
-
-private:
-	// TriangleMesh Private Data.
-	GLuint vboId;
-	
-	std::vector<VertexPTN> vertices;
-	// For supporting multiple materials per object, move to SubMesh.
-	// GLuint iboId;
-	// std::vector<unsigned int> vertexIndices;
-	std::vector<SubMesh> subMeshes;
-
-	// Material Map For Mapping Material Flag to PhongMaterial Data
-	std::map<std::string, PhongMaterial> materialMap;
-
-	// Vertices Index Map
-	std::map<std::string, int> vertexIdMap;
-
-	int numVertices;
-	int numTriangles;
-	glm::vec3 objCenter;
-	glm::vec3 objExtent;
-};
-
-
-#endif
+#ifndef TRIANGLEMESH_H
+#define TRIANGLEMESH_H
+
+#include "headers.h"
+#include "material.h"
+#include "objparser.h"
+#include "vertexcache.h"
+#include "meshlet.h"
+#include "frustum.h"
+#include "occlusionculler.h"
+#include "uniformbuffer.h"
+
+// VertexPTN Declarations.
+struct VertexPTN
+{
+	VertexPTN() {
+		position = glm::vec3(0.0f, 0.0f, 0.0f);
+		normal = glm::vec3(0.0f, 1.0f, 0.0f);
+		texcoord = glm::vec2(0.0f, 0.0f);
+	}
+	VertexPTN(glm::vec3 p, glm::vec3 n, glm::vec2 uv) {
+		position = p;
+		normal = n;
+		texcoord = uv;
+	}
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 texcoord;
+};
+
+// VertexCompact Declarations.
+// 16-byte GPU copy of a VertexPTN: snorm16 position inside the mesh bounds (undone by the
+// dequantize matrix), snorm16 octahedral normal and half-float texcoord.
+struct VertexCompact
+{
+	short position[4];			// xyz; w only pads the normal to a 4-byte offset.
+	short normal[2];
+	unsigned short texcoord[2];
+};
+
+// SubMeshLod Declarations.
+// A simplified copy of a SubMesh's triangles, stored as a range of SubMesh::lodIndices.
+struct SubMeshLod
+{
+	unsigned int firstIndex;
+	unsigned int numIndices;
+	float error;		// Worst surface deviation from LOD 0, in model units.
+};
+
+// SubMesh Declarations.
+struct SubMesh
+{
+	SubMesh() {
+		material = nullptr;
+		materialIndex = 0;
+		textureLayer = -1;
+		multiDraw = true;
+		firstIndex = 0;
+		baseVertex = 0;
+		numIndices = 0;
+		minIndex = 0;
+		maxIndex = 0;
+		lod = 0;
+		boundsCenter = glm::vec3(0.0f, 0.0f, 0.0f);
+		boundsExtent = glm::vec3(0.0f, 0.0f, 0.0f);
+		boundsRadius = 0.0f;
+		visible = true;
+	}
+	PhongMaterial* material;
+	// Element of material in the mesh's material buffer, and layer of its diffuse map in the
+	// mesh's texture array (-1: none); both set by CreateBuffer.
+	int materialIndex;
+	int textureLayer;
+	// False if the diffuse map did not fit the texture array; the SubMesh is then left out of
+	// WriteDrawCommands and drawn on its own.
+	bool multiDraw;
+	// Where the SubMesh's indices start in the mesh's index buffer; 16-bit indices are stored
+	// relative to baseVertex.
+	unsigned int firstIndex;
+	GLint baseVertex;
+	// Size of vertexIndices and the vertices it spans, recorded by CreateBuffer so they stay
+	// known once the CPU copies are released.
+	unsigned int numIndices;
+	unsigned int minIndex;
+	unsigned int maxIndex;
+	std::vector<unsigned int> vertexIndices;
+	std::vector<Meshlet> meshlets;
+	// LOD 1.. (LOD 0 is vertexIndices); the index buffer holds vertexIndices then lodIndices.
+	std::vector<unsigned int> lodIndices;
+	std::vector<SubMeshLod> lods;
+	int lod;			// Level SelectLod picked; meshlet culling only applies to LOD 0.
+	// Model-space bounds of the triangles, computed at load time.
+	glm::vec3 boundsCenter;
+	glm::vec3 boundsExtent;		// Half size of the box.
+	float boundsRadius;			// Sphere around boundsCenter.
+	bool visible;		// Result of the last CullSubMeshes.
+	// Index ranges that survived the last CullClusters, adjacent meshlets merged into one draw.
+	std::vector<GLsizei> drawCounts;
+	std::vector<const GLvoid*> drawOffsets;
+	std::vector<GLint> drawBaseVertices;
+	// Coarsest LOD into the mesh's occluderPositions, kept by ReleaseCpuCopies for AddOccluders.
+	std::vector<unsigned int> occluderIndices;
+};
+
+
+// DrawElementsIndirectCommand Declarations.
+// Layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER.
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;		// Selects the SubMesh's draw data (material index, texture layer).
+};
+
+// InstanceData Declarations.
+// Per-instance attributes of an instanced draw (locations 4-7 and 8-11, one column each).
+struct InstanceData
+{
+	glm::mat4x4 worldMatrix;		// Dequantization folded in, like the worldMatrix uniform.
+	glm::mat4x4 normalMatrix;
+};
+
+// Source file a TriangleMesh is built from when no mesh cache applies.
+enum MeshSource
+{
+	MESH_SOURCE_AUTO,	// Whichever of .obj / .objm is estimated to ingest faster.
+	MESH_SOURCE_OBJ,
+	MESH_SOURCE_OBJM	// Pre-expanded "vtx p uv n" records, already normalized.
+};
+
+// MeshLoadStats Declarations.
+// Where the last LoadFromFile spent its time (wall clock, seconds).
+struct MeshLoadStats
+{
+	MeshLoadStats() {
+		sourceBytes = 0;
+		fromCache = false;
+		parseSeconds = 0.0;
+		weldSeconds = 0.0;
+		normalizeSeconds = 0.0;
+		optimizeSeconds = 0.0;
+		lodSeconds = 0.0;
+		materialSeconds = 0.0;
+		textureSeconds = 0.0;
+		cacheSeconds = 0.0;
+	}
+	size_t sourceBytes;			// Size of the .obj / .objm that was parsed (0 on a cache hit).
+	bool fromCache;
+	double parseSeconds;		// Tokenizing the source into chunks.
+	double weldSeconds;			// Welding corners into vertices and building the index lists.
+	double normalizeSeconds;
+	double optimizeSeconds;		// Vertex cache reordering, first-use renumbering and meshlet building.
+	double lodSeconds;			// Simplifying the LOD chain (0 on a cache hit, the cache stores it).
+	double materialSeconds;		// MTL files, including textureSeconds.
+	double textureSeconds;		// Image decoding, all images at once (and the upload unless it is deferred).
+	double cacheSeconds;		// Reading or writing the .meshbin.
+};
+
+// TriangleMesh Declarations.
+class TriangleMesh
+{
+public:
+	// TriangleMesh Public Methods.
+	TriangleMesh();
+	~TriangleMesh();
+	
+	// Load the model from <name>.obj or <name>.objm in the folder filePath.
+	// numThreads: 1 parses serially, 0 uses every core of the shared pool, N caps the chunk fan-out.
+	bool LoadFromFile(const std::string& filePath, const bool normalized = true, const int numThreads = 1);
+	// The map_Kd images are decoded concurrently (numThreads as in LoadFromFile), then uploaded
+	// here on the calling thread unless uploads are deferred.
+	bool LoadMtlFile(const std::string& filePath, const std::string& folderPath, const int numThreads = 1);
+
+	// Reuse / write <name>.meshbin next to the model (on by default).
+	void SetMeshCacheEnabled(const bool enabled) { meshCacheEnabled = enabled; }
+	void SetMeshSource(const MeshSource source) { meshSource = source; }
+	// Decode textures without touching GL, so LoadFromFile can run on a worker thread.
+	// LoadFromFile then also packs the buffer contents, and the GL side is done by the tasks
+	// from AppendUploadTasks.
+	void SetDeferredUploads(const bool deferred) { deferredUploads = deferred; }
+	// Reorder triangles for the post-transform cache and vertices for fetch locality after
+	// loading (on by default). The cache stores the reordered mesh.
+	void SetOptimizeVertexOrder(const bool optimize) { optimizeVertexOrder = optimize; }
+	// Upload VertexCompact vertices, and 16-bit indices where a SubMesh spans fewer than
+	// 65536 vertices, instead of full floats. Takes effect at the next CreateBuffer.
+	void SetCompactVertices(const bool compact) { compactVertices = compact; }
+	bool UsesCompactVertices() const { return compactBuffers; }
+	// CPU_RESIDENCY_RELEASE (default): CreateBuffer frees the vertices and index lists once they
+	// are uploaded. RestoreCpuCopies reads them back from the buffers, e.g. before ReleaseBuffers
+	// and CreateBuffer rebuild them. Compact buffers read back as their quantized vertices, so
+	// that is lossy: reload the model rather than rebuild float buffers from them.
+	void SetCpuResidency(const CpuResidency residency) { cpuResidency = residency; }
+	void RestoreCpuCopies();
+	bool HasCpuCopies() const { return !cpuCopiesReleased; }
+
+	// Mark the SubMeshes whose bounds, placed by worldMatrix, intersect the world-space frustum.
+	// The whole mesh is tested first. Returns the number of visible SubMeshes.
+	int CullSubMeshes(const Frustum& frustum, const glm::mat4x4& worldMatrix);
+	int GetNumVisibleSubMeshes() const;
+	// Occlusion culling after CullSubMeshes: feed the largest visible SubMeshes to the culler's
+	// depth buffer (at most maxTriangles), then, once it is rasterized, hide the SubMeshes
+	// whose boxes it finds occluded. Returns the number hidden.
+	// Once the CPU copies are released, each SubMesh occludes with the coarsest LOD kept for it.
+	void AddOccluders(OcclusionCuller& culler, const glm::mat4x4& worldMatrix, const int maxTriangles);
+	int CullOccludedSubMeshes(OcclusionCuller& culler);
+	// Draw only the meshlets the last CullClusters kept.
+	void SetClusterCulling(const bool enabled) { clusterCulling = enabled; }
+	bool GetClusterCulling() const { return clusterCulling; }
+	// Keep the meshlets that intersect the frustum of modelViewProj and do not face away from
+	// cameraPos; both are in model space (projection * view * world, and the inverse world of the eye).
+	void CullClusters(const glm::mat4x4& modelViewProj, const glm::vec3& cameraPos);
+	// Per SubMesh, use the coarsest LOD whose error covers at most maxPixelError pixels when one
+	// model unit covers pixelsPerUnit pixels. A negative maxPixelError forces LOD 0.
+	void SelectLod(const float pixelsPerUnit, const float maxPixelError);
+	// The level SelectLod would pick for one SubMesh, without storing it.
+	int GetLodLevel(const SubMesh& subMesh, const float pixelsPerUnit, const float maxPixelError) const;
+	// Triangles the next Render calls draw for the visible SubMeshes, after LOD selection and culling.
+	int GetNumSubmittedTriangles() const;
+
+	// Show model information.
+	void ShowInfo();
+	// Compare the GPU footprint of the float and compact layouts, with the compact quantization error,
+	// and show the CPU copies still held next to the buffers.
+	void ShowMemoryReport();
+
+	int GetNumVertices() const { return numVertices; }
+	int GetNumTriangles() const { return numTriangles; }
+	int GetNumSubMeshes() const { return (int)subMeshes.size(); }
+	int GetNumMeshlets() const;
+	// Time spent mapping, parsing and welding the source file in the last LoadFromFile.
+	double GetIngestSeconds() const { return loadStats.parseSeconds + loadStats.weldSeconds; }
+	const MeshLoadStats& GetLoadStats() const { return loadStats; }
+	// Post-transform cache behaviour of the file's triangle order and of the current one.
+	const VertexCacheStats& GetSourceCacheStats() const { return sourceCacheStats; }
+	const VertexCacheStats& GetCacheStats() const { return cacheStats; }
+
+	glm::vec3 GetObjCenter() const { return objCenter; }
+	glm::vec3 GetObjExtent() const { return objExtent; }
+	// Model-space bounds of all SubMeshes (box center / half extent, and the sphere around the center).
+	glm::vec3 GetBoundsCenter() const { return boundsCenter; }
+	glm::vec3 GetBoundsExtent() const { return boundsExtent; }
+	float GetBoundingRadius() const { return boundsRadius; }
+	// Maps the vertex buffer positions back to model space; fold it into the world matrix.
+	// Identity unless the buffers were created compact.
+	glm::mat4x4 GetDequantizeMatrix() const { return dequantizeMatrix; }
+
+	// Get SubMeshes
+	const std::vector<SubMesh>& GetSubMeshes() const { return subMeshes; }
+
+	// Create Vertex and Index Buffer
+	void CreateBuffer();
+	void ReleaseBuffers();
+	// Every material as a MaterialUniforms array, padded to whole MATERIALS_PER_BLOCK windows;
+	// a SubMesh's window starts at element materialIndex - materialIndex % MATERIALS_PER_BLOCK.
+	const UniformBuffer& GetMaterialBuffer() const { return materialBuffer; }
+	// GL work left by a deferred load, in execution order: texture uploads, then CreateBuffer as
+	// allocation, ranged copies of at most 1 MB, finish and release of the CPU copies.
+	void AppendUploadTasks(std::vector<std::function<void()>>& tasks);
+
+	void Render(const SubMesh& subMesh);
+
+	// Instancing: point the per-instance attributes at InstanceData from offset in buffer (0 detaches
+	// them), then draw numInstances copies of a SubMesh at one LOD. Ignores culling state.
+	void SetInstanceBuffer(const GLuint buffer, const size_t offset);
+	void RenderInstanced(const SubMesh& subMesh, const int lod, const int numInstances);
+
+	// Multi-draw indirect (GL 4.3 or ARB_multi_draw_indirect + ARB_base_instance + ARB_copy_image):
+	// every visible SubMesh in one call, with per-draw materials from the material buffer and diffuse
+	// maps from one texture array. Needs a program built with MULTI_DRAW.
+	static bool IsMultiDrawSupported();
+	// False if unsupported, or the mesh has more materials than one MaterialUniforms window.
+	bool CanMultiDraw() const { return multiDrawReady; }
+	// Visible SubMeshes whose multiDraw is false still need a draw of their own.
+	// Upper bound on the commands WriteDrawCommands emits for the current culling and LOD state.
+	int GetMaxDrawCommands() const;
+	// Returns the number of commands written.
+	int WriteDrawCommands(DrawElementsIndirectCommand* commands) const;
+	// Draw numCommands commands from offset in indirectBuffer.
+	void RenderMultiDraw(const GLuint indirectBuffer, const size_t offset, const int numCommands);
+
+private:
+	// TriangleMesh Private Methods.
+	void MergeObjChunks(std::vector<ObjChunk>& chunks);
+	void MergeObjmChunks(std::vector<ObjChunk>& chunks);
+	bool LoadMeshCache(const std::string& cachePath, const std::string& folderPath, const bool normalized, const int numThreads);
+	void SaveMeshCache(const std::string& cachePath, const std::string& folderPath,
+		const std::string& sourceFileName, const int sourceType, const bool normalized);
+	void OptimizeVertexOrder(const int numThreads);
+	VertexCacheStats AnalyzeVertexCache() const;
+	void BuildMeshlets(const int numThreads);
+	void ComputeBounds(const int numThreads);
+	void BuildLods(const int numThreads);
+	void GetPositionBounds(glm::vec3& center, glm::vec3& halfExtent) const;
+	// CreateBuffer in steps. PackBuffers needs no GL context; the others run on the GL thread in
+	// this order, UploadBufferRange once per range of GL_ARRAY_BUFFER / GL_ELEMENT_ARRAY_BUFFER.
+	void PackBuffers();
+	size_t GetVertexBufferBytes() const;
+	void AllocateBuffers();
+	void UploadBufferRange(const GLenum target, const size_t offset, const size_t size);
+	void FinishBuffers();
+	void CreateTextureArray();
+	void ReleaseCpuCopies();
+	void BuildOccluderProxy();
+	void ReadBackIndices();
+	void ReadBackVertices(std::vector<VertexPTN>& readVertices) const;
+
+	// TriangleMesh Private Data.
+	GLuint vboId;
+	// Indices of every SubMesh back to back, and the vertex array every SubMesh draws with.
+	GLuint iboId;
+	GLuint vaoId;
+	GLenum indexType;
+	UniformBuffer materialBuffer;
+	// Per SubMesh: materialIndex and textureLayer, read through the command's base instance.
+	GLuint drawDataBufferId;
+	// Diffuse maps of one internal format and size, their levels copied as stored (no decoding).
+	GLuint textureArrayId;
+	size_t textureArrayBytes;
+	bool multiDrawReady;
+	
+	std::vector<VertexPTN> vertices;
+	// Contents of the buffers between PackBuffers and FinishBuffers. Float vertices upload from
+	// vertices directly.
+	std::vector<VertexCompact> packedVertices;
+	std::vector<unsigned char> packedIndices;
+	std::vector<MaterialUniforms> packedMaterials;
+	bool buffersPacked;
+	// Positions the SubMeshes' occluderIndices use, kept for AddOccluders while the vertices are released.
+	std::vector<glm::vec3> occluderPositions;
+	CpuResidency cpuResidency;
+	bool cpuCopiesReleased;
+	// For supporting multiple materials per object, move to SubMesh.
+	// std::vector<unsigned int> vertexIndices;
+	std::vector<SubMesh> subMeshes;
+
+	// Material Map For Mapping Material Flag to PhongMaterial Data
+	std::map<std::string, PhongMaterial> materialMap;
+	// Material libraries named by mtllib, relative to the model folder.
+	std::vector<std::string> mtlLibs;
+
+	bool meshCacheEnabled;
+	MeshSource meshSource;
+	bool deferredUploads;
+	bool optimizeVertexOrder;
+	bool compactVertices;
+	bool clusterCulling;
+	bool compactBuffers;		// Layout of the buffers CreateBuffer made (or PackBuffers packed).
+	glm::mat4x4 dequantizeMatrix;
+	glm::vec3 compactError;		// Compact round-trip error, measured by CreateBuffer when compactBuffers.
+	MeshLoadStats loadStats;
+	VertexCacheStats sourceCacheStats;
+	VertexCacheStats cacheStats;
+	static std::atomic<double> sourceBytesPerSecond[3];
+
+	int numVertices;
+	int numTriangles;
+	glm::vec3 objCenter;
+	glm::vec3 objExtent;
+	glm::vec3 boundsCenter;
+	glm::vec3 boundsExtent;
+	float boundsRadius;
+	// World-space SubMesh boxes and results of CullSubMeshes, kept to reuse their storage.
+	BoxBatch cullBoxes;
+	std::vector<unsigned char> cullResults;
+	// SubMeshes by decreasing bounding radius.
+	std::vector<int> occluderOrder;
+};
+
+
+#endif
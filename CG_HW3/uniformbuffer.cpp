@@ -0,0 +1,38 @@
+#include "uniformbuffer.h"
+
+UniformBuffer::UniformBuffer()
+{
+	bufferId = 0;
+	bufferSize = 0;
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	Release();
+}
+
+void UniformBuffer::Create(const size_t size, const void* data)
+{
+	Release();
+	glGenBuffers(1, &bufferId);
+	glBindBuffer(GL_UNIFORM_BUFFER, bufferId);
+	glBufferData(GL_UNIFORM_BUFFER, size, data, data != nullptr ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	bufferSize = size;
+}
+
+void UniformBuffer::Release()
+{
+	// Only a created buffer touches GL, so an unused one can be destroyed without a context.
+	if (bufferId != 0)
+		glDeleteBuffers(1, &bufferId);
+	bufferId = 0;
+	bufferSize = 0;
+}
+
+void UniformBuffer::Update(const void* data, const size_t size, const size_t offset)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, bufferId);
+	glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,69 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include "headers.h"
+
+// Binding points of the uniform blocks; ShaderProg attaches the blocks it finds by name.
+enum UniformBlockBinding
+{
+	UNIFORM_BLOCK_FRAME = 0,		// "FrameUniforms": camera and lights.
+	UNIFORM_BLOCK_MATERIALS = 1,	// "MaterialUniforms": one window of a mesh's materials.
+	NUM_UNIFORM_BLOCKS = 2
+};
+
+// Materials in one MaterialUniforms window; must match the array size in phong_shading_demo.fs.
+// 256 * 48 bytes fits the 16 KB every GL 3.3 implementation allows per block, and is a
+// multiple of every uniform buffer offset alignment in practice.
+#define MATERIALS_PER_BLOCK 256
+
+// FrameUniforms Declarations.
+// std140 mirror of the FrameUniforms block; vec3s are padded to vec4.
+struct FrameUniforms
+{
+	glm::mat4x4 viewProjMatrix;
+	glm::vec4 cameraPos;
+	glm::vec4 ambientLight;
+	glm::vec4 dirLightDir;
+	glm::vec4 dirLightRadiance;
+	glm::vec4 pointLightPos;
+	glm::vec4 pointLightIntensity;
+	glm::vec4 spotLightPos;
+	glm::vec4 spotLightIntensity;
+	glm::vec4 spotLightDir;
+	glm::vec4 spotLightCone;		// Total width, falloff start (degrees), then their cosines.
+	int lightingMode;
+	int padding[3];
+};
+
+// MaterialUniforms Declarations.
+// std140 mirror of one element of the MaterialUniforms array.
+struct MaterialUniforms
+{
+	glm::vec4 Ka;
+	glm::vec4 Kd;		// w: 1 if the diffuse texture replaces Kd.
+	glm::vec4 Ks;		// w: Ns.
+};
+
+// UniformBuffer Declarations.
+class UniformBuffer
+{
+public:
+	// UniformBuffer Public Methods.
+	UniformBuffer();
+	~UniformBuffer();
+
+	// Allocate size bytes (contents undefined unless data is given).
+	void Create(const size_t size, const void* data = nullptr);
+	void Release();
+	void Update(const void* data, const size_t size, const size_t offset = 0);
+
+	GLuint GetBufferId() const { return bufferId; }
+	size_t GetSize() const { return bufferSize; }
+
+private:
+	// UniformBuffer Private Data.
+	GLuint bufferId;
+	size_t bufferSize;
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "vertexcache.h"
+
+#include <cmath>
+#include <algorithm>
+
+// Forsyth's scoring: the cache model is LRU; the three most recent vertices get a flat score so
+// the strip-like order does not flip, older entries fall off with a power curve, and vertices
+// with few triangles left are boosted so they get finished and leave the working set.
+static const int kCacheSize = 32;
+static const int kMaxValence = 32;
+static const float kLastTriangleScore = 0.75f;
+static const float kCacheDecayPower = 1.5f;
+static const float kValenceBoostScale = 2.0f;
+static const float kValenceBoostPower = 0.5f;
+
+struct ScoreTables
+{
+	ScoreTables() {
+		for (int i = 0; i < kCacheSize; ++i) {
+			if (i < 3)
+				cache[i] = kLastTriangleScore;
+			else
+				cache[i] = std::pow(1.0f - (float)(i - 3) / (kCacheSize - 3), kCacheDecayPower);
+		}
+		valence[0] = 0.0f;
+		for (int i = 1; i <= kMaxValence; ++i)
+			valence[i] = kValenceBoostScale * std::pow((float)i, -kValenceBoostPower);
+	}
+	float cache[kCacheSize];
+	float valence[kMaxValence + 1];
+};
+
+static float VertexScore(const ScoreTables& tables, const int cachePosition, const int remaining)
+{
+	// No triangles left: the vertex must not attract anything.
+	if (remaining == 0)
+		return -1.0f;
+	float score = (cachePosition >= 0) ? tables.cache[cachePosition] : 0.0f;
+	return score + tables.valence[std::min(remaining, kMaxValence)];
+}
+
+void VertexCacheOptimizer::OptimizeTriangleOrder(std::vector<unsigned int>& indices, const size_t numVertices)
+{
+	static const ScoreTables tables;
+	const size_t numTriangles = indices.size() / 3;
+	if (numTriangles < 2)
+		return;
+
+	//Triangles of Each Vertex, as One Flat Array Sliced by Offsets
+	std::vector<unsigned int> offsets(numVertices + 1, 0);
+	for (size_t i = 0; i < numTriangles * 3; ++i)
+		offsets[indices[i] + 1]++;
+	for (size_t v = 0; v < numVertices; ++v)
+		offsets[v + 1] += offsets[v];
+	std::vector<unsigned int> adjacency(numTriangles * 3);
+	std::vector<int> remaining(numVertices, 0);
+	for (size_t t = 0; t < numTriangles; ++t) {
+		for (int k = 0; k < 3; ++k) {
+			const unsigned int v = indices[t * 3 + k];
+			adjacency[offsets[v] + remaining[v]++] = (unsigned int)t;
+		}
+	}
+
+	std::vector<int> cachePosition(numVertices, -1);
+	std::vector<float> vertexScore(numVertices);
+	for (size_t v = 0; v < numVertices; ++v)
+		vertexScore[v] = VertexScore(tables, -1, remaining[v]);
+	std::vector<char> emitted(numTriangles, 0);
+	long long bestTriangle = -1;
+	float bestScore = -1.0f;
+	for (size_t t = 0; t < numTriangles; ++t) {
+		const float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if (score > bestScore) {
+			bestScore = score;
+			bestTriangle = (long long)t;
+		}
+	}
+
+	std::vector<unsigned int> output;
+	output.reserve(numTriangles * 3);
+	unsigned int cache[kCacheSize + 3];
+	int cacheCount = 0;
+	size_t nextUnemitted = 0;
+	while (output.size() < numTriangles * 3) {
+		//Nothing in the Cache Touches a Live Triangle: Restart from the First Unemitted One
+		if (bestTriangle < 0) {
+			while (emitted[nextUnemitted])
+				nextUnemitted++;
+			bestTriangle = (long long)nextUnemitted;
+		}
+		const size_t t = (size_t)bestTriangle;
+		emitted[t] = 1;
+		const unsigned int* corners = &indices[t * 3];
+		for (int k = 0; k < 3; ++k) {
+			const unsigned int v = corners[k];
+			output.push_back(v);
+			unsigned int* first = &adjacency[offsets[v]];
+			unsigned int* last = first + remaining[v];
+			std::iter_swap(std::find(first, last, (unsigned int)t), last - 1);
+			remaining[v]--;
+		}
+
+		//Move the Triangle's Vertices to the Front of the LRU Cache
+		unsigned int newCache[kCacheSize + 3];
+		int newCount = 0;
+		for (int k = 0; k < 3; ++k)
+			newCache[newCount++] = corners[k];
+		for (int i = 0; i < cacheCount; ++i) {
+			const unsigned int v = cache[i];
+			if (v != corners[0] && v != corners[1] && v != corners[2])
+				newCache[newCount++] = v;
+		}
+
+		//Rescore Everything Whose Position Changed, Including the Entries That Fell Out
+		for (int i = 0; i < newCount; ++i) {
+			const unsigned int v = newCache[i];
+			cachePosition[v] = (i < kCacheSize) ? i : -1;
+			vertexScore[v] = VertexScore(tables, cachePosition[v], remaining[v]);
+		}
+		bestTriangle = -1;
+		bestScore = -1.0f;
+		for (int i = 0; i < newCount; ++i) {
+			const unsigned int v = newCache[i];
+			for (int j = 0; j < remaining[v]; ++j) {
+				const unsigned int u = adjacency[offsets[v] + j];
+				const float score = vertexScore[indices[u * 3]] + vertexScore[indices[u * 3 + 1]] + vertexScore[indices[u * 3 + 2]];
+				if (score > bestScore) {
+					bestScore = score;
+					bestTriangle = u;
+				}
+			}
+		}
+		cacheCount = std::min(newCount, kCacheSize);
+		std::copy(newCache, newCache + cacheCount, cache);
+	}
+	indices.swap(output);
+}
+
+VertexCacheStats VertexCacheOptimizer::Analyze(const std::vector<unsigned int>& indices, const size_t numVertices, const int cacheSize)
+{
+	VertexCacheStats stats;
+	stats.numTriangles = indices.size() / 3;
+	//A Vertex Is Cached While Fewer Than cacheSize Misses Happened Since It Was Loaded
+	std::vector<size_t> loadedAt(numVertices, 0);
+	size_t clock = (size_t)cacheSize + 1;
+	for (size_t i = 0; i < stats.numTriangles * 3; ++i) {
+		const unsigned int v = indices[i];
+		if (loadedAt[v] == 0)
+			stats.numReferenced++;
+		if (loadedAt[v] == 0 || clock - loadedAt[v] > (size_t)cacheSize) {
+			loadedAt[v] = clock++;
+			stats.numTransforms++;
+		}
+	}
+	return stats;
+}
@@ -0,0 +1,43 @@
+#ifndef VERTEX_CACHE_H
+#define VERTEX_CACHE_H
+
+#include <vector>
+#include <cstddef>
+
+// VertexCacheStats Declarations.
+// Post-transform cache behaviour of an index list, simulated as a FIFO cache. Counts can be
+// summed over several draws with Add; each draw starts with an empty cache.
+struct VertexCacheStats
+{
+	VertexCacheStats() {
+		numTriangles = 0;
+		numTransforms = 0;
+		numReferenced = 0;
+	}
+	void Add(const VertexCacheStats& other) {
+		numTriangles += other.numTriangles;
+		numTransforms += other.numTransforms;
+		numReferenced += other.numReferenced;
+	}
+	// Average cache miss ratio: vertex shader runs per triangle (0.5 is the ideal for large meshes).
+	double GetACMR() const { return numTriangles ? (double)numTransforms / numTriangles : 0.0; }
+	// Average transform to vertex ratio: vertex shader runs per distinct vertex (1.0 is ideal).
+	double GetATVR() const { return numReferenced ? (double)numTransforms / numReferenced : 0.0; }
+
+	size_t numTriangles;
+	size_t numTransforms;		// Cache misses.
+	size_t numReferenced;		// Distinct vertices the indices touch.
+};
+
+// VertexCacheOptimizer Declarations.
+class VertexCacheOptimizer
+{
+public:
+	// Reorder the triangles of a list for the post-transform cache (Forsyth's linear-speed
+	// algorithm on a 32-entry LRU cache model). Indices must be below numVertices.
+	static void OptimizeTriangleOrder(std::vector<unsigned int>& indices, const size_t numVertices);
+	// Simulate a FIFO cache of cacheSize entries over the index list.
+	static VertexCacheStats Analyze(const std::vector<unsigned int>& indices, const size_t numVertices, const int cacheSize = 16);
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "vertexwelder.h"
+#include <cstring>
+
+VertexWelder::VertexWelder()
+{
+	mask = 0;
+	numKeys = 0;
+}
+
+void VertexWelder::Reserve(const size_t expectedKeys)
+{
+	// Keep the load factor at or below 1/2.
+	size_t capacity = 16;
+	while (capacity < expectedKeys * 2)
+		capacity <<= 1;
+	if (capacity > slots.size())
+		Rehash(capacity);
+}
+
+void VertexWelder::Release()
+{
+	std::vector<Slot>().swap(slots);
+	mask = 0;
+	numKeys = 0;
+}
+
+uint32_t VertexWelder::Hash(const int p, const int t, const int n)
+{
+	uint32_t h = (uint32_t)p * 0x9E3779B1u;
+	h ^= (uint32_t)t * 0x85EBCA77u + (h << 6) + (h >> 2);
+	h ^= (uint32_t)n * 0xC2B2AE3Du + (h << 6) + (h >> 2);
+	// Final avalanche (murmur3 fmix32).
+	h ^= h >> 16;
+	h *= 0x85EBCA6Bu;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35u;
+	h ^= h >> 16;
+	return h;
+}
+
+int VertexWelder::FindOrInsert(const int p, const int t, const int n, bool& inserted)
+{
+	if ((numKeys + 1) * 4 > slots.size() * 3)
+		Rehash(slots.empty() ? 16 : slots.size() * 2);
+
+	// Linear probing.
+	size_t index = Hash(p, t, n) & mask;
+	for (;;) {
+		Slot& slot = slots[index];
+		if (slot.id < 0) {
+			slot.p = p;
+			slot.t = t;
+			slot.n = n;
+			slot.id = (int)numKeys++;
+			inserted = true;
+			return slot.id;
+		}
+		if (slot.p == p && slot.t == t && slot.n == n) {
+			inserted = false;
+			return slot.id;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+void VertexWelder::Rehash(const size_t newCapacity)
+{
+	std::vector<Slot> oldSlots;
+	oldSlots.swap(slots);
+	Slot empty = { 0, 0, 0, -1 };
+	slots.assign(newCapacity, empty);
+	mask = newCapacity - 1;
+	for (const Slot& slot : oldSlots) {
+		if (slot.id < 0) continue;
+		size_t index = Hash(slot.p, slot.t, slot.n) & mask;
+		while (slots[index].id >= 0)
+			index = (index + 1) & mask;
+		slots[index] = slot;
+	}
+}
+
+VertexBitWelder::VertexBitWelder(const size_t numWords)
+	: numWords(numWords)
+{
+	mask = 0;
+	numKeys = 0;
+}
+
+void VertexBitWelder::Reserve(const size_t expectedKeys)
+{
+	size_t capacity = 16;
+	while (capacity < expectedKeys * 2)
+		capacity <<= 1;
+	if (capacity > slots.size())
+		Rehash(capacity);
+	keys.reserve(expectedKeys * numWords);
+}
+
+void VertexBitWelder::Release()
+{
+	std::vector<Slot>().swap(slots);
+	std::vector<uint32_t>().swap(keys);
+	mask = 0;
+	numKeys = 0;
+}
+
+uint32_t VertexBitWelder::Hash(const uint32_t* key) const
+{
+	uint32_t h = 0x9E3779B1u;
+	for (size_t i = 0; i < numWords; ++i)
+		h ^= key[i] * 0x85EBCA77u + (h << 6) + (h >> 2);
+	h ^= h >> 16;
+	h *= 0x85EBCA6Bu;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35u;
+	h ^= h >> 16;
+	return h;
+}
+
+int VertexBitWelder::FindOrInsert(const uint32_t* key, bool& inserted)
+{
+	if ((numKeys + 1) * 4 > slots.size() * 3)
+		Rehash(slots.empty() ? 16 : slots.size() * 2);
+
+	// Linear probing; the cached hash rejects most mismatches without touching the keys.
+	const uint32_t hash = Hash(key);
+	size_t index = hash & mask;
+	for (;;) {
+		Slot& slot = slots[index];
+		if (slot.id < 0) {
+			slot.hash = hash;
+			slot.id = (int)numKeys++;
+			keys.insert(keys.end(), key, key + numWords);
+			inserted = true;
+			return slot.id;
+		}
+		if (slot.hash == hash && memcmp(GetKey(slot.id), key, numWords * sizeof(uint32_t)) == 0) {
+			inserted = false;
+			return slot.id;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+void VertexBitWelder::Rehash(const size_t newCapacity)
+{
+	std::vector<Slot> oldSlots;
+	oldSlots.swap(slots);
+	Slot empty = { 0, -1 };
+	slots.assign(newCapacity, empty);
+	mask = newCapacity - 1;
+	for (const Slot& slot : oldSlots) {
+		if (slot.id < 0) continue;
+		size_t index = slot.hash & mask;
+		while (slots[index].id >= 0)
+			index = (index + 1) & mask;
+		slots[index] = slot;
+	}
+}
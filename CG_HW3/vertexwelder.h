@@ -0,0 +1,76 @@
+#ifndef VERTEX_WELDER_H
+#define VERTEX_WELDER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// VertexWelder Declarations.
+// Flat open-addressing hash table from an integer (p, t, n) index triple to a dense vertex id.
+// Ids are handed out in first-insertion order. Missing components should be passed as -1.
+class VertexWelder
+{
+public:
+	// VertexWelder Public Methods.
+	VertexWelder();
+
+	// Size the table for this many distinct keys up front so inserts never rehash.
+	void Reserve(const size_t expectedKeys);
+	// Return the id of (p, t, n), adding it with the next free id if it is new.
+	int FindOrInsert(const int p, const int t, const int n, bool& inserted);
+	// Drop the table storage.
+	void Release();
+
+	size_t GetNumKeys() const { return numKeys; }
+	size_t GetMemoryBytes() const { return slots.capacity() * sizeof(Slot); }
+
+private:
+	// VertexWelder Private Data.
+	struct Slot {
+		int p, t, n;
+		int id;		// -1 marks an empty slot.
+	};
+	void Rehash(const size_t newCapacity);
+	static uint32_t Hash(const int p, const int t, const int n);
+
+	std::vector<Slot> slots;
+	size_t mask;
+	size_t numKeys;
+};
+
+// VertexBitWelder Declarations.
+// Same idea for vertices that arrive by value: the key is a fixed number of 32-bit words
+// (e.g. the raw bits of a vertex's floats), so only bit-identical vertices are merged.
+// Keys are copied into one flat array; GetKey turns an id back into its words.
+class VertexBitWelder
+{
+public:
+	// VertexBitWelder Public Methods.
+	VertexBitWelder(const size_t numWords);
+
+	void Reserve(const size_t expectedKeys);
+	// Return the id of key[0 .. numWords), adding it with the next free id if it is new.
+	int FindOrInsert(const uint32_t* key, bool& inserted);
+	void Release();
+
+	const uint32_t* GetKey(const int id) const { return &keys[(size_t)id * numWords]; }
+	size_t GetNumKeys() const { return numKeys; }
+	size_t GetMemoryBytes() const { return slots.capacity() * sizeof(Slot) + keys.capacity() * sizeof(uint32_t); }
+
+private:
+	// VertexBitWelder Private Data.
+	struct Slot {
+		uint32_t hash;
+		int id;		// -1 marks an empty slot.
+	};
+	void Rehash(const size_t newCapacity);
+	uint32_t Hash(const uint32_t* key) const;
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> keys;
+	size_t numWords;
+	size_t mask;
+	size_t numKeys;
+};
+
+#endif
@@ -0,0 +1,257 @@
+#include "headers.h"
+#include "trianglemesh.h"
+#include "alloccounter.h"
+#include "texturecache.h"
+#include <filesystem>
+
+// Headless loader benchmark.
+// Runs TriangleMesh::LoadFromFile on every model folder without a window or GL context
+// (textures are decoded but never uploaded) and reports where the time goes.
+//
+// Usage: LoaderBench [--models DIR] [--iterations N] [--threads N] [--source auto|obj|objm]
+//                    [--cache] [--json FILE]
+//
+// Phase times are medians over the iterations. MB/s is the source size over parse + weld,
+// vertices/s is the vertex count over the whole load. Allocations are per load.
+
+struct BenchOptions
+{
+    BenchOptions() {
+        modelsPath = "../TestModels_HW3";
+        jsonPath = "loaderbench.json";
+        numIterations = 5;
+        numThreads = 1;
+        source = MESH_SOURCE_AUTO;
+        useCache = false;
+    }
+    std::string modelsPath;
+    std::string jsonPath;
+    int numIterations;
+    int numThreads;
+    MeshSource source;
+    bool useCache;
+};
+
+struct ModelResult
+{
+    std::string name;
+    size_t sourceBytes;
+    bool fromCache;
+    int numVertices;
+    int numTriangles;
+    // Medians, in milliseconds.
+    double parseMs;
+    double weldMs;
+    double normalizeMs;
+    double optimizeMs;
+    double lodMs;
+    double materialMs;
+    double textureMs;
+    double cacheMs;
+    double totalMs;
+    double megabytesPerSecond;
+    double verticesPerSecond;
+    uint64_t allocations;
+    uint64_t allocatedBytes;
+    size_t peakResidentBytes;
+};
+
+static double Median(std::vector<double> values)
+{
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return (values.size() % 2 == 1) ? values[middle] : (values[middle - 1] + values[middle]) * 0.5;
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if (arg == "--models" && hasValue) options.modelsPath = argv[++i];
+        else if (arg == "--json" && hasValue) options.jsonPath = argv[++i];
+        else if (arg == "--iterations" && hasValue) options.numIterations = std::max(atoi(argv[++i]), 1);
+        else if (arg == "--threads" && hasValue) options.numThreads = std::max(atoi(argv[++i]), 0);
+        else if (arg == "--source" && hasValue) {
+            const std::string source = argv[++i];
+            if (source == "auto") options.source = MESH_SOURCE_AUTO;
+            else if (source == "obj") options.source = MESH_SOURCE_OBJ;
+            else if (source == "objm") options.source = MESH_SOURCE_OBJM;
+            else return false;
+        }
+        else if (arg == "--cache") options.useCache = true;
+        else return false;
+    }
+    return true;
+}
+
+// Model folders that hold a <name>.obj or <name>.objm, sorted by name.
+static std::vector<std::string> FindModels(const std::string& modelsPath)
+{
+    std::vector<std::string> names;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(modelsPath, error)) {
+        if (!entry.is_directory())
+            continue;
+        const std::string name = entry.path().filename().string();
+        const std::filesystem::path base = entry.path() / name;
+        if (std::filesystem::exists(base.string() + ".obj") || std::filesystem::exists(base.string() + ".objm"))
+            names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+static ModelResult RunModel(const BenchOptions& options, const std::string& name)
+{
+    ModelResult result;
+    result.name = name;
+    std::vector<double> parse, weld, normalize, optimize, lod, material, texture, cache, total;
+    uint64_t allocations = 0, allocatedBytes = 0;
+
+    for (int iteration = 0; iteration < options.numIterations; ++iteration) {
+        const uint64_t allocationsBefore = AllocCounter::GetNumAllocations();
+        const uint64_t bytesBefore = AllocCounter::GetAllocatedBytes();
+        // The loader reports progress on std::cout; keep the benchmark output readable.
+        std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+        auto startTime = std::chrono::high_resolution_clock::now();
+        {
+            TriangleMesh mesh;
+            mesh.SetMeshCacheEnabled(options.useCache);
+            mesh.SetMeshSource(options.source);
+            mesh.SetDeferredUploads(true);
+            mesh.LoadFromFile(options.modelsPath + "/" + name, true, options.numThreads);
+            total.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count());
+
+            const MeshLoadStats& stats = mesh.GetLoadStats();
+            parse.push_back(stats.parseSeconds * 1000.0);
+            weld.push_back(stats.weldSeconds * 1000.0);
+            normalize.push_back(stats.normalizeSeconds * 1000.0);
+            optimize.push_back(stats.optimizeSeconds * 1000.0);
+            lod.push_back(stats.lodSeconds * 1000.0);
+            material.push_back(stats.materialSeconds * 1000.0);
+            texture.push_back(stats.textureSeconds * 1000.0);
+            cache.push_back(stats.cacheSeconds * 1000.0);
+            result.sourceBytes = stats.sourceBytes;
+            result.fromCache = stats.fromCache;
+            result.numVertices = mesh.GetNumVertices();
+            result.numTriangles = mesh.GetNumTriangles();
+        }
+        std::cout.rdbuf(coutBuffer);
+        // Counted up to here, so the mesh's own teardown is not part of the next load.
+        allocations += AllocCounter::GetNumAllocations() - allocationsBefore;
+        allocatedBytes += AllocCounter::GetAllocatedBytes() - bytesBefore;
+    }
+
+    result.parseMs = Median(parse);
+    result.weldMs = Median(weld);
+    result.normalizeMs = Median(normalize);
+    result.optimizeMs = Median(optimize);
+    result.lodMs = Median(lod);
+    result.materialMs = Median(material);
+    result.textureMs = Median(texture);
+    result.cacheMs = Median(cache);
+    result.totalMs = Median(total);
+    const double ingestSeconds = std::max((result.parseMs + result.weldMs) / 1000.0, 1e-9);
+    result.megabytesPerSecond = (double)result.sourceBytes / (1024.0 * 1024.0) / ingestSeconds;
+    result.verticesPerSecond = (double)result.numVertices / std::max(result.totalMs / 1000.0, 1e-9);
+    result.allocations = allocations / (uint64_t)options.numIterations;
+    result.allocatedBytes = allocatedBytes / (uint64_t)options.numIterations;
+    result.peakResidentBytes = AllocCounter::GetPeakResidentBytes();
+    return result;
+}
+
+static void PrintTable(const std::vector<ModelResult>& results)
+{
+    std::cout << std::left << std::setw(11) << "model" << std::right
+              << std::setw(9) << "parse" << std::setw(9) << "weld" << std::setw(9) << "normal" << std::setw(9) << "optim" << std::setw(9) << "lod"
+              << std::setw(9) << "mtl" << std::setw(9) << "tex" << std::setw(9) << "cache"
+              << std::setw(9) << "total" << std::setw(9) << "MB/s" << std::setw(10) << "Mvert/s"
+              << std::setw(9) << "allocs" << std::setw(10) << "alloc MB" << std::setw(9) << "RSS MB" << std::endl;
+    for (const ModelResult& r : results) {
+        std::cout << std::left << std::setw(11) << r.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(9) << r.parseMs << std::setw(9) << r.weldMs << std::setw(9) << r.normalizeMs << std::setw(9) << r.optimizeMs << std::setw(9) << r.lodMs
+                  << std::setw(9) << r.materialMs << std::setw(9) << r.textureMs << std::setw(9) << r.cacheMs
+                  << std::setw(9) << r.totalMs << std::setprecision(1) << std::setw(9) << r.megabytesPerSecond
+                  << std::setprecision(2) << std::setw(10) << r.verticesPerSecond / 1e6
+                  << std::setw(9) << r.allocations
+                  << std::setprecision(1) << std::setw(10) << (double)r.allocatedBytes / (1024.0 * 1024.0)
+                  << std::setw(9) << (double)r.peakResidentBytes / (1024.0 * 1024.0) << std::endl;
+    }
+    std::cout << "(times in ms, medians)" << std::endl;
+}
+
+static bool WriteJson(const std::string& jsonPath, const BenchOptions& options, const std::vector<ModelResult>& results)
+{
+    std::ofstream json(jsonPath);
+    if (!json.is_open())
+        return false;
+    const char* sourceNames[] = { "auto", "obj", "objm" };
+    json << std::fixed << std::setprecision(4);
+    json << "{\n";
+    json << "  \"iterations\": " << options.numIterations << ",\n";
+    json << "  \"threads\": " << options.numThreads << ",\n";
+    json << "  \"source\": \"" << sourceNames[options.source] << "\",\n";
+    json << "  \"cache\": " << (options.useCache ? "true" : "false") << ",\n";
+    json << "  \"peak_rss_bytes\": " << AllocCounter::GetPeakResidentBytes() << ",\n";
+    json << "  \"models\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ModelResult& r = results[i];
+        json << "    {\n";
+        json << "      \"name\": \"" << r.name << "\",\n";
+        json << "      \"source_bytes\": " << r.sourceBytes << ",\n";
+        json << "      \"from_cache\": " << (r.fromCache ? "true" : "false") << ",\n";
+        json << "      \"vertices\": " << r.numVertices << ",\n";
+        json << "      \"triangles\": " << r.numTriangles << ",\n";
+        json << "      \"parse_ms\": " << r.parseMs << ",\n";
+        json << "      \"weld_ms\": " << r.weldMs << ",\n";
+        json << "      \"normalize_ms\": " << r.normalizeMs << ",\n";
+        json << "      \"optimize_ms\": " << r.optimizeMs << ",\n";
+        json << "      \"lod_ms\": " << r.lodMs << ",\n";
+        json << "      \"material_ms\": " << r.materialMs << ",\n";
+        json << "      \"texture_ms\": " << r.textureMs << ",\n";
+        json << "      \"cache_ms\": " << r.cacheMs << ",\n";
+        json << "      \"total_ms\": " << r.totalMs << ",\n";
+        json << "      \"mb_per_s\": " << r.megabytesPerSecond << ",\n";
+        json << "      \"vertices_per_s\": " << r.verticesPerSecond << ",\n";
+        json << "      \"allocations\": " << r.allocations << ",\n";
+        json << "      \"allocated_bytes\": " << r.allocatedBytes << ",\n";
+        json << "      \"peak_rss_bytes\": " << r.peakResidentBytes << "\n";
+        json << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n";
+    json << "}\n";
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "Usage: LoaderBench [--models DIR] [--iterations N] [--threads N] "
+                  << "[--source auto|obj|objm] [--cache] [--json FILE]" << std::endl;
+        return 1;
+    }
+
+    // Every iteration decodes its textures: nothing stays cached after a mesh is gone.
+    TextureCache::Shared().SetIdleBudget(0);
+
+    const std::vector<std::string> names = FindModels(options.modelsPath);
+    if (names.empty()) {
+        std::cerr << "No models found in " << options.modelsPath << std::endl;
+        return 1;
+    }
+
+    std::vector<ModelResult> results;
+    for (const std::string& name : names)
+        results.push_back(RunModel(options, name));
+
+    PrintTable(results);
+    if (WriteJson(options.jsonPath, options, results))
+        std::cout << "Results written to " << options.jsonPath << std::endl;
+    else
+        std::cerr << "Failed to write " << options.jsonPath << std::endl;
+    return 0;
+}